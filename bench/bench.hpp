@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BENCH_BENCH_HPP
+#define LIBBITCOIN_NETWORK_BENCH_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace bench {
+
+typedef std::chrono::steady_clock clock;
+
+/// Write the result of a benchmark as a line of its name, iterations and
+/// the mean time per iteration.
+void report(const std::string& name, size_t iterations,
+    const clock::duration& elapsed);
+
+/// Time the workload, which is given the number of iterations to perform.
+template <typename Workload>
+void measure(const std::string& name, size_t iterations, Workload&& workload)
+{
+    const auto start = clock::now();
+    std::forward<Workload>(workload)(iterations);
+    report(name, iterations, clock::now() - start);
+}
+
+/// The benchmark groups, each measures one area of the hot path.
+void checksum();
+void subscriber();
+void hosts();
+void loopback();
+
+/// Replay a frame capture, at the recorded pace or maximum speed.
+void replay(const std::string& file, bool realtime);
+
+} // namespace bench
+
+#endif
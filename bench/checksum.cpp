@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/network.hpp>
+
+namespace bench {
+
+using namespace bc;
+using namespace bc::network;
+
+static const size_t small_payload = 256;
+static const size_t large_payload = 1024 * 1024;
+
+// The accelerated checksum against the system checksum, by payload size.
+static void checksum(size_t size, size_t iterations)
+{
+    const data_chunk payload(size, 0x42);
+    const auto name = std::to_string(size);
+    volatile uint32_t sink = 0;
+
+    measure("checksum.system." + name, iterations, [&](size_t count)
+    {
+        for (size_t iteration = 0; iteration < count; ++iteration)
+            sink = bitcoin_checksum(payload);
+    });
+
+    measure("checksum.frame." + name, iterations, [&](size_t count)
+    {
+        for (size_t iteration = 0; iteration < count; ++iteration)
+            sink = frame_checksum::compute(payload);
+    });
+}
+
+void checksum()
+{
+    checksum(small_payload, 1000000);
+    checksum(large_payload, 1000);
+}
+
+} // namespace bench
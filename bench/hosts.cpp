@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <cstddef>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <bitcoin/network.hpp>
+
+namespace bench {
+
+using namespace bc;
+using namespace bc::network;
+
+static const std::string hosts_path = "bench.hosts.cache";
+
+// Pool sizes of a typical node and of a well connected one.
+static const size_t pool_sizes[] = { 1000, 10000, 100000 };
+static const size_t fetch_iterations = 100000;
+
+static network::hosts::address make_address(size_t index)
+{
+    const auto host = std::to_string(10 + index / (256 * 256) % 200) + "." +
+        std::to_string(index / 256 % 256) + "." +
+        std::to_string(index % 256) + ".1";
+    return config::authority(host, 8333).to_network_address();
+}
+
+// Store fills the pool from empty, fetch samples the full pool.
+static void measure_pool(size_t capacity)
+{
+    auto configuration = network::settings(config::settings::mainnet);
+    configuration.host_pool_capacity = static_cast<uint32_t>(capacity);
+    configuration.hosts_file = hosts_path;
+    boost::filesystem::remove_all(hosts_path);
+
+    network::hosts pool(configuration);
+    pool.start();
+
+    const auto size = std::to_string(capacity);
+    measure("hosts.store." + size, capacity, [&](size_t count)
+    {
+        for (size_t index = 0; index < count; ++index)
+            pool.store(make_address(index));
+    });
+
+    measure("hosts.fetch." + size, fetch_iterations, [&](size_t count)
+    {
+        network::hosts::address out;
+
+        for (size_t iteration = 0; iteration < count; ++iteration)
+            pool.fetch(out);
+    });
+
+    pool.stop();
+    boost::filesystem::remove_all(hosts_path);
+}
+
+void hosts()
+{
+    for (const auto capacity: pool_sizes)
+        measure_pool(capacity);
+}
+
+} // namespace bench
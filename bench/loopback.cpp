@@ -0,0 +1,239 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <bitcoin/network.hpp>
+
+namespace bench {
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+static const uint16_t bench_port = 28444;
+static const size_t connect_iterations = 1000;
+static const size_t frame_iterations = 1000000;
+static const size_t fanout_channels = 100;
+static const size_t fanout_rounds = 10000;
+
+struct channel_pair
+{
+    channel::ptr client;
+    channel::ptr server;
+};
+
+// Establish a pair of channels, unstarted, over the loopback interface.
+static bool connect_pair(threadpool& pool, const network::settings& settings,
+    acceptor::ptr listener, channel_pair& out)
+{
+    std::promise<channel::ptr> accepted;
+    std::promise<channel::ptr> connected;
+    auto server = accepted.get_future();
+    auto client = connected.get_future();
+
+    listener->accept([&accepted](const code& ec, channel::ptr channel)
+    {
+        accepted.set_value(ec ? nullptr : channel);
+    });
+
+    const auto connector = std::make_shared<network::connector>(pool,
+        settings);
+    connector->connect(config::authority("127.0.0.1", bench_port),
+        [&connected](const code& ec, channel::ptr channel)
+        {
+            connected.set_value(ec ? nullptr : channel);
+        });
+
+    out.server = server.get();
+    out.client = client.get();
+    connector->stop(error::service_stopped);
+    return out.server && out.client;
+}
+
+static void stop_pair(channel_pair& pair)
+{
+    if (pair.client)
+        pair.client->stop(error::channel_stopped);
+
+    if (pair.server)
+        pair.server->stop(error::channel_stopped);
+}
+
+// A ping frame, serialized once and shared by all sends, as by broadcast.
+static proxy::payload_ptr make_frame(const network::settings& settings)
+{
+    const ping message(42);
+    const auto version = settings.protocol_maximum;
+    const auto frame = std::make_shared<data_chunk>(
+        heading::satoshi_fixed_size() + message.serialized_size(version));
+    proxy::serialize(*frame, message, version, settings.identifier);
+    return frame;
+}
+
+// Count pings received on the server channels, completing at the total.
+class counter
+{
+public:
+    counter(size_t total)
+      : total_(total), received_(0)
+    {
+    }
+
+    void subscribe(channel::ptr channel)
+    {
+        channel->subscribe<ping>([this](const code& ec, ping_const_ptr)
+        {
+            if (ec)
+                return false;
+
+            if (++received_ == total_)
+                done_.set_value();
+
+            return true;
+        });
+    }
+
+    void wait()
+    {
+        done_.get_future().wait();
+    }
+
+private:
+    const size_t total_;
+    std::atomic<size_t> received_;
+    std::promise<void> done_;
+};
+
+static void start(channel::ptr channel)
+{
+    channel->start([](const code&){});
+}
+
+// Each iteration accepts and connects a channel pair.
+static void establish(threadpool& pool, const network::settings& settings,
+    acceptor::ptr listener)
+{
+    measure("loopback.establish", connect_iterations, [&](size_t count)
+    {
+        for (size_t iteration = 0; iteration < count; ++iteration)
+        {
+            channel_pair pair;
+            connect_pair(pool, settings, listener, pair);
+            stop_pair(pair);
+        }
+    });
+}
+
+// Frames are written by one channel and framed and dispatched by its peer.
+static void framing(threadpool& pool, const network::settings& settings,
+    acceptor::ptr listener)
+{
+    channel_pair pair;
+
+    if (!connect_pair(pool, settings, listener, pair))
+    {
+        stop_pair(pair);
+        return;
+    }
+
+    const auto frame = make_frame(settings);
+    const auto command = proxy::static_command<ping>();
+    const auto nop = [](const code&){};
+    counter received(frame_iterations);
+    received.subscribe(pair.server);
+    start(pair.server);
+    start(pair.client);
+
+    measure("loopback.framing.ping", frame_iterations, [&](size_t count)
+    {
+        for (size_t iteration = 0; iteration < count; ++iteration)
+            pair.client->send(command, frame, nop);
+
+        received.wait();
+    });
+
+    stop_pair(pair);
+}
+
+// Each iteration sends one shared frame to every channel, as broadcast.
+static void fanout(threadpool& pool, const network::settings& settings,
+    acceptor::ptr listener)
+{
+    std::vector<channel_pair> pairs(fanout_channels);
+    counter received(fanout_channels * fanout_rounds);
+
+    for (auto& pair: pairs)
+    {
+        if (!connect_pair(pool, settings, listener, pair))
+        {
+            for (auto& each: pairs)
+                stop_pair(each);
+
+            return;
+        }
+
+        received.subscribe(pair.server);
+        start(pair.server);
+        start(pair.client);
+    }
+
+    const auto frame = make_frame(settings);
+    const auto command = proxy::static_command<ping>();
+    const auto nop = [](const code&){};
+
+    measure("loopback.fanout." + std::to_string(fanout_channels),
+        fanout_rounds, [&](size_t count)
+        {
+            for (size_t round = 0; round < count; ++round)
+                for (const auto& pair: pairs)
+                    pair.client->send(command, frame, nop);
+
+            received.wait();
+        });
+
+    for (auto& pair: pairs)
+        stop_pair(pair);
+}
+
+void loopback()
+{
+    threadpool pool(4);
+    const network::settings settings(config::settings::mainnet);
+    const auto listener = std::make_shared<acceptor>(pool, settings);
+
+    if (listener->listen(bench_port))
+        return;
+
+    establish(pool, settings, listener);
+    framing(pool, settings, listener);
+    fanout(pool, settings, listener);
+
+    listener->stop(error::service_stopped);
+    pool.shutdown();
+    pool.join();
+}
+
+} // namespace bench
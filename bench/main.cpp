@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bench {
+
+void report(const std::string& name, size_t iterations,
+    const clock::duration& elapsed)
+{
+    using namespace std::chrono;
+    const auto nanoseconds = duration_cast<std::chrono::nanoseconds>(
+        elapsed).count();
+    const auto mean = iterations == 0 ? 0.0 :
+        static_cast<double>(nanoseconds) / iterations;
+
+    std::cout << std::left << std::setw(48) << name << std::right
+        << std::setw(10) << iterations << " iterations "
+        << std::setw(14) << std::fixed << std::setprecision(1) << mean
+        << " ns/op" << std::endl;
+}
+
+} // namespace bench
+
+// Run all groups, or only those named on the command line.
+// A capture is replayed only if named: replay <file> [realtime].
+int main(int argc, char* argv[])
+{
+    if (argc > 2 && std::string(argv[1]) == "replay")
+    {
+        const auto realtime = argc > 3 &&
+            std::string(argv[3]) == "realtime";
+        bench::replay(argv[2], realtime);
+        return 0;
+    }
+
+    const auto selected = [argc, argv](const std::string& group)
+    {
+        if (argc < 2)
+            return true;
+
+        for (auto arg = 1; arg < argc; ++arg)
+            if (group == argv[arg])
+                return true;
+
+        return false;
+    };
+
+    if (selected("checksum"))
+        bench::checksum();
+
+    if (selected("subscriber"))
+        bench::subscriber();
+
+    if (selected("hosts"))
+        bench::hosts();
+
+    if (selected("loopback"))
+        bench::loopback();
+
+    return 0;
+}
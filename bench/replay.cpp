@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <bitcoin/network.hpp>
+
+namespace bench {
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+// Dispatch is polled at this interval and abandoned after the stall timeout.
+static const auto poll_interval = std::chrono::milliseconds(1);
+static const auto stall_timeout = std::chrono::seconds(5);
+
+// Subscribe as a node would, so that each message is deserialized.
+template <class Message>
+static void subscribe(channel::ptr channel)
+{
+    channel->subscribe<Message>(
+        [](const code& ec, std::shared_ptr<const Message>)
+        {
+            return !ec;
+        });
+}
+
+static void subscribe_all(channel::ptr channel)
+{
+    subscribe<address>(channel);
+    subscribe<block>(channel);
+    subscribe<get_blocks>(channel);
+    subscribe<get_data>(channel);
+    subscribe<get_headers>(channel);
+    subscribe<headers>(channel);
+    subscribe<inventory>(channel);
+    subscribe<not_found>(channel);
+    subscribe<ping>(channel);
+    subscribe<pong>(channel);
+    subscribe<transaction>(channel);
+}
+
+// Each captured channel is fed to a proxy over an in-memory transport, at
+// the recorded pace or as fast as possible, and timed until all captured
+// frames are dispatched.
+void replay(const std::string& file, bool realtime)
+{
+    frame_capture::frames frames;
+
+    if (!frame_capture::load(file, frames) || frames.empty())
+    {
+        std::cerr << "Invalid or empty capture: " << file << std::endl;
+        return;
+    }
+
+    // The frames are accepted under the magic of the captured network.
+    network::settings settings(config::settings::mainnet);
+    settings.identifier = from_little_endian_unsafe<uint32_t>(
+        frames.front().data.begin());
+
+    threadpool pool(4);
+    boost::asio::io_context::strand strand(pool.service());
+    const auto received = std::make_shared<traffic>();
+    const auto nop = [](const boost_code&, size_t) {};
+    std::map<uint32_t, transport::ptr> feeds;
+    std::vector<channel::ptr> channels;
+
+    for (const auto& frame: frames)
+    {
+        if (feeds.find(frame.channel) != feeds.end())
+            continue;
+
+        const auto ends = loopback_transport::connect(
+            config::authority("10.0.0.1", 8333),
+            config::authority("127.0.0.1", 8333));
+        const auto channel = std::make_shared<network::channel>(pool,
+            ends.second, settings);
+
+        channel->set_traffic(received);
+        subscribe_all(channel);
+        channel->start([](const code&) {});
+        feeds.emplace(frame.channel, ends.first);
+        channels.push_back(channel);
+    }
+
+    const auto first = frames.front().microseconds;
+    const auto start = clock::now();
+
+    for (const auto& frame: frames)
+    {
+        if (realtime)
+            std::this_thread::sleep_until(start +
+                std::chrono::microseconds(frame.microseconds - first));
+
+        feeds[frame.channel]->write({ boost::asio::buffer(frame.data) },
+            strand, nop);
+    }
+
+    // A channel stopped by an invalid frame stalls the count.
+    uint64_t dispatched = 0;
+    auto progressed = clock::now();
+
+    while (dispatched < frames.size())
+    {
+        std::this_thread::sleep_for(poll_interval);
+        const auto count = received->collect().total.messages_in;
+
+        if (count != dispatched)
+        {
+            dispatched = count;
+            progressed = clock::now();
+        }
+        else if (clock::now() - progressed > stall_timeout)
+        {
+            std::cerr << "Replay stalled at " << dispatched << " of "
+                << frames.size() << " frames" << std::endl;
+            break;
+        }
+    }
+
+    report(std::string("replay.") + (realtime ? "realtime." : "maximum.") +
+        std::to_string(channels.size()), dispatched, clock::now() - start);
+
+    for (const auto& channel: channels)
+        channel->stop(error::channel_stopped);
+
+    for (const auto& feed: feeds)
+        feed.second->stop();
+
+    pool.shutdown();
+    pool.join();
+}
+
+} // namespace bench
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/network.hpp>
+
+namespace bench {
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+static const size_t load_iterations = 1000000;
+static const size_t large_load_iterations = 10000;
+static const uint32_t bench_version = version::level::maximum;
+
+// Load the payload repeatedly, as the proxy does for each received frame.
+// Ping is invoked on the loading thread by default, inventory and address
+// are relayed to the threadpool, so their handlers complete asynchronously.
+static void load(const std::string& name, message_subscriber& subscriber,
+    message_type type, const data_chunk& payload, size_t iterations)
+{
+    measure("subscriber.load." + name, iterations, [&](size_t count)
+    {
+        for (size_t iteration = 0; iteration < count; ++iteration)
+        {
+            auto source = make_safe_deserializer(payload.begin(),
+                payload.end());
+            subscriber.load(type, bench_version, source);
+        }
+    });
+}
+
+void subscriber()
+{
+    threadpool pool(4);
+    message_subscriber subscriber(pool);
+    subscriber.start();
+
+    std::atomic<size_t> handled(0);
+
+    subscriber.subscribe<ping>(
+        [&handled](const code&, ping_const_ptr)
+        {
+            ++handled;
+            return true;
+        });
+
+    subscriber.subscribe<inventory>(
+        [&handled](const code&, inventory_const_ptr)
+        {
+            ++handled;
+            return true;
+        });
+
+    subscriber.subscribe<address>(
+        [&handled](const code&, address_const_ptr)
+        {
+            ++handled;
+            return true;
+        });
+
+    // A full inventory of block hashes and a full address message.
+    inventory_vector::list hashes(max_inventory,
+        { inventory_vector::type_id::block, null_hash });
+    network_address::list addresses(1000,
+        { 0, version::service::node_network, ip_address{ { 0 } }, 8333 });
+
+    load("ping", subscriber, message_type::ping,
+        ping(42).to_data(bench_version), load_iterations);
+    load("inventory", subscriber, message_type::inventory,
+        inventory(hashes).to_data(bench_version), large_load_iterations);
+    load("address", subscriber, message_type::address,
+        address(addresses).to_data(bench_version), large_load_iterations);
+
+    subscriber.stop();
+    subscriber.broadcast(error::service_stopped);
+    pool.shutdown();
+    pool.join();
+}
+
+} // namespace bench
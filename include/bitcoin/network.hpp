@@ -16,18 +16,51 @@
 
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/acceptor.hpp>
+#include <bitcoin/network/anchors.hpp>
+#include <bitcoin/network/announcement_queue.hpp>
+#include <bitcoin/network/blacklist.hpp>
+#include <bitcoin/network/block_decoder.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/connections.hpp>
 #include <bitcoin/network/connector.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dispatch_policy.hpp>
+#include <bitcoin/network/dns_cache.hpp>
+#include <bitcoin/network/eviction.hpp>
+#include <bitcoin/network/frame_capture.hpp>
+#include <bitcoin/network/frame_checksum.hpp>
+#include <bitcoin/network/handler_memory.hpp>
+#include <bitcoin/network/handshake_trace.hpp>
+#include <bitcoin/network/histogram.hpp>
 #include <bitcoin/network/hosts.hpp>
+#include <bitcoin/network/loopback_acceptor.hpp>
+#include <bitcoin/network/loopback_connector.hpp>
+#include <bitcoin/network/loopback_hub.hpp>
+#include <bitcoin/network/loopback_transport.hpp>
+#include <bitcoin/network/memory_budget.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
+#include <bitcoin/network/metrics.hpp>
 #include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/pooled_timer.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/short_id.hpp>
+#include <bitcoin/network/slab.hpp>
+#include <bitcoin/network/socket_profile.hpp>
+#include <bitcoin/network/statsd.hpp>
+#include <bitcoin/network/tcp_transport.hpp>
+#include <bitcoin/network/thread_shards.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/token_bucket.hpp>
+#include <bitcoin/network/traffic.hpp>
+#include <bitcoin/network/transport.hpp>
 #include <bitcoin/network/version.hpp>
 #include <bitcoin/network/protocols/protocol.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_compact_block_70014.hpp>
 #include <bitcoin/network/protocols/protocol_events.hpp>
+#include <bitcoin/network/protocols/protocol_fee_filter_70013.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
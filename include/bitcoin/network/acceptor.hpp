@@ -27,6 +27,8 @@
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/socket_profile.hpp>
+#include <bitcoin/network/thread_shards.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -40,36 +42,64 @@ class BCT_API acceptor
 public:
     typedef std::shared_ptr<acceptor> ptr;
     typedef std::function<void(const code&, channel::ptr)> accept_handler;
+    typedef std::function<code(const config::authority&)> admission_handler;
 
     /// Construct an instance.
     acceptor(threadpool& pool, const settings& settings);
 
+    /// Construct an instance that pins each channel to a shard (optional).
+    acceptor(threadpool& pool, const settings& settings,
+        thread_shards::ptr shards);
+
     /// Validate acceptor stopped.
     ~acceptor();
 
-    /// Start the listener on the specified port.
+    /// Start the listener on the specified port, on all interfaces (ipv6).
     virtual code listen(uint16_t port);
 
+    /// Start the listener on the specified local endpoint. Shared listeners
+    /// on one endpoint (SO_REUSEPORT) are load balanced by the kernel.
+    /// An ipv6_only listener leaves the port to an ipv4 listener.
+    virtual code listen(const asio::endpoint& endpoint, bool shared,
+        bool ipv6_only);
+
+    /// True if listeners may share an endpoint on this platform.
+    static bool shareable();
+
     /// Accept the next connection available, until canceled.
     virtual void accept(accept_handler handler);
 
+    /// Set the test applied to each accepted socket before a channel is
+    /// constructed. A rejected socket is closed and the accept is rearmed.
+    virtual void set_admission(admission_handler admit);
+
+    /// Set the options applied to the listener and to each accepted socket
+    /// (before listen).
+    virtual void set_socket_profile(const socket_profile& profile);
+
     /// Cancel outstanding accept attempt.
     virtual void stop(const code& ec);
 
 private:
     virtual bool stopped() const;
+    code admit(const config::authority& authority) const;
 
-    void handle_accept(const boost_code& ec, socket::ptr socket,
-        accept_handler handler);
+    void handle_accept(const boost_code& ec, threadpool& pool,
+        socket::ptr socket, accept_handler handler);
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     threadpool& pool_;
     const settings& settings_;
+    const thread_shards::ptr shards_;
     mutable dispatcher dispatch_;
 
+    // This is set before listen.
+    socket_profile profile_;
+
     // These are protected by mutex.
     asio::acceptor acceptor_;
+    admission_handler admit_;
     mutable shared_mutex mutex_;
 };
 
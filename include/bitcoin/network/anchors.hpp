@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_ANCHORS_HPP
+#define LIBBITCOIN_NETWORK_ANCHORS_HPP
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The outbound peers that were connected and proven at shutdown, retained
+/// so that they are the first connections made upon restart. The file is a
+/// magic and version followed by serialized network addresses. The file is
+/// removed upon load, so a peer that causes a crash is not retried forever.
+class BCT_API anchors
+{
+public:
+    /// Load and remove the anchors file, an empty list if there is no file.
+    static code load(const boost::filesystem::path& file,
+        config::authority::list& out);
+
+    /// Replace the anchors file with the list (removed if empty).
+    static code save(const boost::filesystem::path& file,
+        const config::authority::list& anchors);
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
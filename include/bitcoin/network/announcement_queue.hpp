@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_ANNOUNCEMENT_QUEUE_HPP
+#define LIBBITCOIN_NETWORK_ANNOUNCEMENT_QUEUE_HPP
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Inventory pending announcement to one peer, taken as one batch.
+/// A block is announced without delay, carrying any pending inventory.
+/// This class is thread safe.
+class BCT_API announcement_queue
+  : noncopyable
+{
+public:
+    /// What the caller should do upon a push.
+    enum class action
+    {
+        /// Nothing, a flush is already scheduled.
+        none,
+
+        /// Schedule a flush, the queue was empty.
+        schedule,
+
+        /// Flush now, a block was pushed or the threshold was reached.
+        flush
+    };
+
+    /// Construct a queue flushed at the threshold count (zero for any).
+    announcement_queue(size_t threshold);
+
+    /// Queue the items for announcement.
+    action push(const message::inventory_vector::list& items);
+
+    /// Take all pending items.
+    message::inventory_vector::list pop();
+
+    /// The number of pending items.
+    size_t size() const;
+
+private:
+    const size_t threshold_;
+
+    // These are protected by mutex.
+    message::inventory_vector::list pending_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BLACKLIST_HPP
+#define LIBBITCOIN_NETWORK_BLACKLIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A compiled set of blocked addresses and subnets.
+/// Addresses are held in a hash set and subnets in a binary prefix trie, so
+/// a lookup is constant time in the number of entries. Addresses are in the
+/// 16 byte (ipv6 or ipv4-mapped) form and prefixes count bits of that form.
+/// This class is thread safe.
+class BCT_API blacklist
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<blacklist> ptr;
+    typedef std::vector<std::string> subnets;
+
+    /// The number of bits in an address, the prefix of a single address.
+    static const uint8_t address_bits;
+
+    /// Parse an address or subnet ("1.2.3.0/24", "2001:db8::/32").
+    /// An ipv4 prefix is converted to the prefix of its ipv4-mapped form.
+    static bool parse(const std::string& subnet, message::ip_address& ip,
+        uint8_t& prefix);
+
+    /// Construct an empty instance.
+    blacklist();
+
+    /// Construct an instance from addresses (ports are ignored) and subnets.
+    /// Subnets that do not parse are skipped.
+    blacklist(const config::authority::list& addresses,
+        const subnets& subnets);
+
+    /// The number of addresses and subnets.
+    size_t size() const;
+
+    /// Determine if the address is blocked by an address or subnet.
+    bool contains(const message::ip_address& ip) const;
+    bool contains(const config::authority& authority) const;
+
+    /// Block an address or subnet, false if the subnet does not parse.
+    void add(const message::ip_address& ip, uint8_t prefix=address_bits);
+    bool add(const std::string& subnet);
+
+    /// Unblock an address or subnet, false if the subnet does not parse.
+    /// Only an identical entry is removed, not entries that it covers.
+    void remove(const message::ip_address& ip, uint8_t prefix=address_bits);
+    bool remove(const std::string& subnet);
+
+private:
+    typedef uint32_t node_index;
+
+    struct address_hash
+    {
+        size_t operator()(const message::ip_address& value) const;
+    };
+
+    struct node
+    {
+        node_index children[2];
+        bool terminal;
+    };
+
+    typedef std::unordered_set<message::ip_address, address_hash> address_set;
+
+    static bool bit(const message::ip_address& ip, uint8_t index);
+
+    // These are not thread safe.
+    void do_add(const message::ip_address& ip, uint8_t prefix);
+    void do_remove(const message::ip_address& ip, uint8_t prefix);
+
+    // These are protected by the mutex.
+    address_set addresses_;
+    std::vector<node> nodes_;
+    size_t subnets_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
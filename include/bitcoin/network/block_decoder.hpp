@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BLOCK_DECODER_HPP
+#define LIBBITCOIN_NETWORK_BLOCK_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Decodes a block payload progressively as it is read, one transaction at
+/// a time, so that decoding overlaps the transfer. The payload may move
+/// between calls (its address is passed each time) but is only appended.
+/// A block that fails progressive decoding is decoded again in full upon
+/// completion, so an invalid block is determined as by block::from_data.
+/// This class is not thread safe.
+class BCT_API block_decoder
+  : noncopyable
+{
+public:
+    /// Construct an inactive decoder.
+    block_decoder();
+
+    /// Begin decoding a block payload of the size.
+    void start(uint32_t version, size_t payload_size);
+
+    /// True if a payload is being decoded.
+    bool active() const;
+
+    /// The number of payload bytes decoded.
+    size_t decoded() const;
+
+    /// Decode the transactions that are complete in the available prefix.
+    void decode(const uint8_t* payload, size_t available);
+
+    /// Decode the remainder of the complete payload and end decoding.
+    /// @return  The block, or null if the payload is invalid.
+    message::block::ptr complete(const uint8_t* payload);
+
+    /// End decoding without a result.
+    void reset();
+
+private:
+    enum class stage
+    {
+        idle,
+        header,
+        count,
+        transactions,
+        failed
+    };
+
+    bool decode_next(const uint8_t* payload, size_t available);
+
+    stage stage_;
+    uint32_t version_;
+    size_t size_;
+    size_t offset_;
+    size_t retry_;
+    chain::header header_;
+    chain::transaction::list transactions_;
+    size_t count_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BUFFER_POOL_HPP
+#define LIBBITCOIN_NETWORK_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A bounded set of reusable serialization buffers, thread safe.
+/// A buffer returns to the pool when its last outside reference is released,
+/// so the holder of a buffer is not required to explicitly return it.
+class BCT_API buffer_pool
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<data_chunk> buffer_ptr;
+
+    /// Construct a pool of up to count buffers of up to limit bytes each.
+    buffer_pool(size_t count, size_t limit);
+
+    /// Obtain a buffer sized to the specified number of bytes.
+    /// Allocates only if the size exceeds the limit or all buffers are in use.
+    buffer_ptr acquire(size_t size);
+
+private:
+    typedef std::vector<buffer_ptr> buffers;
+
+    // These are thread safe.
+    const size_t count_;
+    const size_t limit_;
+
+    // This is protected by mutex.
+    buffers buffers_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -20,16 +20,22 @@
 #define LIBBITCOIN_NETWORK_CHANNEL_HPP
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <utility>
 #include <string>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/announcement_queue.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/handshake_trace.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
+#include <bitcoin/network/pooled_timer.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -41,9 +47,22 @@ class BCT_API channel
 public:
     typedef std::shared_ptr<channel> ptr;
 
-    /// Construct an instance.
+    /// Round trip times measured by ping, zero until the first sample.
+    struct latency
+    {
+        asio::duration last;
+        asio::duration minimum;
+        asio::duration average;
+        size_t samples;
+    };
+
+    /// Construct an instance over a tcp socket.
     channel(threadpool& pool, socket::ptr socket, const settings& settings);
 
+    /// Construct an instance over the transport (e.g. in-memory loopback).
+    channel(threadpool& pool, transport::ptr transport,
+        const settings& settings);
+
     void start(result_handler handler) override;
 
     // Properties.
@@ -51,12 +70,41 @@ public:
     virtual bool notify() const;
     virtual void set_notify(bool value);
 
+    /// True if the channel is a full relay outbound (anchor candidate).
+    virtual bool outbound() const;
+    virtual void set_outbound(bool value);
+
+    /// The minimum fee rate (satoshis per kilobyte) of transactions relayed
+    /// to the peer (BIP133), zero until the peer sends its fee filter.
+    virtual uint64_t fee_filter() const;
+    virtual void set_fee_filter(uint64_t value);
+
+    /// True if the peer accepts a transaction of the fee rate.
+    virtual bool accepts_fee(uint64_t fee_rate) const;
+
     virtual uint64_t nonce() const;
     virtual void set_nonce(uint64_t value);
 
     virtual version_const_ptr peer_version() const;
     virtual void set_peer_version(version_const_ptr value);
 
+    /// The measured round trip times (last, minimum, moving average).
+    virtual latency round_trip() const;
+
+    /// Record a measured round trip time.
+    virtual void record_round_trip(const asio::duration& value);
+
+    /// The times of the connection and handshake stages of this channel.
+    virtual handshake_trace& trace();
+
+    /// Schedule channel timers on the wheel (must be set before start).
+    virtual void set_timers(timer_wheel::ptr timers);
+
+    /// Queue inventory for announcement, sent in batches upon a randomized
+    /// trickle interval, a batch threshold or a block. Transactions are not
+    /// announced to a peer that has not requested relay.
+    virtual void announce(const message::inventory_vector::list& items);
+
 protected:
     virtual void signal_activity() override;
     virtual void handle_stopping() override;
@@ -66,6 +114,8 @@ protected:
     using proxy::stopped;
 
 private:
+    typedef std::chrono::steady_clock clock;
+
     void do_start(const code& ec, result_handler handler);
 
     void start_expiration();
@@ -73,12 +123,39 @@ private:
 
     void start_inactivity();
     void handle_inactivity(const code& ec);
+    asio::duration idle() const;
+
+    void start_trickle();
+    void handle_trickle(const code& ec);
+    void flush_announcements();
 
     std::atomic<bool> notify_;
+    std::atomic<bool> outbound_;
+    std::atomic<uint64_t> fee_filter_;
     std::atomic<uint64_t> nonce_;
     bc::atomic<version_const_ptr> peer_version_;
-    deadline::ptr expiration_;
-    deadline::ptr inactivity_;
+    const asio::duration expiration_period_;
+    const asio::duration inactivity_period_;
+
+    // These deadlines are null when the timer wheel is configured.
+    pooled_timer::ptr expiration_;
+    pooled_timer::ptr inactivity_;
+
+    // This deadline is null when announcement trickle is disabled.
+    const asio::duration trickle_period_;
+    pooled_timer::ptr trickle_;
+    announcement_queue announcements_;
+    std::atomic<int64_t> last_activity_;
+    std::atomic<asio::duration::rep> last_round_trip_;
+    std::atomic<asio::duration::rep> minimum_round_trip_;
+    std::atomic<asio::duration::rep> average_round_trip_;
+    std::atomic<size_t> round_trips_;
+    handshake_trace trace_;
+
+    // The wheel is set before start, its timers replace the deadlines.
+    timer_wheel::ptr timers_;
+    bc::atomic<timer_wheel::timer_ptr> expiration_timer_;
+    bc::atomic<timer_wheel::timer_ptr> inactivity_timer_;
 };
 
 } // namespace network
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_CONNECTIONS_HPP
+#define LIBBITCOIN_NETWORK_CONNECTIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A registry of channels indexed by authority and by version nonce.
+/// Lookups are constant time and iteration is over an immutable snapshot
+/// that is shared by all readers until the registry next changes.
+/// This class is thread safe.
+class BCT_API connections
+  : noncopyable
+{
+public:
+    typedef std::vector<channel::ptr> list;
+    typedef std::shared_ptr<const list> snapshot_ptr;
+
+    /// Construct an instance, reserving for the expected number of channels.
+    connections(size_t capacity);
+
+    /// The number of stored channels.
+    size_t size() const;
+
+    /// Determine if a channel to the authority is stored.
+    bool exists(const config::authority& authority) const;
+
+    /// Determine if a channel with the version nonce is stored.
+    bool exists(uint64_t nonce) const;
+
+    /// The stored channels, shared (not copied) until the registry changes.
+    snapshot_ptr snapshot() const;
+
+    /// Store the channel, or error::address_in_use if unique and a channel to
+    /// its authority is already stored, or error::service_stopped if stopped.
+    code store(channel::ptr channel, bool unique);
+
+    /// Remove the channel if it is stored.
+    void remove(channel::ptr channel);
+
+    /// Stop all stored channels and reject subsequent stores.
+    void stop(const code& ec);
+
+private:
+    typedef std::pair<message::ip_address, uint16_t> key;
+
+    struct key_hash
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    struct record
+    {
+        key authority;
+        uint64_t nonce;
+    };
+
+    typedef std::unordered_map<channel::ptr, record> channel_map;
+    typedef std::unordered_map<key, size_t, key_hash> authority_map;
+    typedef std::unordered_map<uint64_t, size_t> nonce_map;
+
+    static key to_key(const config::authority& authority);
+
+    template <typename Map, typename Key>
+    static void decrement(Map& map, const Key& value);
+
+    // The snapshot is accessed only by the std::atomic_* overloads.
+    mutable snapshot_ptr snapshot_;
+
+    // These are protected by the mutex.
+    bool stopped_;
+    channel_map channels_;
+    authority_map authorities_;
+    nonce_map nonces_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -23,15 +23,22 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/socket_profile.hpp>
+#include <bitcoin/network/thread_shards.hpp>
 
 namespace libbitcoin {
 namespace network {
 
 /// Create outbound socket connections.
+/// Attempts to multiple resolved endpoints are raced, staggered in time and
+/// alternating address families, with the first to connect taken.
+/// An authority (numeric address) is connected without name resolution.
 /// This class is thread safe against stop.
 /// This class is not safe for concurrent connection attempts.
 class BCT_API connector
@@ -40,10 +47,19 @@ class BCT_API connector
 public:
     typedef std::shared_ptr<connector> ptr;
     typedef std::function<void(const code& ec, channel::ptr)> connect_handler;
+    typedef std::function<bool()> claim_handler;
 
     /// Construct an instance.
     connector(threadpool& pool, const settings& settings);
 
+    /// Construct an instance that shares resolution results (cache optional).
+    connector(threadpool& pool, const settings& settings,
+        dns_cache::ptr cache);
+
+    /// Construct an instance that also pins its channel to a shard.
+    connector(threadpool& pool, const settings& settings,
+        dns_cache::ptr cache, thread_shards::ptr shards);
+
     /// Validate connector stopped.
     ~connector();
 
@@ -59,30 +75,80 @@ public:
     virtual void connect(const std::string& hostname, uint16_t port,
         connect_handler handler);
 
+    /// Set the options applied to each socket before connect.
+    virtual void set_socket_profile(const socket_profile& profile);
+
+    /// Set the claim, invoked once connected and before the channel is
+    /// created (must be set before connect). If the claim is refused the
+    /// connection is closed and the handler invoked with channel_stopped.
+    virtual void set_claim(claim_handler claim);
+
     /// Cancel outstanding connection attempt.
-    void stop(const code& ec);
+    virtual void stop(const code& ec);
+
+protected:
+    /// True if there is no claim or the connection is claimed.
+    bool claimed() const;
 
 private:
     typedef std::shared_ptr<asio::query> query_ptr;
+    typedef dns_cache::endpoints endpoints;
+
+    // The state of one connection race, protected by its mutex.
+    struct race
+    {
+        typedef std::shared_ptr<race> ptr;
+
+        endpoints targets;
+        std::vector<socket::ptr> sockets;
+        size_t next = 0;
+        size_t pending = 0;
+        bool finished = false;
+        deadline::ptr stagger;
+        connect_handler handler;
+        shared_mutex mutex;
+    };
+
+    static asio::endpoint to_endpoint(const config::authority& authority);
+    static endpoints interleave(asio::iterator iterator);
 
     bool stopped() const;
 
     void handle_resolve(const boost_code& ec, asio::iterator iterator,
+        const std::string& hostname, uint16_t port, connect_handler handler);
+    void start_connect(endpoints&& targets, connect_handler handler);
+    void handle_connect(const boost_code& ec, socket::ptr socket,
         connect_handler handler);
-    void handle_connect(const boost_code& ec, asio::iterator iterator,
-        socket::ptr socket, connect_handler handler);
+
+    void start_attempt(race::ptr state);
+    void handle_stagger(const code& ec, race::ptr state);
+    void handle_attempt(const boost_code& ec, socket::ptr socket,
+        race::ptr state);
+    void handle_race_timer(const code& ec, race::ptr state);
+    void finish(race::ptr state, const code& ec, socket::ptr winner);
+    void prepare(socket::ptr socket, const asio::endpoint& endpoint) const;
+    channel::ptr create_channel(socket::ptr socket) const;
     void handle_timer(const code& ec, socket::ptr socket,
         connect_handler handler);
 
     // These are thread safe
     std::atomic<bool> stopped_;
     threadpool& pool_;
+    threadpool& channel_pool_;
     const settings& settings_;
+    const dns_cache::ptr cache_;
     mutable dispatcher dispatch_;
 
+    // These are set before connect.
+    socket_profile profile_;
+    claim_handler claim_;
+
     // These are protected by mutex.
+    handshake_trace::clock::time_point started_;
+    handshake_trace::clock::time_point resolved_;
     query_ptr query_;
     deadline::ptr timer_;
+    socket::ptr socket_;
     asio::resolver resolver_;
     mutable upgrade_mutex mutex_;
 };
@@ -40,6 +40,16 @@
 // Log name.
 #define LOG_NETWORK "network"
 
+// Verbose network logging is formatted only if enabled is true at runtime.
+// With BCT_DISABLE_VERBOSE defined (--disable-verbose) it is compiled out.
+#ifdef BCT_DISABLE_VERBOSE
+    #define LOG_NETWORK_VERBOSE(enabled) \
+        if (true) {} else LOG_VERBOSE(LOG_NETWORK)
+#else
+    #define LOG_NETWORK_VERBOSE(enabled) \
+        if (!(enabled)) {} else LOG_VERBOSE(LOG_NETWORK)
+#endif
+
 // Avoid namespace conflict between boost::placeholders and std::placeholders.
 #define BOOST_BIND_NO_PLACEHOLDERS
 
@@ -47,7 +57,15 @@
 #include <boost/asio.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/thread.hpp>
+#include <boost/version.hpp>
+
+// With --with-io-uring all socket io is submitted to io_uring in place of the
+// epoll reactor, which is supported by asio as of boost 1.78.
+#if defined(BOOST_ASIO_HAS_IO_URING) && BOOST_VERSION < 107800
+    #error The io_uring backend requires boost 1.78 or later.
+#endif
 
 #endif
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_DISPATCH_POLICY_HPP
+#define LIBBITCOIN_NETWORK_DISPATCH_POLICY_HPP
+
+#include <bitset>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The delivery of received messages to subscribers, by message type.
+/// An invoked type is handled on the read loop, so reading is blocked until
+/// its handlers return (back pressure). A relayed type is posted to the
+/// threadpool, so reading continues while it is handled (latency).
+/// This class is not thread safe.
+class BCT_API dispatch_policy
+{
+public:
+    enum class delivery
+    {
+        invoke,
+        relay
+    };
+
+    /// Construct the default policy (block, ping, pong, transaction, verack
+    /// and version invoked, all other types relayed).
+    dispatch_policy();
+
+    /// The delivery of the message type.
+    delivery get(message::message_type type) const;
+
+    /// Set the delivery of the message type.
+    void set(message::message_type type, delivery value);
+
+    /// The number of message types (version is the last).
+    static constexpr size_t type_count =
+        static_cast<size_t>(message::message_type::version) + 1;
+
+private:
+    static size_t to_index(message::message_type type);
+
+    std::bitset<type_count> invoked_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_DNS_CACHE_HPP
+#define LIBBITCOIN_NETWORK_DNS_CACHE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A bounded cache of name resolution results, thread safe.
+/// Failures are cached (as an empty result) for a shorter period, so that
+/// repeated connection attempts to an unresolvable name are not resolved.
+/// The system resolver does not expose record lifetimes, so these are fixed.
+class BCT_API dns_cache
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<dns_cache> ptr;
+    typedef std::vector<asio::endpoint> endpoints;
+
+    /// Construct a cache, a zero expiration disables that type of entry.
+    dns_cache(size_t capacity, const asio::duration& expiration,
+        const asio::duration& failure_expiration);
+
+    /// Obtain an unexpired result, true if found (endpoints empty if failed).
+    bool find(const std::string& hostname, uint16_t port,
+        endpoints& out) const;
+
+    /// Cache the endpoints resolved for the name.
+    void store(const std::string& hostname, uint16_t port,
+        const endpoints& targets);
+
+    /// Cache the failure to resolve the name.
+    void store_failure(const std::string& hostname, uint16_t port);
+
+    /// Remove all entries.
+    void clear();
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    struct entry
+    {
+        endpoints targets;
+        clock::time_point expiry;
+    };
+
+    typedef std::unordered_map<std::string, entry> table;
+
+    static std::string to_key(const std::string& hostname, uint16_t port);
+
+    void insert(const std::string& key, const endpoints& targets,
+        const asio::duration& expiration);
+
+    // These are thread safe.
+    const size_t capacity_;
+    const asio::duration expiration_;
+    const asio::duration failure_expiration_;
+
+    // This is protected by mutex.
+    table table_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_EVICTION_HPP
+#define LIBBITCOIN_NETWORK_EVICTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/traffic.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Selection of the inbound channel to evict in favor of a new connection
+/// when inbound slots are full. Channels are protected by each criterion in
+/// turn: the lowest round trip, the highest rate of useful messages and the
+/// longest connection. Of the remainder, the channel with the lowest useful
+/// rate (then the youngest) is evicted, and none if all are protected.
+class BCT_API eviction
+{
+public:
+    struct candidate
+    {
+        /// The identity of the candidate to the caller.
+        size_t index;
+
+        /// The average round trip, zero if not measured.
+        asio::duration round_trip;
+
+        /// Useful messages received per second of connection.
+        double useful_rate;
+
+        /// The time since the handshake completed.
+        asio::duration age;
+    };
+
+    typedef std::vector<candidate> candidates;
+
+    /// Select the candidate to evict, false if all are protected.
+    static bool select(candidates values, size_t protect, size_t& out_index);
+
+    /// The number of data carrying messages (blocks, transactions, headers
+    /// and their announcements) received.
+    static uint64_t useful_messages(const traffic::snapshot& traffic);
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_FRAME_CAPTURE_HPP
+#define LIBBITCOIN_NETWORK_FRAME_CAPTURE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Records the frames (heading and payload) received by all channels to a
+/// file, each with its time since the start of capture and the identifier
+/// of its channel, so that real traffic can be replayed through a proxy.
+/// The file is a magic and version followed by little endian records of
+/// [microseconds:8][channel:4][size:4][frame:size].
+/// Each channel records into its own buffer, without a lock, and hands the
+/// full buffer to a background writer, so no network thread writes the file.
+/// Records are therefore grouped by channel, and load orders them by time.
+/// This class is thread safe, excluding each buffer.
+class BCT_API frame_capture
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<frame_capture> ptr;
+    typedef std::chrono::steady_clock clock;
+
+    struct frame
+    {
+        uint64_t microseconds;
+        uint32_t channel;
+        data_chunk data;
+    };
+
+    typedef std::vector<frame> frames;
+
+    /// Open the file for capture, replacing any existing file, and start
+    /// the writer.
+    frame_capture(const boost::filesystem::path& file);
+
+    /// Write any submitted buffers and stop the writer.
+    ~frame_capture();
+
+    /// Load the frames of a capture file, false if not a valid capture.
+    static bool load(const boost::filesystem::path& file, frames& out);
+
+    /// True if the file was opened for capture.
+    bool opened() const;
+
+    /// Assign an identifier to a channel, unique within the capture.
+    uint32_t next_channel();
+
+    /// Record a frame received by the channel to the buffer of the channel,
+    /// which is submitted once full.
+    void record(data_chunk& buffer, uint32_t channel, const uint8_t* data,
+        size_t size);
+
+    /// Hand the buffer (if not empty) to the writer, leaving it empty.
+    void submit(data_chunk& buffer);
+
+    /// Wait for submitted buffers to be written and flush the file.
+    /// Records that remain in channel buffers are not written.
+    void flush();
+
+private:
+    typedef std::vector<data_chunk> buffers;
+
+    void write_buffers();
+
+    const clock::time_point start_;
+    std::atomic<uint32_t> channels_;
+
+    // This is only written by the writer, or when it is idle.
+    bc::ofstream file_;
+    const bool opened_;
+
+    // These are protected by mutex.
+    buffers submitted_;
+    bool writing_;
+    bool stopping_;
+    std::mutex mutex_;
+    std::condition_variable submitted_condition_;
+    std::condition_variable written_condition_;
+
+    std::thread writer_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
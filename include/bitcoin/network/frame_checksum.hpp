@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_FRAME_CHECKSUM_HPP
+#define LIBBITCOIN_NETWORK_FRAME_CHECKSUM_HPP
+
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The message heading checksum, the first four bytes of the double sha256
+/// of the payload (as bitcoin_checksum). The sha extensions of x86 cpus are
+/// used where detected at runtime, otherwise the system implementation.
+class BCT_API frame_checksum
+{
+public:
+    /// The checksum of the payload.
+    static uint32_t compute(const uint8_t* begin, const uint8_t* end);
+
+    /// The checksum of the payload.
+    static uint32_t compute(const data_slice& payload);
+
+    /// True if the sha extensions are used.
+    static bool accelerated();
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_HANDLER_MEMORY_HPP
+#define LIBBITCOIN_NETWORK_HANDLER_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Recycled storage for the asynchronous operations of a handler sequence,
+/// such as the reads (or the writes) of one channel. Asio allocates each
+/// operation through the associated allocator of its handler and releases
+/// the memory before the handler is invoked, so a sequence with one pending
+/// operation reuses the same storage. Larger or overlapping allocations fall
+/// back to the heap. This class is thread safe, so an operation may be
+/// released on one thread as the next is allocated on another.
+class BCT_API handler_memory
+  : noncopyable
+{
+public:
+    /// Operations of up to this size are held in the storage.
+    static const size_t capacity = 1024;
+
+    handler_memory();
+
+    /// Obtain memory of the size, from the storage if it is free.
+    void* allocate(size_t size);
+
+    /// Release memory obtained from allocate.
+    void deallocate(void* pointer);
+
+private:
+    std::aligned_storage<capacity>::type storage_;
+    std::atomic<bool> in_use_;
+};
+
+/// A minimal allocator over handler_memory, as required by asio.
+template <typename Type>
+class handler_allocator
+{
+public:
+    typedef Type value_type;
+
+    explicit handler_allocator(handler_memory& memory)
+      : memory_(memory)
+    {
+    }
+
+    template <typename Other>
+    handler_allocator(const handler_allocator<Other>& other)
+      : memory_(other.memory_)
+    {
+    }
+
+    Type* allocate(size_t count) const
+    {
+        return static_cast<Type*>(memory_.allocate(sizeof(Type) * count));
+    }
+
+    void deallocate(Type* pointer, size_t) const
+    {
+        memory_.deallocate(pointer);
+    }
+
+    template <typename Other>
+    bool operator==(const handler_allocator<Other>& other) const
+    {
+        return &memory_ == &other.memory_;
+    }
+
+    template <typename Other>
+    bool operator!=(const handler_allocator<Other>& other) const
+    {
+        return &memory_ != &other.memory_;
+    }
+
+private:
+    template <typename> friend class handler_allocator;
+
+    handler_memory& memory_;
+};
+
+/// A handler with an associated handler_allocator.
+template <typename Handler>
+class allocating_handler
+{
+public:
+    typedef handler_allocator<Handler> allocator_type;
+
+    allocating_handler(handler_memory& memory, Handler handler)
+      : memory_(memory), handler_(std::move(handler))
+    {
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(memory_);
+    }
+
+    template <typename... Args>
+    void operator()(Args&&... args)
+    {
+        handler_(std::forward<Args>(args)...);
+    }
+
+private:
+    handler_memory& memory_;
+    Handler handler_;
+};
+
+/// Associate the memory with the handler, which must outlive its operation.
+template <typename Handler>
+allocating_handler<typename std::decay<Handler>::type> make_allocating(
+    handler_memory& memory, Handler&& handler)
+{
+    return allocating_handler<typename std::decay<Handler>::type>(memory,
+        std::forward<Handler>(handler));
+}
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_HANDSHAKE_TRACE_HPP
+#define LIBBITCOIN_NETWORK_HANDSHAKE_TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The times at which a channel passed the stages of its connection and
+/// version handshake, each recorded at most once. This class is thread safe.
+class BCT_API handshake_trace
+  : noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// Stages in their nominal order, an inbound channel is not resolved
+    /// and the version may be received before it is sent.
+    enum class stage : size_t
+    {
+        connecting,
+        resolved,
+        connected,
+        started,
+        version_sent,
+        version_received,
+        verack_received,
+        complete
+    };
+
+    static constexpr size_t stage_count = 8;
+
+    /// The name of the stage.
+    static const std::string& to_string(stage value);
+
+    /// Construct with no stage recorded.
+    handshake_trace();
+
+    /// Record the time of a stage, ignored if already recorded.
+    void record(stage value, clock::time_point time=clock::now());
+
+    /// True if the stage has been recorded.
+    bool recorded(stage value) const;
+
+    /// The time from the latest earlier stage, false if either is missing.
+    bool interval(stage value, asio::duration& out) const;
+
+    /// The time from the first recorded stage, false if not recorded.
+    bool elapsed(stage value, asio::duration& out) const;
+
+    /// The time since the stage was recorded, false if not recorded.
+    bool age(stage value, asio::duration& out,
+        clock::time_point now=clock::now()) const;
+
+private:
+    typedef clock::duration::rep ticks;
+
+    ticks get(size_t index) const;
+
+    // Zero is reserved to indicate that the stage is not recorded.
+    std::array<std::atomic<ticks>, stage_count> stages_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_HISTOGRAM_HPP
+#define LIBBITCOIN_NETWORK_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A histogram of durations in power of two microsecond buckets.
+/// Bucket zero counts zero, bucket n counts [2^(n-1), 2^n) microseconds and
+/// the last bucket counts all longer durations. This class is thread safe.
+class BCT_API histogram
+  : noncopyable
+{
+public:
+    static constexpr size_t bucket_count = 32;
+
+    struct snapshot
+    {
+        uint64_t count;
+        uint64_t microseconds;
+        std::array<uint64_t, bucket_count> buckets;
+    };
+
+    /// The bucket of a duration in microseconds.
+    static size_t to_bucket(uint64_t microseconds);
+
+    /// The exclusive upper bound of a bucket in microseconds (max if last).
+    static uint64_t upper_bound(size_t bucket);
+
+    /// The upper bound of the bucket at the percentile (0..100), zero if empty.
+    static uint64_t percentile(const snapshot& values, size_t percent);
+
+    /// Construct an empty histogram.
+    histogram();
+
+    /// Count a duration, a negative duration is counted as zero.
+    void record(const asio::duration& elapsed);
+
+    /// Read all buckets (not an atomic snapshot across buckets).
+    snapshot collect() const;
+
+private:
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> microseconds_;
+    std::array<std::atomic<uint64_t>, bucket_count> buckets_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -23,6 +23,8 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
@@ -34,8 +36,17 @@ namespace network {
 /// This class is thread safe.
 /// The hosts class manages a thread-safe dynamic store of network addresses.
 /// The store can be loaded and saved from/to the specified file path.
-/// The file is a line-oriented set of config::authority serializations.
+/// The file is a versioned header followed by fixed-size records, each a
+/// wire serialization of network_address (with timestamp and services).
+/// A line-oriented file of config::authority serializations is also loaded.
 /// Duplicate addresses and those with zero-valued ports are disacarded.
+/// Addresses are partitioned into shards by a hash of ip and port, each with
+/// its own lock and index, so that writers block only readers of one shard.
+/// Connection history distinguishes tried (previously connected) addresses
+/// from new (gossiped) addresses. Selection is biased toward addresses likely
+/// to connect, and when a shard is full the least promising of a random
+/// sample is replaced, though a new address never displaces a healthy tried
+/// address.
 class BCT_API hosts
   : noncopyable
 {
@@ -53,6 +64,9 @@ public:
     // Save hosts to file.
     virtual code stop();
 
+    /// Save a snapshot of hosts to file without stopping (checkpoint).
+    virtual code save();
+
     virtual size_t count() const;
     virtual code fetch(address& out) const;
     virtual code fetch(address::list& out) const;
@@ -60,22 +74,88 @@ public:
     virtual code store(const address& host);
     virtual void store(const address::list& hosts, result_handler handler);
 
+    /// Record a connection attempt to a stored address.
+    virtual code attempted(const address& host);
+
+    /// Record a successful connection to a stored address (tried).
+    virtual code succeeded(const address& host);
+
+    /// Record a failed connection to a stored address.
+    virtual code failed(const address& host);
+
 private:
-    typedef boost::circular_buffer<address> list;
-    typedef list::iterator iterator;
+    typedef std::pair<message::ip_address, uint16_t> key;
 
-    iterator find(const address& host);
+    // Connection history is retained with each address.
+    // Attempts are those since the last success (or since stored).
+    struct entry
+    {
+        address host;
+        uint32_t attempts;
+        uint32_t last_attempt;
+        uint32_t last_success;
+        uint32_t last_failure;
+    };
 
-    const size_t capacity_;
+    enum class outcome
+    {
+        attempt,
+        success,
+        failure
+    };
+
+    typedef std::vector<entry> list;
+
+    struct key_hash
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    typedef std::unordered_map<key, size_t, key_hash> index;
 
-    // These are protected by a mutex.
-    list buffer_;
+    // A partition of the store, the members are protected by its mutex.
+    struct shard
+    {
+        size_t capacity;
+        list buffer;
+        index table;
+        std::atomic<size_t> size;
+        mutable upgrade_mutex mutex;
+    };
+
+    typedef std::vector<std::unique_ptr<shard>> shards;
+
+    static key to_key(const address& host);
+    static entry to_entry(const address& host);
+    static bool is_stale(const entry& value, uint32_t now);
+    static double quality(const entry& value, uint32_t now);
+    static double chance(const entry& value, uint32_t now);
+    static data_chunk serialize(const list& buffer);
+    static list deserialize(const data_chunk& data);
+
+    static bool exists(const shard& part, const address& host);
+    static bool insert(shard& part, const entry& value, uint32_t now);
+    static void refresh(shard& part, const entry& value);
+    static void erase(shard& part, size_t position);
+
+    shard& select(const address& host) const;
+    bool insert(const entry& value);
+    code record(const address& host, outcome value);
+    code read(list& out) const;
+    code write(const list& buffer) const;
+
+    // These are thread safe.
+    const size_t capacity_;
     std::atomic<bool> stopped_;
-    mutable upgrade_mutex mutex_;
+    shards shards_;
 
-    // HACK: we use this because the buffer capacity cannot be set to zero.
+    // The store is disabled when its capacity is zero.
     const bool disabled_;
     const boost::filesystem::path file_path_;
+    const bool verbose_;
+
+    // This serializes file writes.
+    mutable shared_mutex file_mutex_;
 };
 
 } // namespace network
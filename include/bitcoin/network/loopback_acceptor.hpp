@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_LOOPBACK_ACCEPTOR_HPP
+#define LIBBITCOIN_NETWORK_LOOPBACK_ACCEPTOR_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/acceptor.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/loopback_hub.hpp>
+#include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Accept inbound loopback connections from a hub, in place of sockets.
+/// Connections arriving between accepts are queued until accepted.
+/// This class is thread safe against stop.
+class BCT_API loopback_acceptor
+  : public acceptor
+{
+public:
+    typedef std::shared_ptr<loopback_acceptor> ptr;
+
+    /// Construct an instance.
+    loopback_acceptor(threadpool& pool, const settings& settings,
+        loopback_hub::ptr hub);
+
+    /// Start the listener on the specified port of the hub.
+    code listen(uint16_t port) override;
+
+    /// Start the listener on the port of the endpoint (address ignored).
+    code listen(const asio::endpoint& endpoint, bool shared,
+        bool ipv6_only) override;
+
+    /// Accept the next connection available, until canceled.
+    void accept(accept_handler handler) override;
+
+    /// Set the test applied to each arriving connection.
+    void set_admission(admission_handler admit) override;
+
+    /// Stop listening and cancel the outstanding accept attempt.
+    void stop(const code& ec) override;
+
+private:
+    bool stopped() const override;
+    void handle_connection(transport::ptr transport);
+    channel::ptr create_channel(transport::ptr transport) const;
+
+    // These are thread safe.
+    threadpool& pool_;
+    const settings& settings_;
+    const loopback_hub::ptr hub_;
+    mutable dispatcher dispatch_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    uint16_t port_;
+    accept_handler pending_;
+    admission_handler admit_;
+    std::deque<transport::ptr> arrivals_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
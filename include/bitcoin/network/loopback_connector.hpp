@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_LOOPBACK_CONNECTOR_HPP
+#define LIBBITCOIN_NETWORK_LOOPBACK_CONNECTOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/connector.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/loopback_hub.hpp>
+#include <bitcoin/network/settings.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Create outbound loopback connections to a hub, in place of sockets.
+/// Only the port of the target is significant, there is no resolution.
+/// A port without a listener fails with operation_failed.
+/// This class is thread safe.
+class BCT_API loopback_connector
+  : public connector
+{
+public:
+    typedef std::shared_ptr<loopback_connector> ptr;
+
+    /// Construct an instance.
+    loopback_connector(threadpool& pool, const settings& settings,
+        loopback_hub::ptr hub);
+
+    /// Try to connect to the port of the endpoint.
+    void connect(const config::endpoint& endpoint,
+        connect_handler handler) override;
+
+    /// Try to connect to the port of the authority.
+    void connect(const config::authority& authority,
+        connect_handler handler) override;
+
+    /// Try to connect to the port (hostname ignored).
+    void connect(const std::string& hostname, uint16_t port,
+        connect_handler handler) override;
+
+    /// Cancel outstanding connection attempt.
+    void stop(const code& ec) override;
+
+private:
+    void connect_port(uint16_t port, connect_handler handler);
+
+    // These are thread safe.
+    std::atomic<bool> stopped_;
+    threadpool& pool_;
+    const settings& settings_;
+    const loopback_hub::ptr hub_;
+    mutable dispatcher dispatch_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
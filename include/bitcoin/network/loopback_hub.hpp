@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_LOOPBACK_HUB_HPP
+#define LIBBITCOIN_NETWORK_LOOPBACK_HUB_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// An in-memory network of loopback listeners, by port.
+/// Each connection is given a distinct synthesized client authority, so that
+/// per-address limits do not conflate the many in-process clients.
+/// This class is thread safe.
+class BCT_API loopback_hub
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<loopback_hub> ptr;
+    typedef std::function<void(transport::ptr)> listener;
+
+    /// Construct an instance.
+    loopback_hub();
+
+    /// Register the listener of the port, address_in_use if registered.
+    code listen(uint16_t port, listener handler);
+
+    /// Remove the listener of the port, if any.
+    void unlisten(uint16_t port);
+
+    /// Connect to the listener of the port, returning the client end.
+    /// The server end is passed to the listener, null if not listening.
+    transport::ptr connect(uint16_t port);
+
+private:
+    config::authority next_client();
+
+    std::atomic<uint32_t> clients_;
+
+    // This is protected by mutex.
+    std::unordered_map<uint16_t, listener> listeners_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_LOOPBACK_TRANSPORT_HPP
+#define LIBBITCOIN_NETWORK_LOOPBACK_TRANSPORT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// One end of an in-memory byte stream, for exercising channels, protocols
+/// and sessions at load without sockets. A write is copied to the peer and
+/// completes immediately, so there is no backpressure other than that of
+/// the reading proxy. Stopping either end fails the reads of the other with
+/// eof. Completions are posted to the caller's strand. This class is thread
+/// safe.
+class BCT_API loopback_transport
+  : public transport
+{
+public:
+    typedef std::shared_ptr<loopback_transport> ptr;
+    typedef std::pair<ptr, ptr> pair;
+
+    /// Create a connected pair, the client end first and the server end
+    /// second. The authority of each end is that of its far end.
+    static pair connect(const config::authority& client,
+        const config::authority& server);
+
+    /// Construct an unconnected end (use connect).
+    loopback_transport(const config::authority& authority);
+
+    config::authority authority() const override;
+    void read(const boost::asio::mutable_buffer& buffer, size_t required,
+        strand& strand, io_handler handler) override;
+    void write(const const_buffers& buffers, strand& strand,
+        io_handler handler) override;
+    void stop() override;
+
+private:
+    size_t receive(const const_buffers& buffers);
+    void close();
+    void complete_read();
+
+    const config::authority authority_;
+
+    // These are protected by mutex.
+    std::weak_ptr<loopback_transport> peer_;
+    data_chunk inbound_;
+    size_t offset_;
+    bool stopped_;
+    bool closed_;
+    bool reading_;
+    boost::asio::mutable_buffer read_buffer_;
+    size_t read_required_;
+    strand* read_strand_;
+    io_handler read_handler_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
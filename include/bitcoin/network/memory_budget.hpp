@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_MEMORY_BUDGET_HPP
+#define LIBBITCOIN_NETWORK_MEMORY_BUDGET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A count of bytes shared by the buffers of all channels, thread safe.
+/// Growth beyond the limit is refused, so the caller may defer the work.
+class BCT_API memory_budget
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<memory_budget> ptr;
+
+    /// Construct a budget of limit bytes, zero is unlimited.
+    memory_budget(size_t limit);
+
+    /// Acquire bytes if within the limit, returns false if refused.
+    bool try_acquire(size_t bytes);
+
+    /// Acquire bytes regardless of the limit (minimal allocations).
+    void acquire(size_t bytes);
+
+    /// Release previously-acquired bytes.
+    void release(size_t bytes);
+
+    /// The number of bytes acquired.
+    size_t used() const;
+
+    /// The limit of bytes acquired, zero is unlimited.
+    size_t limit() const;
+
+private:
+    const size_t limit_;
+    std::atomic<size_t> used_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
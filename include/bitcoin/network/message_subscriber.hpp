@@ -19,69 +19,37 @@
 #ifndef LIBBITCOIN_NETWORK_MESSAGE_SUBSCRIBER_HPP
 #define LIBBITCOIN_NETWORK_MESSAGE_SUBSCRIBER_HPP
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <istream>
 #include <functional>
 #include <map>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <string>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dispatch_policy.hpp>
 
 namespace libbitcoin {
 namespace network {
 
-#define DEFINE_SUBSCRIBER_TYPE(value) \
-    typedef resubscriber<code, message::value::const_ptr> \
-        value##_subscriber_type
-
-#define DEFINE_SUBSCRIBER_OVERLOAD(value) \
-    template <typename Handler> \
-    void subscribe(message::value&&, Handler&& handler) \
-    { \
-        value##_subscriber_->subscribe(std::forward<Handler>(handler), \
-            error::channel_stopped, {}); \
-    }
-
-#define DECLARE_SUBSCRIBER(value) \
-    value##_subscriber_type::ptr value##_subscriber_
-
 template <class Message>
 using message_handler =
     std::function<bool(const code&, std::shared_ptr<Message>)>;
 
 /// Aggregation of subscribers by messasge type, thread safe.
+/// The subscriber of a type is created upon its first subscription, in a
+/// table indexed by message type, so the cost of an instance is
+/// proportional to the number of types subscribed.
 class BCT_API message_subscriber
   : noncopyable
 {
 public:
-    DEFINE_SUBSCRIBER_TYPE(address);
-    DEFINE_SUBSCRIBER_TYPE(alert);
-    DEFINE_SUBSCRIBER_TYPE(block);
-    DEFINE_SUBSCRIBER_TYPE(block_transactions);
-    DEFINE_SUBSCRIBER_TYPE(compact_block);
-    DEFINE_SUBSCRIBER_TYPE(fee_filter);
-    DEFINE_SUBSCRIBER_TYPE(filter_add);
-    DEFINE_SUBSCRIBER_TYPE(filter_clear);
-    DEFINE_SUBSCRIBER_TYPE(filter_load);
-    DEFINE_SUBSCRIBER_TYPE(get_address);
-    DEFINE_SUBSCRIBER_TYPE(get_blocks);
-    DEFINE_SUBSCRIBER_TYPE(get_block_transactions);
-    DEFINE_SUBSCRIBER_TYPE(get_data);
-    DEFINE_SUBSCRIBER_TYPE(get_headers);
-    DEFINE_SUBSCRIBER_TYPE(headers);
-    DEFINE_SUBSCRIBER_TYPE(inventory);
-    DEFINE_SUBSCRIBER_TYPE(memory_pool);
-    DEFINE_SUBSCRIBER_TYPE(merkle_block);
-    DEFINE_SUBSCRIBER_TYPE(not_found);
-    DEFINE_SUBSCRIBER_TYPE(ping);
-    DEFINE_SUBSCRIBER_TYPE(pong);
-    DEFINE_SUBSCRIBER_TYPE(reject);
-    DEFINE_SUBSCRIBER_TYPE(send_compact);
-    DEFINE_SUBSCRIBER_TYPE(send_headers);
-    DEFINE_SUBSCRIBER_TYPE(transaction);
-    DEFINE_SUBSCRIBER_TYPE(verack);
-    DEFINE_SUBSCRIBER_TYPE(version);
+    /// Invoked once the handling of a loaded message is complete.
+    typedef std::function<void()> release_handler;
 
     /**
      * Create an instance of this class.
@@ -98,62 +66,145 @@ public:
     template <class Message, typename Handler>
     void subscribe(Handler&& handler)
     {
-        subscribe(Message(), std::forward<Handler>(handler));
+        const auto entry = create<Message>();
+
+        if (!entry)
+        {
+            handler(error::channel_stopped, {});
+            return;
+        }
+
+        entry->subscribe(std::forward<Handler>(handler));
+    }
+
+    /// The message type of the message class, resolved once per class.
+    template <class Message>
+    static message::message_type type_of()
+    {
+        static const auto type = message::heading(0, Message::command, 0, 0)
+            .type();
+        return type;
     }
 
     /**
-     * Load a stream into a message instance and notify subscribers.
-     * @param[in]  stream      The stream from which to load the message.
+     * Load a message instance from a reader and notify subscribers.
+     * @param[in]  source      The reader from which to load the message.
      * @param[in]  version     The peer protocol version.
-     * @param[in]  subscriber  The subscriber for the message type.
+     * @param[in]  subscriber  The subscriber for the message type (or null).
+     * @param[in]  released    Invoked once relayed handlers complete.
      * @return                 Returns error::bad_stream if failed.
      */
     template <class Message, class Subscriber>
-    code relay(std::istream& stream, uint32_t version,
-        Subscriber& subscriber) const
+    code relay(reader& source, uint32_t version,
+        const Subscriber& subscriber,
+        const release_handler& released = nullptr) const
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " message subscriber relay()";
-        
-         auto message = std::make_shared<Message>();
+        const auto message = std::make_shared<Message>();
 
         // Subscribers are invoked only with stop and success codes.
-        if (!message->from_data(version, stream))
+        if (!message->from_data(version, source))
+        {
+            release(released);
             return error::bad_stream;
+        }
+
+        return relay(message, subscriber, released);
+    }
+
+    /**
+     * Relay a loaded message instance to subscribers.
+     * @param[in]  message     The loaded message.
+     * @param[in]  subscriber  The subscriber for the message type (or null).
+     * @param[in]  released    Invoked once relayed handlers complete.
+     * @return                 Returns error::success.
+     */
+    template <class Message, class Subscriber>
+    code relay(const std::shared_ptr<Message>& message,
+        const Subscriber& subscriber,
+        const release_handler& released = nullptr) const
+    {
+        if (!subscriber)
+        {
+            release(released);
+            return error::success;
+        }
+
+        if (!released)
+        {
+            subscriber->relay(error::success, message);
+            return error::success;
+        }
+
+        // This is the relay of the subscriber, followed by the release. The
+        // relays of this instance (channel) are ordered, so messages retain
+        // their order and a handler is not invoked concurrently with itself.
+        ordered()->ordered([subscriber, message, released]()
+        {
+            subscriber->invoke(error::success, message);
+            released();
+        });
 
-        ////const auto const_ptr = std::const_pointer_cast<const Message>(message);
-        subscriber->relay(error::success, message);
         return error::success;
     }
 
     /**
-     * Load a stream into a message instance and invoke subscribers.
-     * @param[in]  stream      The stream from which to load the message.
+     * Load a message instance from a reader and invoke subscribers.
+     * @param[in]  source      The reader from which to load the message.
      * @param[in]  version     The peer protocol version.
-     * @param[in]  subscriber  The subscriber for the message type.
+     * @param[in]  subscriber  The subscriber for the message type (or null).
+     * @param[in]  released    Invoked once handlers complete.
      * @return                 Returns error::bad_stream if failed.
      */
     template <class Message, class Subscriber>
-    code handle(std::istream& stream, uint32_t version,
-        Subscriber& subscriber) const
+    code handle(reader& source, uint32_t version,
+        const Subscriber& subscriber,
+        const release_handler& released = nullptr) const
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " message subscriber handle()";
-         auto message = std::make_shared<Message>();
+        const auto message = std::make_shared<Message>();
 
         // Subscribers are invoked only with stop and success codes.
-        if (!message->from_data(version, stream))
+        if (!message->from_data(version, source))
+        {
+            release(released);
             return error::bad_stream;
+        }
+
+        return handle(message, subscriber, released);
+    }
 
-        ////const auto const_ptr = std::const_pointer_cast<const Message>(message);
-        subscriber->invoke(error::success, message);
+    /**
+     * Invoke subscribers with a loaded message instance.
+     * @param[in]  message     The loaded message.
+     * @param[in]  subscriber  The subscriber for the message type (or null).
+     * @param[in]  released    Invoked once handlers complete.
+     * @return                 Returns error::success.
+     */
+    template <class Message, class Subscriber>
+    code handle(const std::shared_ptr<Message>& message,
+        const Subscriber& subscriber,
+        const release_handler& released = nullptr) const
+    {
+        if (subscriber)
+            subscriber->invoke(error::success, message);
+
+        release(released);
         return error::success;
     }
 
+    /**
+     * Set the delivery (invoke or relay) of each message type.
+     * @param[in]  policy  The delivery policy.
+     */
+    virtual void set_dispatch(const dispatch_policy& policy);
+
+    /**
+     * Determine if the message type has a live handler.
+     * A message of a type without a live handler need not be loaded.
+     * @param[in]  type  The message type identifier.
+     * @return           True if a handler of the type remains subscribed.
+     */
+    virtual bool subscribed(message::message_type type) const;
+
     /**
      * Broadcast a default message instance with the specified error code.
      * @param[in]  ec  The error code to broadcast.
@@ -172,77 +223,220 @@ public:
     virtual code load(message::message_type type, uint32_t version,
         std::istream& stream) const;
 
+    /*
+     * Load a message of the specified command type from a reader.
+     * Use with a deserializer over the payload to avoid stream overhead.
+     * Creates an instance of the indicated message type.
+     * Sends the message instance to each subscriber of the type.
+     * @param[in]  type     The message type identifier.
+     * @param[in]  version  The peer protocol version.
+     * @param[in]  source   The reader from which to load the message.
+     * @return              Returns error::bad_stream if failed.
+     */
+    virtual code load(message::message_type type, uint32_t version,
+        reader& source) const;
+
+    /*
+     * Load a message of the specified command type from a reader.
+     * The release handler is invoked exactly once, upon failure or once the
+     * handlers of the message have completed (including relayed handlers).
+     * A message of a type never subscribed is not loaded.
+     * @param[in]  type      The message type identifier.
+     * @param[in]  version   The peer protocol version.
+     * @param[in]  source    The reader from which to load the message.
+     * @param[in]  released  Invoked once handling of the message completes.
+     * @return               Returns error::bad_stream if failed.
+     */
+    virtual code load(message::message_type type, uint32_t version,
+        reader& source, release_handler released) const;
+
+    /*
+     * Deliver a block decoded by the caller (e.g. progressively as read).
+     * The release handler is invoked exactly once, as above.
+     * @param[in]  block     The decoded block.
+     * @param[in]  released  Invoked once handling of the message completes.
+     * @return               Returns error::success.
+     */
+    virtual code load(message::block::ptr block,
+        release_handler released) const;
+
     /**
-     * Start all subscribers so that they accept subscription.
+     * Start so that subscribers accept subscription.
      */
     virtual void start();
 
     /**
-     * Stop all subscribers so that they no longer accept subscription.
+     * Stop so that subscribers no longer accept subscription.
      */
     virtual void stop();
 
 private:
-    DEFINE_SUBSCRIBER_OVERLOAD(address)
-    DEFINE_SUBSCRIBER_OVERLOAD(alert)
-    DEFINE_SUBSCRIBER_OVERLOAD(block)
-    DEFINE_SUBSCRIBER_OVERLOAD(block_transactions)
-    DEFINE_SUBSCRIBER_OVERLOAD(compact_block)
-    DEFINE_SUBSCRIBER_OVERLOAD(fee_filter)
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_add)
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_clear)
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_load)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_address)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_blocks)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_block_transactions)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_data)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_headers)
-    DEFINE_SUBSCRIBER_OVERLOAD(headers)
-    DEFINE_SUBSCRIBER_OVERLOAD(inventory)
-    DEFINE_SUBSCRIBER_OVERLOAD(memory_pool)
-    DEFINE_SUBSCRIBER_OVERLOAD(merkle_block)
-    DEFINE_SUBSCRIBER_OVERLOAD(not_found)
-    DEFINE_SUBSCRIBER_OVERLOAD(ping)
-    DEFINE_SUBSCRIBER_OVERLOAD(pong)
-    DEFINE_SUBSCRIBER_OVERLOAD(reject)
-    DEFINE_SUBSCRIBER_OVERLOAD(send_compact)
-    DEFINE_SUBSCRIBER_OVERLOAD(send_headers)
-    DEFINE_SUBSCRIBER_OVERLOAD(transaction)
-    DEFINE_SUBSCRIBER_OVERLOAD(verack)
-    DEFINE_SUBSCRIBER_OVERLOAD(version)
-
-    DECLARE_SUBSCRIBER(address);
-    DECLARE_SUBSCRIBER(alert);
-    DECLARE_SUBSCRIBER(block);
-    DECLARE_SUBSCRIBER(block_transactions);
-    DECLARE_SUBSCRIBER(compact_block);
-    DECLARE_SUBSCRIBER(fee_filter);
-    DECLARE_SUBSCRIBER(filter_add);
-    DECLARE_SUBSCRIBER(filter_clear);
-    DECLARE_SUBSCRIBER(filter_load);
-    DECLARE_SUBSCRIBER(get_address);
-    DECLARE_SUBSCRIBER(get_blocks);
-    DECLARE_SUBSCRIBER(get_block_transactions);
-    DECLARE_SUBSCRIBER(get_data);
-    DECLARE_SUBSCRIBER(get_headers);
-    DECLARE_SUBSCRIBER(headers);
-    DECLARE_SUBSCRIBER(inventory);
-    DECLARE_SUBSCRIBER(memory_pool);
-    DECLARE_SUBSCRIBER(merkle_block);
-    DECLARE_SUBSCRIBER(not_found);
-    DECLARE_SUBSCRIBER(ping);
-    DECLARE_SUBSCRIBER(pong);
-    DECLARE_SUBSCRIBER(reject);
-    DECLARE_SUBSCRIBER(send_compact);
-    DECLARE_SUBSCRIBER(send_headers);
-    DECLARE_SUBSCRIBER(transaction);
-    DECLARE_SUBSCRIBER(verack);
-    DECLARE_SUBSCRIBER(version);
-};
+    typedef dispatch_policy::delivery delivery;
+    typedef std::shared_ptr<std::atomic<size_t>> counter;
+
+    // A handler that counts itself out of the live handlers of its type
+    // once it declines resubscription.
+    template <typename Handler>
+    struct counted
+    {
+        template <typename... Args>
+        bool operator()(Args&&... args)
+        {
+            const auto resubscribe = handler(std::forward<Args>(args)...);
+
+            if (!resubscribe)
+                --(*live);
+
+            return resubscribe;
+        }
+
+        counter live;
+        Handler handler;
+    };
+
+    // The subscriber of one message type, a row of the table.
+    class entry
+    {
+    public:
+        typedef std::shared_ptr<entry> ptr;
+
+        virtual ~entry()
+        {
+        }
+
+        bool live() const
+        {
+            return live_->load() != 0;
+        }
+
+        virtual void broadcast(const code& ec) = 0;
+        virtual void stop() = 0;
+        virtual code load(const message_subscriber& owner, reader& source,
+            uint32_t version, delivery value,
+            const release_handler& released) const = 0;
+
+    protected:
+        entry()
+          : live_(std::make_shared<std::atomic<size_t>>(0))
+        {
+        }
+
+        // Shared with the counted handlers, which may outlive the entry.
+        const counter live_;
+    };
+
+    template <class Message>
+    class typed_entry
+      : public entry
+    {
+    public:
+        typedef resubscriber<code, typename Message::const_ptr> subscriber;
+        typedef std::shared_ptr<typed_entry<Message>> ptr;
+
+        typed_entry(threadpool& pool, const std::string& name)
+          : subscriber_(std::make_shared<subscriber>(pool, name))
+        {
+            subscriber_->start();
+        }
+
+        template <typename Handler>
+        void subscribe(Handler&& handler)
+        {
+            typedef counted<typename std::decay<Handler>::type> wrapper;
+
+            // The handler is live until it declines resubscription.
+            ++(*live_);
+            subscriber_->subscribe(
+                wrapper{ live_, std::forward<Handler>(handler) },
+                error::channel_stopped, {});
+        }
 
-#undef DEFINE_SUBSCRIBER_TYPE
-#undef DEFINE_SUBSCRIBER_OVERLOAD
-#undef DECLARE_SUBSCRIBER
+        const typename subscriber::ptr& get() const
+        {
+            return subscriber_;
+        }
+
+        void broadcast(const code& ec) override
+        {
+            subscriber_->relay(ec, {});
+        }
+
+        void stop() override
+        {
+            subscriber_->stop();
+        }
+
+        // Invoking allows us to block the peer while handling the message.
+        code load(const message_subscriber& owner, reader& source,
+            uint32_t version, delivery value,
+            const release_handler& released) const override
+        {
+            return value == delivery::invoke ?
+                owner.handle<Message>(source, version, subscriber_,
+                    released) :
+                owner.relay<Message>(source, version, subscriber_,
+                    released);
+        }
+
+    private:
+        const typename subscriber::ptr subscriber_;
+    };
+
+    typedef std::array<entry::ptr, dispatch_policy::type_count> table;
+
+    static size_t to_index(message::message_type type);
+
+    // Obtain the entry of the type, creating it if null, or null if stopped.
+    template <class Message>
+    typename typed_entry<Message>::ptr create()
+    {
+        typedef typed_entry<Message> typed;
+        auto& member = entries_[to_index(type_of<Message>())];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        mutex_.lock_upgrade();
+
+        if (stopped_ || member)
+        {
+            const auto entry = stopped_ ? nullptr :
+                std::static_pointer_cast<typed>(member);
+            mutex_.unlock_upgrade();
+            //-----------------------------------------------------------------
+            return entry;
+        }
+
+        mutex_.unlock_upgrade_and_lock();
+        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        const auto entry = std::make_shared<typed>(pool_,
+            Message::command + "_sub");
+        member = entry;
+
+        mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        return entry;
+    }
+
+    static void release(const release_handler& released)
+    {
+        if (released)
+            released();
+    }
+
+    // The dispatcher of ordered relays, created upon the first of them.
+    std::shared_ptr<dispatcher> ordered() const;
+
+    // These are thread safe.
+    threadpool& pool_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    table entries_;
+    dispatch_policy policy_;
+    mutable std::shared_ptr<dispatcher> ordered_;
+    mutable upgrade_mutex mutex_;
+};
 
 } // namespace network
 } // namespace libbitcoin
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_METRICS_HPP
+#define LIBBITCOIN_NETWORK_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/handshake_trace.hpp>
+#include <bitcoin/network/histogram.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Connection and handshake counters by session type, cumulative from
+/// construction except for the connected count, and histograms of handshake
+/// durations by stage. This class is thread safe.
+class BCT_API metrics
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<metrics> ptr;
+
+    enum class session_type : size_t
+    {
+        inbound,
+        outbound,
+        manual,
+        seed
+    };
+
+    static constexpr size_t session_types = 4;
+
+    struct session_counts
+    {
+        uint64_t connected;
+        uint64_t attempts;
+        uint64_t failures;
+        uint64_t handshakes;
+        uint64_t handshake_failures;
+        uint64_t handshake_microseconds;
+    };
+
+    typedef std::array<session_counts, session_types> snapshot;
+    typedef std::array<histogram::snapshot, handshake_trace::stage_count>
+        stage_histograms;
+
+    /// The name of the session type.
+    static const std::string& to_string(session_type type);
+
+    /// Construct zeroed counters.
+    metrics();
+
+    /// A connection is attempted or has failed to connect.
+    void attempted(session_type type);
+    void failed(session_type type);
+
+    /// A handshake has completed (with its stages traced) or failed.
+    void handshaken(session_type type, const handshake_trace& trace);
+    void handshake_failed(session_type type);
+
+    /// A channel is registered with or removed from a session.
+    void connected(session_type type);
+    void disconnected(session_type type);
+
+    /// Read all counters (not an atomic snapshot across counters).
+    snapshot collect() const;
+
+    /// Read the histogram of complete handshakes, from the first stage.
+    histogram::snapshot handshakes() const;
+
+    /// Read the histograms of each stage, from the stage preceding it.
+    stage_histograms stages() const;
+
+private:
+    struct counters
+    {
+        std::atomic<uint64_t> connected;
+        std::atomic<uint64_t> attempts;
+        std::atomic<uint64_t> failures;
+        std::atomic<uint64_t> handshakes;
+        std::atomic<uint64_t> handshake_failures;
+        std::atomic<uint64_t> handshake_microseconds;
+    };
+
+    counters& get(session_type type);
+
+    std::array<counters, session_types> sessions_;
+    histogram handshakes_;
+    std::array<histogram, handshake_trace::stage_count> stages_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -19,23 +19,40 @@
 #ifndef LIBBITCOIN_NETWORK_P2P_HPP
 #define LIBBITCOIN_NETWORK_P2P_HPP
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/blacklist.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/connections.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
+#include <bitcoin/network/frame_capture.hpp>
 #include <bitcoin/network/hosts.hpp>
+#include <bitcoin/network/loopback_hub.hpp>
+#include <bitcoin/network/memory_budget.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
+#include <bitcoin/network/metrics.hpp>
 #include <bitcoin/network/sessions/session_inbound.hpp>
 #include <bitcoin/network/sessions/session_manual.hpp>
 #include <bitcoin/network/sessions/session_outbound.hpp>
 #include <bitcoin/network/sessions/session_seed.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
+#include <bitcoin/network/statsd.hpp>
+#include <bitcoin/network/thread_shards.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/token_bucket.hpp>
+#include <bitcoin/network/traffic.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -56,6 +73,7 @@ public:
     typedef std::function<bool(const code&, channel::ptr)> connect_handler;
     typedef subscriber<code> stop_subscriber;
     typedef resubscriber<code, channel::ptr> channel_subscriber;
+    typedef std::pair<config::authority, traffic::snapshot> channel_traffic;
 
     // Templates (send/receive).
     // ------------------------------------------------------------------------
@@ -65,19 +83,65 @@ public:
     void broadcast(const Message& message, channel_handler handle_channel,
         result_handler handle_complete)
     {
-        // Safely copy the channel collection.
-        const auto channels = pending_close_.collection();
+        broadcast(message, max_uint64, handle_channel, handle_complete);
+    }
 
-        // Invoke the completion handler after send complete on all channels.
-        const auto join_handler = synchronize(handle_complete, channels.size(),
-            "p2p_join", synchronizer_terminate::on_count);
+    /// Send a transaction message of the fee rate (satoshis per kilobyte)
+    /// to all connections with a fee filter that accepts the rate.
+    template <typename Message>
+    void broadcast(const Message& message, uint64_t fee_rate,
+        channel_handler handle_channel, result_handler handle_complete)
+    {
+        // The filter of a peer may change, so it is tested once per channel.
+        const auto channels = pending_close_.snapshot();
+        std::vector<channel::ptr> accepted;
+        accepted.reserve(channels->size());
+        std::copy_if(channels->begin(), channels->end(),
+            std::back_inserter(accepted),
+            [fee_rate](const channel::ptr& channel)
+            {
+                return channel->accepts_fee(fee_rate);
+            });
 
-        // No pre-serialize, channels may have different protocol versions.
-        for (const auto channel: channels)
-            channel->send(message, std::bind(&p2p::handle_send, this,
-                std::placeholders::_1, channel, handle_channel, join_handler));
+        // Invoke the completion handler after send complete on all channels.
+        const auto join_handler = make_join(handle_complete, accepted.size());
+
+        // Serialize once for each distinct negotiated protocol version.
+        // The wire encoding is otherwise independent of the channel.
+        std::map<uint32_t, proxy::payload_ptr> payloads;
+        const auto command = proxy::static_command<Message>();
+        const auto type = proxy::static_type<Message>();
+
+        for (const auto& channel: accepted)
+        {
+            const auto version = channel->negotiated_version();
+            auto& payload = payloads[version];
+
+            if (!payload)
+            {
+                const auto buffer = std::make_shared<data_chunk>(
+                    message::heading::satoshi_fixed_size() +
+                    message.serialized_size(version));
+                proxy::serialize(*buffer, message, version,
+                    settings_.identifier);
+                payload = buffer;
+            }
+
+            channel->send(command, type, payload,
+                std::bind(&p2p::handle_send, this, std::placeholders::_1,
+                    channel, handle_channel, join_handler));
+        }
     }
 
+    /// Queue inventory for announcement to all connections, batched per
+    /// connection (in place of a broadcast of each inventory message).
+    virtual void announce(const message::inventory_vector::list& items);
+
+    /// Queue transaction inventory of the fee rate (satoshis per kilobyte)
+    /// for announcement to all connections with a fee filter that accepts it.
+    virtual void announce(const message::inventory_vector::list& items,
+        uint64_t fee_rate);
+
     // Constructors.
     // ------------------------------------------------------------------------
 
@@ -91,6 +155,7 @@ public:
     // ------------------------------------------------------------------------
 
     /// Invoke startup and seeding sequence, call from constructing thread.
+    /// With concurrent_seeding the handler does not await seeding completion.
     virtual void start(result_handler handler);
 
     /// Synchronize the blockchain and then begin long running sessions,
@@ -101,6 +166,7 @@ public:
     // ------------------------------------------------------------------------
 
     /// Idempotent call to signal work stop, start may be reinvoked after.
+    /// The hosts file is saved concurrently with the stop of channels.
     /// Returns the result of file save operation.
     virtual bool stop();
 
@@ -139,6 +205,52 @@ public:
     /// Return a reference to the network threadpool.
     virtual threadpool& thread_pool();
 
+    /// Return the shards to which channels are pinned, null if not sharded.
+    virtual thread_shards::ptr channel_shards() const;
+
+    /// Return the timer wheel shared by channel timers, null if not enabled.
+    virtual timer_wheel::ptr timers() const;
+
+    /// Carry channels over the in-memory hub in place of sockets, for load
+    /// testing in process (set before start, null for tcp).
+    virtual void set_loopback(loopback_hub::ptr hub);
+
+    /// Return the in-memory hub of channels, null if over tcp.
+    virtual loopback_hub::ptr loopback() const;
+
+    /// Return the name resolution cache shared by connectors.
+    virtual dns_cache::ptr name_cache() const;
+
+    /// Return the buffer memory budget shared by channels (and its usage).
+    virtual memory_budget::ptr buffer_budget() const;
+
+    /// Return the rate limit of bytes read by all shaped channels.
+    virtual token_bucket::ptr read_shaping() const;
+
+    /// Return the rate limit of bytes written by all shaped channels.
+    virtual token_bucket::ptr write_shaping() const;
+
+    /// Return the blocked addresses and subnets, changeable at runtime.
+    virtual blacklist::ptr address_blacklist() const;
+
+    /// Return the traffic counters aggregated over all channels.
+    virtual traffic::ptr network_traffic() const;
+
+    /// Snapshot the aggregate traffic of all channels since start.
+    virtual traffic::snapshot traffic_statistics() const;
+
+    /// Snapshot the traffic of each connected channel.
+    virtual std::vector<channel_traffic> channel_traffic_statistics() const;
+
+    /// Return the capture of received frames, null if not capturing.
+    virtual frame_capture::ptr capture() const;
+
+    /// Return the connection and handshake counters of all sessions.
+    virtual metrics::ptr connection_metrics() const;
+
+    /// Collect the gauges reported to the statistics server.
+    virtual statsd::gauges statistics() const;
+
     // Subscriptions.
     // ------------------------------------------------------------------------
 
@@ -148,6 +260,9 @@ public:
     /// Subscribe to service stop event.
     virtual void subscribe_stop(result_handler handler);
 
+    /// Subscribe once to the next storage of addresses in the host pool.
+    virtual void subscribe_hosts(result_handler handler);
+
     // Manual connections.
     // ----------------------------------------------------------------------------
 
@@ -183,6 +298,15 @@ public:
     /// Remove an address.
     virtual code remove(const address& address);
 
+    /// Record a connection attempt to an address.
+    virtual code attempted(const address& address);
+
+    /// Record a successful connection (handshake) to an address.
+    virtual code succeeded(const address& address);
+
+    /// Record a failed connection attempt to an address.
+    virtual code failed(const address& address);
+
     // Pending connect collection.
     // ------------------------------------------------------------------------
 
@@ -225,10 +349,6 @@ protected:
     template <class Session, typename... Args>
     typename Session::ptr attach(Args&&... args)
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " p2p attach()";
         return std::make_shared<Session>(*this, std::forward<Args>(args)...);
     }
 
@@ -239,17 +359,19 @@ protected:
     virtual session_outbound::ptr attach_outbound_session();
 
 private:
-    typedef bc::pending<channel> pending_channels;
     typedef bc::pending<connector> pending_connectors;
 
     void handle_manual_started(const code& ec, result_handler handler);
     void handle_inbound_started(const code& ec, result_handler handler);
     void handle_hosts_loaded(const code& ec, result_handler handler);
+    void handle_checkpoint(const code& ec);
+    void save_anchors() const;
     void handle_hosts_saved(const code& ec, result_handler handler);
     void handle_send(const code& ec, channel::ptr channel,
         channel_handler handle_channel, result_handler handle_complete);
 
     void handle_started(const code& ec, result_handler handler);
+    void handle_seeded(const code& ec);
     void handle_running(const code& ec, result_handler handler);
 
     // These are thread safe.
@@ -258,12 +380,26 @@ private:
     bc::atomic<config::checkpoint> top_block_;
     bc::atomic<config::checkpoint> top_header_;
     bc::atomic<session_manual::ptr> manual_;
+    bc::atomic<loopback_hub::ptr> loopback_;
     threadpool threadpool_;
+    thread_shards::ptr shards_;
+    timer_wheel::ptr timers_;
     hosts hosts_;
+    dns_cache::ptr name_cache_;
+    memory_budget::ptr buffer_budget_;
+    token_bucket::ptr read_shaping_;
+    token_bucket::ptr write_shaping_;
+    blacklist::ptr address_blacklist_;
+    traffic::ptr traffic_;
+    metrics::ptr metrics_;
+    statsd::ptr statsd_;
+    frame_capture::ptr capture_;
+    bc::atomic<deadline::ptr> checkpoint_;
     pending_connectors pending_connect_;
-    pending_channels pending_handshake_;
-    pending_channels pending_close_;
+    connections pending_handshake_;
+    connections pending_close_;
     stop_subscriber::ptr stop_subscriber_;
+    stop_subscriber::ptr hosts_subscriber_;
     channel_subscriber::ptr channel_subscriber_;
 };
 
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_POOLED_TIMER_HPP
+#define LIBBITCOIN_NETWORK_POOLED_TIMER_HPP
+
+#include <functional>
+#include <memory>
+#include <boost/asio/steady_timer.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/handler_memory.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A deadline whose wait operations recycle one handler_memory, for timers
+/// that are restarted for the life of a channel. A wait that overlaps the
+/// cancelled wait of a restart falls back to the heap.
+/// This class is thread safe.
+class BCT_API pooled_timer
+  : public enable_shared_from_base<pooled_timer>, noncopyable
+{
+public:
+    typedef std::shared_ptr<pooled_timer> ptr;
+    typedef std::function<void(const code&)> handler;
+
+    /// Construct a timer of the default duration.
+    pooled_timer(threadpool& pool, const asio::duration& duration);
+
+    /// Start or restart the timer for the default duration.
+    /// The handler is invoked with success on expiry, or failure if stopped.
+    void start(handler handle);
+
+    /// Start or restart the timer for the duration.
+    void start(handler handle, const asio::duration& duration);
+
+    /// Cancel the timer, a pending handler is invoked with failure.
+    void stop();
+
+private:
+    void handle_timer(const boost_code& ec, handler handle) const;
+
+    const asio::duration duration_;
+    boost::asio::steady_timer timer_;
+    handler_memory memory_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -99,6 +99,9 @@ protected:
     /// Get the protocol name, for logging purposes.
     virtual const std::string& name() const;
 
+    /// Test whether verbose logging is enabled.
+    virtual bool verbose() const;
+
     /// Get the channel nonce.
     virtual uint64_t nonce() const;
 
@@ -114,6 +117,12 @@ protected:
     /// Set the negotiated protocol version.
     virtual void set_negotiated_version(uint32_t value);
 
+    /// Record a measured round trip time on the channel.
+    virtual void record_round_trip(const asio::duration& value);
+
+    /// Record the time of a handshake stage on the channel.
+    virtual void record_stage(handshake_trace::stage value);
+
     /// Get the threadpool.
     virtual threadpool& pool();
 
@@ -128,6 +137,7 @@ private:
     dispatcher dispatch_;
     channel::ptr channel_;
     const std::string name_;
+    const bool verbose_;
 };
 
 #undef PROTOCOL_ARGS
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PROTOCOL_COMPACT_BLOCK_70014_HPP
+#define LIBBITCOIN_NETWORK_PROTOCOL_COMPACT_BLOCK_70014_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/protocols/protocol_events.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/**
+ * Compact block relay protocol (BIP152).
+ * Attach this to a channel of version 70014 or later following handshake.
+ * The network has no blocks or pool, so a derived protocol provides the
+ * pooled transactions and stored blocks and accepts reconstructed blocks.
+ */
+class BCT_API protocol_compact_block_70014
+  : public protocol_events, track<protocol_compact_block_70014>
+{
+public:
+    typedef std::shared_ptr<protocol_compact_block_70014> ptr;
+    typedef std::function<void(const chain::transaction&)> visitor;
+    typedef std::function<void(const visitor&)> source;
+
+    /**
+     * Construct a compact block protocol instance.
+     * @param[in]  network         The network interface.
+     * @param[in]  channel         The channel on which to start the protocol.
+     * @param[in]  high_bandwidth  Ask the peer to send blocks unannounced.
+     */
+    protocol_compact_block_70014(p2p& network, channel::ptr channel,
+        bool high_bandwidth);
+
+    /**
+     * Start the protocol.
+     */
+    virtual void start();
+
+    /**
+     * Send the block as a compact block if the peer has asked for high
+     * bandwidth relay, otherwise the block is announced by other means.
+     * @return  True if the compact block was sent.
+     */
+    virtual bool announce(block_const_ptr block);
+
+    /// The compact form of a block, with its coinbase prefilled.
+    static message::compact_block to_compact_block(
+        const message::block& block, uint64_t nonce, bool witness);
+
+    /// The wire (differential) form of ascending transaction indexes.
+    static std::vector<uint64_t> to_differential(
+        const std::vector<uint64_t>& indexes);
+
+    /// The ascending indexes of the wire form, false if one is not less
+    /// than the count.
+    static bool to_absolute(std::vector<uint64_t>& out,
+        const std::vector<uint64_t>& differential, size_t count);
+
+    /// Fill the transactions of the block from its prefilled transactions
+    /// and those visited by the source, matched by short id. The ascending
+    /// indexes of unmatched and ambiguous slots are returned as missing.
+    /// False if the compact block is invalid.
+    static bool populate(chain::transaction::list& out,
+        std::vector<uint64_t>& missing, const message::compact_block& block,
+        bool witness, const source& pooled);
+
+protected:
+    /// Override to visit the transactions from which blocks are
+    /// reconstructed (e.g. the memory pool), in place and without copying
+    /// the pool. The visitor must not be retained. None by default.
+    virtual void visit_pooled(const visitor& visit) const;
+
+    /// Override to provide a stored block, for transaction requests.
+    virtual block_const_ptr fetch_block(const hash_digest& hash) const;
+
+    /// Override to accept a reconstructed block (its merkle root is valid).
+    virtual void handle_reconstructed(block_const_ptr block);
+
+    virtual bool handle_receive_send_compact(const code& ec,
+        send_compact_const_ptr message);
+    virtual bool handle_receive_compact_block(const code& ec,
+        compact_block_const_ptr message);
+    virtual bool handle_receive_get_block_transactions(const code& ec,
+        get_block_transactions_const_ptr message);
+    virtual bool handle_receive_block_transactions(const code& ec,
+        block_transactions_const_ptr message);
+
+private:
+    struct reconstruction
+    {
+        chain::header header;
+        chain::transaction::list transactions;
+        std::vector<uint64_t> missing;
+    };
+
+    typedef std::map<hash_digest, reconstruction> reconstructions;
+
+    bool witness() const;
+    void complete(const chain::header& header,
+        chain::transaction::list&& transactions);
+    void request_block(const hash_digest& hash);
+
+    const bool high_bandwidth_;
+    const bool own_witness_;
+
+    // These are thread safe.
+    std::atomic<uint64_t> version_;
+    std::atomic<bool> peer_high_bandwidth_;
+
+    // These are protected by the mutex (order_ is oldest first).
+    reconstructions pending_;
+    std::deque<hash_digest> order_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -19,9 +19,11 @@
 #ifndef LIBBITCOIN_NETWORK_PROTOCOL_PING_60001_HPP
 #define LIBBITCOIN_NETWORK_PROTOCOL_PING_60001_HPP
 
-#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
@@ -43,6 +45,14 @@ class BCT_API protocol_ping_60001
 {
 public:
     typedef std::shared_ptr<protocol_ping_60001> ptr;
+    typedef std::chrono::steady_clock clock;
+    typedef std::pair<uint64_t, clock::time_point> sent_ping;
+    typedef std::vector<sent_ping> sent_pings;
+
+    /// Remove the ping of the nonce and each ping sent before it, as these
+    /// are no longer answerable in order. False if the nonce is not found.
+    static bool match(sent_pings& outstanding, uint64_t nonce,
+        clock::time_point& sent);
 
     /**
      * Construct a ping protocol instance.
@@ -51,16 +61,25 @@ public:
      */
     protocol_ping_60001(p2p& network, channel::ptr channel);
 
+    /**
+     * Start the protocol.
+     */
+    void start() override;
+
 protected:
     void send_ping(const code& ec) override;
 
     void handle_send_ping(const code& ec, const std::string& command);
     bool handle_receive_ping(const code& ec, ping_const_ptr message) override;
-    virtual bool handle_receive_pong(const code& ec, pong_const_ptr message,
-        uint64_t nonce);
+    virtual bool handle_receive_pong(const code& ec, pong_const_ptr message);
 
 private:
-    std::atomic<bool> pending_;
+    // This is protected by the mutex. The protocol timer (or timer wheel)
+    // that sends pings does not run on the channel strand, and a relayed
+    // pong is handled on the relay dispatcher, so the heartbeat and the pong
+    // handler are concurrent. Only the pong handler records round trips.
+    sent_pings outstanding_;
+    mutable shared_mutex mutex_;
 };
 
 } // namespace network
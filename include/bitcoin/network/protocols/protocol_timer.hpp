@@ -24,6 +24,7 @@
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/protocols/protocol_events.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -62,6 +63,7 @@ protected:
 
 protected:
     void reset_timer();
+    void stop_timer();
 
 private:
     void handle_timer(const code& ec);
@@ -69,6 +71,11 @@ private:
 
     const bool perpetual_;
     deadline::ptr timer_;
+
+    // The wheel, if enabled, is used in place of the deadline.
+    const timer_wheel::ptr timers_;
+    asio::duration timeout_;
+    bc::atomic<timer_wheel::timer_ptr> wheel_timer_;
 };
 
 } // namespace network
@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_NETWORK_PROTOCOL_VERSION_31402_HPP
 #define LIBBITCOIN_NETWORK_PROTOCOL_VERSION_31402_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -62,7 +63,8 @@ public:
 
     /**
      * Start the protocol.
-     * @param[in]  handler  Invoked upon stop or receipt of version and verack.
+     * @param[in]  handler  Invoked once, upon failure or stop or receipt of
+     *                      both version and verack (in either order).
      */
     virtual void start(event_handler handler);
 
@@ -71,8 +73,11 @@ protected:
     using protocol_timer::start;
 
     virtual message::version version_factory() const;
+    virtual bool sufficient_configuration() const;
     virtual bool sufficient_peer(version_const_ptr message);
 
+    virtual void handle_send_version(const code& ec);
+
     virtual bool handle_receive_version(const code& ec,
         version_const_ptr version);
     virtual bool handle_receive_verack(const code& ec, verack_const_ptr);
@@ -83,6 +88,12 @@ protected:
     const uint64_t invalid_services_;
     const uint32_t minimum_version_;
     const uint64_t minimum_services_;
+
+private:
+    void handle_event(const code& ec, event_handler handler);
+
+    std::atomic<size_t> received_;
+    std::atomic<bool> complete_;
 };
 
 } // namespace network
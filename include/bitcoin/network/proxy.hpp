@@ -19,22 +19,40 @@
 #ifndef LIBBITCOIN_NETWORK_PROXY_HPP
 #define LIBBITCOIN_NETWORK_PROXY_HPP
 
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
+#include <boost/asio/steady_timer.hpp>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
+#include <bitcoin/network/block_decoder.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dispatch_policy.hpp>
+#include <bitcoin/network/frame_capture.hpp>
+#include <bitcoin/network/frame_checksum.hpp>
+#include <bitcoin/network/handler_memory.hpp>
+#include <bitcoin/network/memory_budget.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/token_bucket.hpp>
+#include <bitcoin/network/traffic.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
 
-/// Manages all socket communication, thread safe.
+/// Manages all communication over a transport, thread safe.
+/// Reads, writes and their completions execute on the channel's strand, so
+/// the per-message state of the channel is not locked.
 class BCT_API proxy
   : public enable_shared_from_base<proxy>, noncopyable
 {
@@ -42,10 +60,30 @@ public:
     typedef std::shared_ptr<proxy> ptr;
     typedef std::function<void(const code&)> result_handler;
     typedef subscriber<code> stop_subscriber;
+    typedef std::shared_ptr<const std::string> command_ptr;
+    typedef std::shared_ptr<const data_chunk> payload_ptr;
 
-    /// Construct an instance.
+    /// Queued messages are written in this order, so that a control message
+    /// is not delayed behind a backlog of blocks and transactions.
+    enum class priority : size_t
+    {
+        control,
+        announce,
+        bulk
+    };
+
+    static constexpr size_t priority_count = 3;
+
+    /// The send priority of a message type.
+    static priority to_priority(message::message_type type);
+
+    /// Construct an instance over a tcp socket.
     proxy(threadpool& pool, socket::ptr socket, const settings& settings);
 
+    /// Construct an instance over the transport (e.g. in-memory loopback).
+    proxy(threadpool& pool, transport::ptr transport,
+        const settings& settings);
+
     /// Validate proxy stopped.
     ~proxy();
 
@@ -53,24 +91,60 @@ public:
     template <class Message>
     void send(const Message& message, result_handler handler)
     {
-        auto data = message::serialize(version_, message, protocol_magic_);
-        const auto payload = std::make_shared<data_chunk>(std::move(data));
-        const auto command = std::make_shared<std::string>(message.command);
-
-        // Sequential dispatch is required because write may occur in multiple
-        // asynchronous steps invoked on different threads, causing deadlocks.
-        dispatch_.lock(&proxy::do_send,
-            shared_from_this(), command, payload, handler);
+        const auto version = version_.load();
+        const auto payload_size = message.serialized_size(version);
+        const auto buffer = buffers_.acquire(
+            message::heading::satoshi_fixed_size() + payload_size);
+
+        serialize(*buffer, message, version, protocol_magic_);
+        send(static_command<Message>(), static_type<Message>(), buffer,
+            handler);
+    }
+
+    /// Reference the static command name of the message type, no allocation.
+    template <class Message>
+    static command_ptr static_command()
+    {
+        return command_ptr(command_ptr(), &Message::command);
+    }
+
+    /// The message type of the message class, resolved once per class.
+    template <class Message>
+    static message::message_type static_type()
+    {
+        return message_subscriber::type_of<Message>();
+    }
+
+    /// Serialize a message (heading and payload) into a presized buffer.
+    template <class Message>
+    static void serialize(data_chunk& out, const Message& message,
+        uint32_t version, uint32_t magic)
+    {
+        const auto payload = std::next(out.begin(),
+            message::heading::satoshi_fixed_size());
+        auto payload_sink = make_unsafe_serializer(payload);
+        message.to_data(version, payload_sink);
+
+        const auto payload_size = std::distance(payload, out.end());
+        const auto payload_begin = out.data() +
+            message::heading::satoshi_fixed_size();
+        const message::heading head(magic, Message::command,
+            static_cast<uint32_t>(payload_size),
+            frame_checksum::compute(payload_begin, out.data() + out.size()));
+        auto heading_sink = make_unsafe_serializer(out.begin());
+        head.to_data(heading_sink);
     }
 
+    /// Send a serialized message (heading and payload) on the socket.
+    /// The payload must be serialized at the negotiated version of this
+    /// socket, which allows a single serialization to be shared by channels.
+    virtual void send(command_ptr command, message::message_type type,
+        payload_ptr payload, result_handler handler);
+
     /// Subscribe to messages of the specified type on the socket.
     template <class Message>
     void subscribe(message_handler<Message>&& handler)
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " proxy subscribe()";
         message_subscriber_.subscribe<Message>(
             std::forward<message_handler<Message>>(handler));
     }
@@ -88,6 +162,26 @@ public:
     /// Save the negotiated protocol version.
     virtual void set_negotiated_version(uint32_t value);
 
+    /// Set the delivery of received messages to subscribers, by type.
+    virtual void set_dispatch(const dispatch_policy& policy);
+
+    /// Account read buffer memory to the budget (must be set before start).
+    virtual void set_budget(memory_budget::ptr budget);
+
+    /// Also count traffic to the aggregate (must be set before start).
+    virtual void set_traffic(traffic::ptr aggregate);
+
+    /// Record received frames to the capture (must be set before start).
+    virtual void set_capture(frame_capture::ptr capture);
+
+    /// Limit the read and write rates of this channel to the shared limits
+    /// and to the configured channel limits (must be set before start).
+    /// A channel without shaping (e.g. manual) is not rate limited.
+    virtual void set_shaping(token_bucket::ptr read, token_bucket::ptr write);
+
+    /// The traffic counters of this channel.
+    traffic::snapshot traffic_statistics() const;
+
     /// Read messages from this socket.
     virtual void start(result_handler handler);
 
@@ -96,46 +190,111 @@ public:
 
 protected:
     virtual bool stopped() const;
+
+    /// Wrap a handler so that it is invoked on the strand of this channel.
+    result_handler stranded(result_handler handler);
+
     virtual void signal_activity() = 0;
     virtual void handle_stopping() = 0;
 
 private:
-    typedef byte_source<data_chunk> payload_source;
-    typedef boost::iostreams::stream<payload_source> payload_stream;
-    typedef std::shared_ptr<std::string> command_ptr;
-    typedef std::shared_ptr<data_chunk> payload_ptr;
-
     void stop(const boost_code& ec);
 
-    void read_heading();
-    void handle_read_heading(const boost_code& ec, size_t payload_size);
+    static asio::duration shape(token_bucket::ptr shared,
+        token_bucket::ptr own, size_t bytes);
 
-    void read_payload(const message::heading& head);
-    void handle_read_payload(const boost_code& ec, size_t,
-        const message::heading& head);
+    void read_more(size_t required);
+    void defer_read(size_t required, const asio::duration& delay);
+    void handle_throttle(const boost_code& ec, size_t required);
+    bool resize_read_buffer(size_t size);
+    void handle_read(const boost_code& ec, size_t bytes);
+    void read_frames();
+    bool read_payload(const message::heading& head, const uint8_t* begin,
+        const uint8_t* end);
+    bool progressive(const message::heading& head) const;
+    bool load_block(const message::heading& head, const uint8_t* begin);
+    bool congested() const;
+    void post_release(size_t size);
+    void handle_release(size_t size);
+
+    struct queued_send
+    {
+        command_ptr command;
+        payload_ptr payload;
+        result_handler handler;
+        std::chrono::steady_clock::time_point queued;
+        size_t traffic_index;
+    };
 
-    void do_send(command_ptr command, payload_ptr payload,
-        result_handler handler);
-    void handle_send(const boost_code& ec, size_t bytes, command_ptr command,
+    typedef std::deque<queued_send> send_queue;
+    typedef std::vector<queued_send> send_batch;
+    typedef std::vector<boost::asio::const_buffer> write_buffers;
+
+    void do_send(command_ptr command, message::message_type type,
         payload_ptr payload, result_handler handler);
+    void write_next();
+    void defer_write(const asio::duration& delay);
+    void handle_deferred_write(const boost_code& ec);
+    void handle_write(const boost_code& ec, size_t bytes);
+    void handle_stop();
+    void add_traffic();
 
+    threadpool& pool_;
     const config::authority authority_;
+    boost::asio::io_context::strand strand_;
+
+    // These are protected by the strand (reads).
+    data_chunk read_buffer_;
+    size_t read_begin_;
+    size_t read_end_;
+    size_t read_reserve_;
+    block_decoder decoder_;
+    memory_budget::ptr budget_;
+    traffic::ptr network_traffic_;
+    frame_capture::ptr capture_;
+    uint32_t capture_channel_;
+    data_chunk capture_buffer_;
+    transport::ptr transport_;
+    size_t pending_messages_;
+    size_t pending_bytes_;
+    bool paused_;
+    std::chrono::steady_clock::time_point read_resume_;
+    boost::asio::steady_timer read_deferral_;
+    handler_memory read_deferral_memory_;
 
-    // These are protected by read header/payload ordering.
-    data_chunk heading_buffer_;
-    data_chunk payload_buffer_;
-    socket::ptr socket_;
+    // These are set before start, buckets are null if not shaped.
+    token_bucket::ptr read_shaping_;
+    token_bucket::ptr write_shaping_;
+    token_bucket::ptr channel_read_shaping_;
+    token_bucket::ptr channel_write_shaping_;
+
+    // These are protected by the strand (writes).
+    bool writing_;
+    std::array<send_queue, priority_count> queues_;
+    send_batch batch_;
+    write_buffers write_buffers_;
+    boost::asio::steady_timer write_deferral_;
+    handler_memory write_deferral_memory_;
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     const uint32_t protocol_magic_;
     const size_t maximum_payload_;
     const bool validate_checksum_;
+    const bool progressive_decoding_;
     const bool verbose_;
+    const size_t pending_messages_limit_;
+    const size_t pending_bytes_limit_;
+    const double channel_read_rate_;
+    const double channel_write_rate_;
     std::atomic<uint32_t> version_;
+    buffer_pool buffers_;
+    traffic traffic_;
+
+    // This is protected by the strand (reads and writes).
+    traffic::tally tally_;
     message_subscriber message_subscriber_;
     stop_subscriber::ptr stop_subscriber_;
-    dispatcher dispatch_;
 };
 
 } // namespace network
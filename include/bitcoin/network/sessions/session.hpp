@@ -29,8 +29,12 @@
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/connector.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dispatch_policy.hpp>
+#include <bitcoin/network/metrics.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
+#include <bitcoin/network/socket_profile.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -86,11 +90,7 @@ protected:
     template <class Protocol, typename... Args>
     typename Protocol::ptr attach(channel::ptr channel, Args&&... args)
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " session attach()";
-        return std::make_shared<Protocol>(network_, channel,
+        return make_pooled<Protocol>(network_, channel,
             std::forward<Args>(args)...);
     }
 
@@ -99,10 +99,6 @@ protected:
     auto bind(Handler&& handler, Args&&... args) ->
         decltype(BOUND_SESSION_TYPE(handler, args)) const
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " session bind()";
         return BOUND_SESSION(handler, args);
     }
 
@@ -111,10 +107,6 @@ protected:
     auto concurrent_delegate(Handler&& handler, Args&&... args) ->
         delegates::concurrent<decltype(BOUND_SESSION_TYPE(handler, args))> const
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " session concurrent_delegate()";
         return dispatch_.concurrent_delegate(SESSION_ARGS(handler, args));
     }
 
@@ -122,20 +114,12 @@ protected:
     inline void dispatch_delayed(const asio::duration& delay,
         dispatcher::delay_handler handler) const
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " session dispatch_delayed()";
         dispatch_.delayed(delay, handler);
     }
 
     /// Delay timing for a tight failure loop, based on configured timeout.
     inline asio::duration cycle_delay(const code& ec)
     {
-        const auto this_id = boost::this_thread::get_id();
-        LOG_VERBOSE(LOG_NETWORK)
-        << this_id
-        << " session cycle_delay()";
         return (ec == error::channel_timeout || ec == error::service_stopped ||
             ec == error::success) ? asio::seconds(0) :
             settings_.connect_timeout();
@@ -151,6 +135,25 @@ protected:
     virtual bool stopped() const;
     virtual bool stopped(const code& ec) const;
 
+    /// The delivery of received messages on channels of this session.
+    virtual const dispatch_policy& message_dispatch() const;
+
+    /// The options applied to the sockets of this session (by type).
+    virtual const socket_profile& socket_options() const;
+
+    /// The type under which channels of this session are counted.
+    virtual metrics::session_type metrics_type() const;
+
+    /// Connection history.
+    // ------------------------------------------------------------------------
+
+    virtual void attempted(const authority& authority);
+    virtual void succeeded(const authority& authority);
+    virtual void failed(const authority& authority);
+
+    /// Count a connection attempt and its failure, if failed.
+    virtual void count_connect(const code& ec);
+
     /// Socket creators.
     // ------------------------------------------------------------------------
 
@@ -19,6 +19,11 @@
 #ifndef LIBBITCOIN_NETWORK_SESSION_BATCH_HPP
 #define LIBBITCOIN_NETWORK_SESSION_BATCH_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/connector.hpp>
@@ -32,9 +37,21 @@ namespace network {
 class p2p;
 
 /// Intermediate base class for adding batch connect sequence.
+/// The batch size adapts to the recent success rate of connection attempts,
+/// so that a batch is likely to produce at least one connection.
+/// The first connection is taken and the remaining attempts are cancelled,
+/// a channel is created only for the connection taken.
 class BCT_API session_batch
   : public session
 {
+public:
+    /// The current number of concurrent attempts per connection.
+    virtual size_t batch_size() const;
+
+    /// The smallest batch size, within the range, that is likely to produce
+    /// a connection at the weighted success rate of recent attempts.
+    static size_t adapted_size(double rate, size_t minimum, size_t maximum);
+
 protected:
 
     /// Construct an instance.
@@ -44,14 +61,43 @@ protected:
     virtual void connect(channel_handler handler);
 
 private:
+    typedef std::chrono::steady_clock clock;
+
+    // The state of one batch, protected by its mutex.
+    struct batch
+    {
+        typedef std::shared_ptr<batch> ptr;
+
+        channel_handler handler;
+        std::vector<connector::ptr> connectors;
+        size_t pending;
+        bool claimed;
+        bool finished;
+        shared_mutex mutex;
+    };
+
     // Connect sequence
-    void new_connect(channel_handler handler);
+    void new_connect(batch::ptr state);
     void start_connect(const code& ec, const authority& host,
-        channel_handler handler);
+        batch::ptr state);
     void handle_connect(const code& ec, channel::ptr channel,
-        connector::ptr connector, channel_handler handler);
+        const authority& host, clock::time_point started,
+        connector::ptr connector, batch::ptr state);
+    bool claim(batch::ptr state);
+    bool complete(batch::ptr state, const code& ec, channel::ptr channel);
+
+    // Batch size adaptation.
+    void record(const code& ec, clock::time_point started);
+
+    // These are thread safe.
+    const size_t minimum_;
+    const size_t maximum_;
+    std::atomic<size_t> batch_size_;
 
-    const size_t batch_size_;
+    // These are protected by mutex.
+    std::vector<double> outcomes_;
+    size_t next_outcome_;
+    mutable shared_mutex mutex_;
 };
 
 } // namespace network
@@ -19,15 +19,19 @@
 #ifndef LIBBITCOIN_NETWORK_SESSION_INBOUND_HPP
 #define LIBBITCOIN_NETWORK_SESSION_INBOUND_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/acceptor.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/connections.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/sessions/session.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/token_bucket.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -35,19 +39,39 @@ namespace network {
 class p2p;
 
 /// Inbound connections session, thread safe.
+/// When full, a new connection may evict the worst unprotected inbound
+/// channel (see eviction) in place of its rejection.
 class BCT_API session_inbound
   : public session, track<session_inbound>
 {
 public:
     typedef std::shared_ptr<session_inbound> ptr;
 
+    /// Counts of inbound admission decisions since start.
+    struct admissions
+    {
+        size_t admitted;
+        size_t blocked;
+        size_t saturated;
+        size_t address_capped;
+        size_t subnet_capped;
+        size_t rate_limited;
+        size_t evicted;
+    };
+
     /// Construct an instance.
     session_inbound(p2p& network, bool notify_on_connect);
 
     /// Start the session.
     void start(result_handler handler) override;
 
+    /// The counts of inbound admission decisions.
+    virtual admissions admission_counts() const;
+
 protected:
+    /// Channels of this session are counted as inbound.
+    metrics::session_type metrics_type() const override;
+
     /// Overridden to implement pending test for inbound channels.
     void handshake_complete(channel::ptr channel,
         result_handler handle_started) override;
@@ -55,19 +79,70 @@ protected:
     /// Override to attach specialized protocols upon channel start.
     virtual void attach_protocols(channel::ptr channel);
 
+    /// Test an accepted socket's address before its channel is constructed.
+    virtual code admit(const authority& authority);
+
+    /// Stop the worst unprotected inbound channel, false if none.
+    virtual bool evict();
+
 private:
-    void start_accept(const code& ec);
+    typedef message::ip_address address_key;
+
+    struct address_hash
+    {
+        size_t operator()(const address_key& value) const;
+    };
+
+    struct subnet_state
+    {
+        size_t connections;
+        token_bucket::ptr bucket;
+    };
+
+    typedef std::unordered_map<address_key, size_t, address_hash> address_map;
+    typedef std::unordered_map<address_key, subnet_state, address_hash>
+        subnet_map;
+
+    typedef std::vector<asio::endpoint> endpoints;
+
+    static address_key to_subnet(const address_key& ip);
+    static asio::endpoint to_endpoint(const authority& authority);
+
+    endpoints listen_endpoints() const;
+    size_t listeners_per_endpoint() const;
+    code listen(const endpoints& endpoints);
+
+    code reserve(const address_key& ip);
+    void release(const address_key& ip);
+    void prune();
+
+    void start_accept(const code& ec, acceptor::ptr acceptor);
 
     void handle_stop(const code& ec);
     void handle_started(const code& ec, result_handler handler);
-    void handle_accept(const code& ec, channel::ptr channel);
+    void handle_accept(const code& ec, channel::ptr channel,
+        acceptor::ptr acceptor);
 
     void handle_channel_start(const code& ec, channel::ptr channel);
-    void handle_channel_stop(const code& ec);
+    void handle_channel_stop(const code& ec, channel::ptr channel);
 
     // These are thread safe.
-    acceptor::ptr acceptor_;
+    std::vector<acceptor::ptr> acceptors_;
     const size_t connection_limit_;
+    token_bucket accept_rate_;
+    std::atomic<size_t> admitted_;
+    std::atomic<size_t> blocked_;
+    std::atomic<size_t> saturated_;
+    std::atomic<size_t> address_capped_;
+    std::atomic<size_t> subnet_capped_;
+    std::atomic<size_t> rate_limited_;
+    std::atomic<size_t> evicted_;
+    connections channels_;
+
+    // These are protected by the mutex.
+    address_map addresses_;
+    subnet_map subnets_;
+    mutable shared_mutex mutex_;
 };
 
 } // namespace network
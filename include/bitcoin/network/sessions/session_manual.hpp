@@ -57,6 +57,9 @@ public:
         channel_handler handler);
 
 protected:
+    /// Channels of this session are counted as manual.
+    metrics::session_type metrics_type() const override;
+
     /// Override to attach specialized protocols upon channel start.
     virtual void attach_protocols(channel::ptr channel);
 
@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_NETWORK_SESSION_OUTBOUND_HPP
 #define LIBBITCOIN_NETWORK_SESSION_OUTBOUND_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
@@ -33,6 +34,10 @@ namespace network {
 class p2p;
 
 /// Outbound connections session, thread safe.
+/// A slot that fails to connect is retried after a jittered exponential
+/// backoff, by failure class, and a slot that finds the address pool empty
+/// awaits the storage of addresses, so a poor pool does not spin.
+/// The anchor peers saved at the last shutdown are connected first.
 class BCT_API session_outbound
   : public session_batch, track<session_outbound>
 {
@@ -60,14 +65,28 @@ protected:
 private:
     void new_connection(const code&);
 
+    typedef std::shared_ptr<std::atomic<bool>> wake_flag;
+
     void handle_started(const code& ec, result_handler handler);
     void handle_connect(const code& ec, channel::ptr channel);
 
+    void connect_anchor(const config::authority& host);
+    void handle_anchor(const code& ec, channel::ptr channel,
+        const config::authority& host, connector::ptr connector);
+
+    asio::duration backoff(const code& ec);
+    void await_hosts();
+    void handle_hosts(const code& ec, wake_flag woken);
+
     void do_unpend(const code& ec, channel::ptr channel,
         result_handler handle_started);
 
     void handle_channel_stop(const code& ec, channel::ptr channel);
     void handle_channel_start(const code& ec, channel::ptr channel);
+
+    // Consecutive failures by class, reset by a connection.
+    std::atomic<size_t> blocked_failures_;
+    std::atomic<size_t> network_failures_;
 };
 
 } // namespace network
@@ -48,6 +48,9 @@ public:
     void start(result_handler handler) override;
 
 protected:
+    /// Channels of this session are counted as seed.
+    metrics::session_type metrics_type() const override;
+
     /// Overridden to set service and version mins upon session start.
     void attach_handshake_protocols(channel::ptr channel,
         result_handler handle_started) override;
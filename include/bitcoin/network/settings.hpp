@@ -21,8 +21,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dispatch_policy.hpp>
+#include <bitcoin/network/socket_profile.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -35,31 +39,72 @@ public:
     settings(config::settings context);
 
     /// Properties.
+    /// With channel_shards the threads are the total, one for the network
+    /// threadpool and each other for a channel shard (at least one).
     uint32_t threads;
+    bool channel_shards;
     uint32_t protocol_maximum;
     uint32_t protocol_minimum;
     uint64_t services;
     uint64_t invalid_services;
     bool relay_transactions;
+    uint64_t minimum_fee_rate;
     bool validate_checksum;
+    bool progressive_decoding;
     uint32_t identifier;
     uint16_t inbound_port;
     uint32_t inbound_connections;
+    uint32_t inbound_acceptors;
+    uint32_t inbound_address_connections;
+    uint32_t inbound_subnet_connections;
+    uint32_t inbound_accepts_per_minute;
+    uint32_t inbound_subnet_accepts_per_minute;
+    uint32_t inbound_accept_burst;
+    bool inbound_eviction;
+    uint32_t inbound_eviction_protected;
     uint32_t outbound_connections;
     uint32_t manual_attempt_limit;
     uint32_t connect_batch_size;
+    uint32_t connect_batch_minimum;
+    uint32_t connect_batch_maximum;
     uint32_t connect_timeout_seconds;
+    uint32_t connect_stagger_milliseconds;
+    uint32_t outbound_backoff_milliseconds;
+    uint32_t outbound_backoff_maximum_seconds;
+    uint32_t dns_cache_seconds;
+    uint32_t dns_failure_seconds;
     uint32_t channel_handshake_seconds;
     uint32_t channel_germination_seconds;
     uint32_t channel_heartbeat_minutes;
     uint32_t channel_inactivity_minutes;
     uint32_t channel_expiration_minutes;
+    uint32_t timer_wheel_milliseconds;
+    uint32_t channel_pending_messages;
+    uint32_t channel_pending_bytes;
+    uint32_t read_kilobytes_per_second;
+    uint32_t write_kilobytes_per_second;
+    uint32_t channel_read_kilobytes_per_second;
+    uint32_t channel_write_kilobytes_per_second;
+    uint32_t announcement_trickle_milliseconds;
+    uint32_t announcement_batch_size;
+    uint32_t buffer_budget_megabytes;
     uint32_t host_pool_capacity;
+    uint32_t host_pool_checkpoint_minutes;
+    bool concurrent_seeding;
+    uint32_t anchor_connections;
+    uint32_t anchor_minimum_minutes;
     boost::filesystem::path hosts_file;
+    boost::filesystem::path anchors_file;
     config::authority self;
+    config::authority::list binds;
     config::authority::list blacklists;
+    std::vector<std::string> blacklist_subnets;
     config::endpoint::list peers;
     config::endpoint::list seeds;
+    dispatch_policy message_dispatch;
+    socket_profile inbound_socket;
+    socket_profile outbound_socket;
+    socket_profile manual_socket;
 
     // [log]
     boost::filesystem::path debug_file;
@@ -70,16 +115,28 @@ public:
     size_t maximum_archive_size;
     size_t maximum_archive_files;
     config::authority statistics_server;
+    uint32_t statistics_interval_seconds;
+    boost::filesystem::path capture_file;
     bool verbose;
 
     /// Helpers.
     size_t minimum_connections() const;
     asio::duration connect_timeout() const;
+    asio::duration connect_stagger() const;
+    asio::duration outbound_backoff() const;
+    asio::duration outbound_backoff_maximum() const;
+    asio::duration dns_cache_expiration() const;
+    asio::duration dns_failure_expiration() const;
     asio::duration channel_handshake() const;
     asio::duration channel_heartbeat() const;
     asio::duration channel_inactivity() const;
     asio::duration channel_expiration() const;
     asio::duration channel_germination() const;
+    asio::duration host_pool_checkpoint() const;
+    asio::duration anchor_minimum() const;
+    asio::duration timer_wheel_resolution() const;
+    asio::duration announcement_trickle() const;
+    asio::duration statistics_interval() const;
 };
 
 } // namespace network
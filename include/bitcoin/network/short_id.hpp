@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SHORT_ID_HPP
+#define LIBBITCOIN_NETWORK_SHORT_ID_HPP
+
+#include <cstdint>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// BIP152 short transaction identifiers, the low 48 bits of SipHash-2-4 of
+/// a transaction hash, keyed by the hash of a block header and a nonce.
+class BCT_API short_id
+{
+public:
+    typedef std::pair<uint64_t, uint64_t> key;
+
+    /// The siphash key of a compact block (its header and nonce).
+    static key to_key(const chain::header& header, uint64_t nonce);
+
+    /// SipHash-2-4 of the hash under the key.
+    static uint64_t siphash(const key& key, const hash_digest& hash);
+
+    /// The short identifier of a transaction hash, as a number.
+    static uint64_t compute(const key& key, const hash_digest& hash);
+
+    /// The wire (little endian, six byte) form of a short identifier.
+    static mini_hash to_mini_hash(uint64_t value);
+
+    /// The number of a wire short identifier.
+    static uint64_t to_number(const mini_hash& value);
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
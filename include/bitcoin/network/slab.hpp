@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SLAB_HPP
+#define LIBBITCOIN_NETWORK_SLAB_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Recycled blocks for the objects and handlers created per connection or
+/// per message, such as channels, protocols and their completion handlers.
+/// Sizes are rounded up to a size class and each class keeps a free list of
+/// blocks carved from larger slabs, so churn does not reach the heap. Slabs
+/// are retained for the life of the process. Larger blocks use the heap.
+/// This class is thread safe.
+class BCT_API slab
+  : noncopyable
+{
+public:
+    /// Block sizes are multiples of this.
+    static const size_t granularity = 64;
+
+    /// Blocks of up to this size are recycled.
+    static const size_t maximum = 4096;
+
+    /// The slab shared by all instances of slab_allocator.
+    static slab& shared();
+
+    slab();
+    ~slab();
+
+    /// Obtain a block of at least the size.
+    void* allocate(size_t size);
+
+    /// Release a block obtained from allocate of the same size.
+    void deallocate(void* block, size_t size);
+
+private:
+    static const size_t classes = maximum / granularity;
+
+    struct size_class
+    {
+        std::vector<void*> free;
+        std::vector<uint8_t*> slabs;
+        mutable shared_mutex mutex;
+    };
+
+    static size_t to_class(size_t size);
+    void grow(size_class& sizes, size_t block_size);
+
+    std::array<size_class, classes> classes_;
+};
+
+/// A standard allocator over the shared slab, for allocate_shared and asio.
+template <typename Type>
+class slab_allocator
+{
+public:
+    typedef Type value_type;
+
+    slab_allocator() noexcept
+    {
+    }
+
+    template <typename Other>
+    slab_allocator(const slab_allocator<Other>&) noexcept
+    {
+    }
+
+    Type* allocate(size_t count) const
+    {
+        return static_cast<Type*>(
+            slab::shared().allocate(sizeof(Type) * count));
+    }
+
+    void deallocate(Type* pointer, size_t count) const
+    {
+        slab::shared().deallocate(pointer, sizeof(Type) * count);
+    }
+
+    template <typename Other>
+    bool operator==(const slab_allocator<Other>&) const
+    {
+        return true;
+    }
+
+    template <typename Other>
+    bool operator!=(const slab_allocator<Other>&) const
+    {
+        return false;
+    }
+};
+
+/// Create a shared object (and its control block) in the shared slab.
+template <typename Type, typename... Args>
+std::shared_ptr<Type> make_pooled(Args&&... args)
+{
+    return std::allocate_shared<Type>(slab_allocator<Type>(),
+        std::forward<Args>(args)...);
+}
+
+/// A handler with the slab as its associated allocator, for operations that
+/// may overlap (and so cannot share one handler_memory).
+template <typename Handler>
+class slab_handler
+{
+public:
+    typedef slab_allocator<Handler> allocator_type;
+
+    explicit slab_handler(Handler handler)
+      : handler_(std::move(handler))
+    {
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type();
+    }
+
+    template <typename... Args>
+    void operator()(Args&&... args)
+    {
+        handler_(std::forward<Args>(args)...);
+    }
+
+private:
+    Handler handler_;
+};
+
+/// Associate the shared slab with the handler.
+template <typename Handler>
+slab_handler<typename std::decay<Handler>::type> make_slab_handler(
+    Handler&& handler)
+{
+    return slab_handler<typename std::decay<Handler>::type>(
+        std::forward<Handler>(handler));
+}
+
+/// Invoke the handler with success once count completions have occurred,
+/// ignoring their codes, or at once for a count of zero. The state is held
+/// in the slab and is small enough for the returned function to hold.
+template <typename Handler>
+std::function<void(const code&)> make_join(Handler&& handler, size_t count)
+{
+    typedef typename std::decay<Handler>::type handler_type;
+
+    struct join
+    {
+        join(handler_type&& complete, size_t count)
+          : handler(std::move(complete)), remaining(count)
+        {
+        }
+
+        handler_type handler;
+        std::atomic<size_t> remaining;
+    };
+
+    if (count == 0)
+    {
+        handler(error::success);
+        return [](const code&){};
+    }
+
+    const auto state = make_pooled<join>(handler_type(
+        std::forward<Handler>(handler)), count);
+
+    return [state](const code&)
+    {
+        if (--state->remaining == 0)
+            state->handler(error::success);
+    };
+}
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SOCKET_PROFILE_HPP
+#define LIBBITCOIN_NETWORK_SOCKET_PROFILE_HPP
+
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The tcp options applied to the sockets of a session. Buffer sizes are set
+/// before the connection is established, so that the receive window scale is
+/// negotiated for the configured size. A zero size retains the system default.
+/// This class is not thread safe.
+class BCT_API socket_profile
+{
+public:
+    /// Construct the default profile (no_delay only).
+    socket_profile();
+
+    /// Apply the options to an open socket, before connect or once accepted.
+    /// Options are independent, the first failure is returned.
+    code apply(asio::socket& socket) const;
+
+    /// Apply the buffer sizes to an open listener, before listen, so that
+    /// they are inherited by the accepted sockets.
+    /// Options are independent, the first failure is returned.
+    code apply(asio::acceptor& acceptor) const;
+
+    bool no_delay;
+    bool keep_alive;
+    uint32_t send_buffer_bytes;
+    uint32_t receive_buffer_bytes;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_STATSD_HPP
+#define LIBBITCOIN_NETWORK_STATSD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Pushes gauges to a statsd server over UDP at a fixed interval.
+/// Values are cumulative where the source is a counter, so that rates are
+/// derived by the server and a lost datagram loses no information.
+/// This class is thread safe.
+class BCT_API statsd
+  : public enable_shared_from_base<statsd>, noncopyable
+{
+public:
+    typedef std::shared_ptr<statsd> ptr;
+    typedef std::pair<std::string, uint64_t> gauge;
+    typedef std::vector<gauge> gauges;
+    typedef std::function<gauges()> collector;
+
+    /// Datagrams are limited to this size to avoid fragmentation.
+    static const size_t maximum_datagram = 1432;
+
+    /// Format gauges as statsd lines ("prefix.name:value|g"), packed into
+    /// datagrams of no more than the given size (a longer line is alone).
+    static std::vector<std::string> format(const std::string& prefix,
+        const gauges& values, size_t datagram_size=maximum_datagram);
+
+    /// Construct an instance.
+    statsd(threadpool& pool, const config::authority& server,
+        const asio::duration& interval, const std::string& prefix);
+
+    /// Start reporting the collected gauges, returns false if failed.
+    bool start(collector collect);
+
+    /// Stop reporting, idempotent.
+    void stop();
+
+private:
+    typedef std::shared_ptr<std::string> datagram_ptr;
+
+    void start_timer();
+    void handle_timer(const code& ec);
+    void handle_send(const boost_code& ec, size_t bytes,
+        datagram_ptr datagram);
+
+    // These are thread safe.
+    threadpool& pool_;
+    const asio::duration interval_;
+    const std::string prefix_;
+    const boost::asio::ip::udp::endpoint endpoint_;
+    bc::atomic<deadline::ptr> timer_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    collector collect_;
+    boost::asio::ip::udp::socket socket_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
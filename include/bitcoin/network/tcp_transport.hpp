@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TCP_TRANSPORT_HPP
+#define LIBBITCOIN_NETWORK_TCP_TRANSPORT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/handler_memory.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A transport over a connected tcp socket, thread safe.
+/// The operations of the (one pending) read and write recycle their memory.
+class BCT_API tcp_transport
+  : public transport
+{
+public:
+    /// Construct an instance.
+    tcp_transport(socket::ptr socket);
+
+    config::authority authority() const override;
+    void read(const boost::asio::mutable_buffer& buffer, size_t required,
+        strand& strand, io_handler handler) override;
+    void write(const const_buffers& buffers, strand& strand,
+        io_handler handler) override;
+    void stop() override;
+
+private:
+    const socket::ptr socket_;
+
+    // These are protected by the serialization of reads and of writes.
+    handler_memory read_memory_;
+    handler_memory write_memory_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
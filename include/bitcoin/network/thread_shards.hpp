@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_THREAD_SHARDS_HPP
+#define LIBBITCOIN_NETWORK_THREAD_SHARDS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A set of single threaded pools (io contexts) to which channels are pinned.
+/// A channel's socket, timers, subscribers and dispatcher share one shard,
+/// so its handlers execute on one thread. Without shards the fallback pool
+/// is selected. This class is thread safe.
+class BCT_API thread_shards
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<thread_shards> ptr;
+
+    /// Construct an instance that selects fallback until spawned.
+    thread_shards(threadpool& fallback);
+
+    /// Start one thread on each of count shards, created upon first spawn.
+    void spawn(size_t count, thread_priority priority);
+
+    /// Select a shard for a new channel (round robin), or the fallback.
+    threadpool& next();
+
+    /// The number of shards, zero if not spawned.
+    size_t size() const;
+
+    /// Signal all shards to stop accepting work.
+    void shutdown();
+
+    /// Block on join of all shard threads.
+    void join();
+
+private:
+    typedef std::vector<std::shared_ptr<threadpool>> pools;
+
+    threadpool& fallback_;
+    std::atomic<size_t> next_;
+
+    // This is protected by the mutex.
+    pools shards_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
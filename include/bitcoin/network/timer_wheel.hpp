@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TIMER_WHEEL_HPP
+#define LIBBITCOIN_NETWORK_TIMER_WHEEL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A hierarchical timing wheel, shared by the timers of all channels.
+/// A single deadline advances the wheel each tick (resolution), so timers
+/// cost no asio timer operations. Touching a timer only moves its expiry
+/// timestamp, the timer is rescheduled lazily when its slot is reached.
+/// This class is thread safe.
+class BCT_API timer_wheel
+  : public enable_shared_from_base<timer_wheel>, noncopyable
+{
+private:
+    struct entry;
+
+public:
+    typedef std::shared_ptr<timer_wheel> ptr;
+    typedef std::shared_ptr<entry> timer_ptr;
+    typedef std::function<void(const code&)> result_handler;
+
+    /// Construct a wheel of the given tick resolution (rounded up to 1ms).
+    timer_wheel(threadpool& pool, const asio::duration& resolution);
+
+    /// Start advancing the wheel.
+    void start();
+
+    /// Stop advancing the wheel and drop all timers (handlers not invoked).
+    void stop();
+
+    /// Schedule the handler, invoked with success at period from now.
+    /// The handler is posted to the threadpool, never invoked in this call.
+    timer_ptr schedule(const asio::duration& period, result_handler handler);
+
+    /// Move the expiry of the timer to its period from now.
+    void touch(timer_ptr timer) const;
+
+    /// Cancel the timer, its handler is dropped and not invoked.
+    void cancel(timer_ptr timer);
+
+    /// The number of scheduled timers.
+    size_t size() const;
+
+private:
+    typedef std::chrono::steady_clock clock;
+    typedef std::vector<timer_ptr> slot;
+
+    struct entry
+    {
+        uint64_t period;
+        std::atomic<uint64_t> expiry;
+        result_handler handler;
+    };
+
+    uint64_t to_ticks(const asio::duration& period) const;
+    uint64_t elapsed() const;
+    void start_tick();
+    void handle_tick(const code& ec);
+
+    // These are not thread safe.
+    void insert(timer_ptr timer);
+    void cascade(size_t level);
+    void expire(std::vector<result_handler>& expired);
+
+    // These are thread safe.
+    threadpool& pool_;
+    const uint64_t resolution_;
+    const clock::time_point epoch_;
+    bc::atomic<deadline::ptr> ticker_;
+
+    // These are protected by the mutex.
+    bool stopped_;
+    size_t size_;
+    uint64_t current_;
+    std::vector<std::vector<slot>> levels_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TOKEN_BUCKET_HPP
+#define LIBBITCOIN_NETWORK_TOKEN_BUCKET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// A rate limiter that refills at rate tokens per second up to capacity.
+/// A bucket starts full, so capacity is the permitted burst.
+/// The balance is held as the time at which the bucket is again full, in one
+/// atomic, so that a bucket shared by all channels is taken without a lock.
+/// This class is thread safe.
+class BCT_API token_bucket
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<token_bucket> ptr;
+    typedef std::chrono::steady_clock clock;
+
+    /// Construct a bucket, a zero rate is unlimited.
+    token_bucket(double rate, double capacity);
+
+    /// Take tokens if available, returns false if refused.
+    bool try_consume(double tokens=1);
+
+    /// Take tokens unconditionally, which may overdraw the bucket, and
+    /// return the time until the balance is restored (zero if not overdrawn).
+    /// This paces transfers that exceed the capacity (e.g. a large block).
+    asio::duration defer(double tokens);
+
+    /// True if refilled to capacity (or unlimited).
+    bool full() const;
+
+    /// The number of tokens now available.
+    double available() const;
+
+    /// The configured refill rate, zero is unlimited.
+    double rate() const;
+
+    /// The configured capacity.
+    double capacity() const;
+
+private:
+    clock::rep to_ticks(double tokens) const;
+    clock::rep consume(double tokens, bool overdraw);
+
+    // These are thread safe.
+    const double rate_;
+    const double capacity_;
+    const clock::rep burst_;
+    std::atomic<clock::rep> full_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
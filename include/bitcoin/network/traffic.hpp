@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TRAFFIC_HPP
+#define LIBBITCOIN_NETWORK_TRAFFIC_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Counts of messages and bytes by command, read and write timing and send
+/// queue depth. Counters are relaxed atomics. A channel accumulates a tally
+/// and adds it in one step per read or write, not per message.
+/// This class is thread safe.
+class BCT_API traffic
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<traffic> ptr;
+
+    /// The number of counted commands, including the unknown command.
+    static constexpr size_t command_count = 28;
+
+    struct totals
+    {
+        uint64_t messages_in;
+        uint64_t bytes_in;
+        uint64_t messages_out;
+        uint64_t bytes_out;
+    };
+
+    struct command_totals
+    {
+        std::string command;
+        totals counts;
+    };
+
+    struct snapshot
+    {
+        totals total;
+
+        /// Commands with traffic, an unrecognized command is "unknown".
+        std::vector<command_totals> commands;
+
+        /// The number of reads and microseconds spent processing them.
+        uint64_t reads;
+        uint64_t read_microseconds;
+
+        /// The number of messages written and microseconds queued to write.
+        uint64_t writes;
+        uint64_t write_microseconds;
+
+        /// The number of messages queued or being written.
+        uint64_t queued;
+    };
+
+    /// Counts accumulated by a channel and then added to traffic counters.
+    /// This class is not thread safe.
+    class BCT_API tally
+    {
+    public:
+        /// Construct zeroed counts.
+        tally();
+
+        /// Count a received message of the command index (see to_index).
+        void received(size_t index, size_t bytes);
+
+        /// Count a written message of the command index (see to_index).
+        void sent(size_t index, size_t bytes, const asio::duration& elapsed);
+
+        /// Count the processing of a read.
+        void read(const asio::duration& elapsed);
+
+        /// Messages added to or removed from a send queue.
+        void enqueued(size_t count);
+        void dequeued(size_t count);
+
+        /// True if there is nothing to add.
+        bool empty() const;
+
+        /// Zero the counts.
+        void clear();
+
+    private:
+        friend class traffic;
+
+        std::array<totals, command_count> commands_;
+        uint64_t reads_;
+        uint64_t read_microseconds_;
+        uint64_t writes_;
+        uint64_t write_microseconds_;
+        uint64_t enqueued_;
+        uint64_t dequeued_;
+        bool empty_;
+    };
+
+    /// The counter index of the command, the last index if unrecognized.
+    static size_t to_index(const std::string& command);
+
+    /// Construct zeroed counters.
+    traffic();
+
+    /// Add the tally to the counters (the tally is not cleared).
+    void add(const tally& counts);
+
+    /// Count a received message (heading and payload bytes).
+    void received(const std::string& command, size_t bytes);
+
+    /// Count a written message (heading and payload bytes), with the time
+    /// from its send to its write completion.
+    void sent(const std::string& command, size_t bytes,
+        const asio::duration& elapsed);
+
+    /// Count the processing of a read.
+    void read(const asio::duration& elapsed);
+
+    /// Messages added to or removed from a send queue.
+    void enqueued(size_t count);
+    void dequeued(size_t count);
+
+    /// Read all counters (not an atomic snapshot across counters).
+    snapshot collect() const;
+
+private:
+    struct counters
+    {
+        std::atomic<uint64_t> messages_in;
+        std::atomic<uint64_t> bytes_in;
+        std::atomic<uint64_t> messages_out;
+        std::atomic<uint64_t> bytes_out;
+    };
+
+    static uint64_t to_microseconds(const asio::duration& elapsed);
+
+    std::array<counters, command_count> commands_;
+    std::atomic<uint64_t> reads_;
+    std::atomic<uint64_t> read_microseconds_;
+    std::atomic<uint64_t> writes_;
+    std::atomic<uint64_t> write_microseconds_;
+    std::atomic<uint64_t> queued_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TRANSPORT_HPP
+#define LIBBITCOIN_NETWORK_TRANSPORT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The byte stream beneath a proxy, a socket or an in-memory peer.
+/// Completions are invoked on the given strand, so that the reads and writes
+/// of a proxy remain serialized without an additional hop.
+/// Implementations must be thread safe.
+class BCT_API transport
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<transport> ptr;
+    typedef boost::asio::io_context::strand strand;
+    typedef std::vector<boost::asio::const_buffer> const_buffers;
+    typedef std::function<void(const boost_code&, size_t)> io_handler;
+
+    virtual ~transport() {}
+
+    /// Get the authority of the far end of this transport.
+    virtual config::authority authority() const = 0;
+
+    /// Read at least required bytes into the buffer, at most its size.
+    virtual void read(const boost::asio::mutable_buffer& buffer,
+        size_t required, strand& strand, io_handler handler) = 0;
+
+    /// Write all of the buffers, which must remain valid until completion.
+    virtual void write(const const_buffers& buffers, strand& strand,
+        io_handler handler) = 0;
+
+    /// Cancel pending operations and close the transport.
+    virtual void stop() = 0;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
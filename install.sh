@@ -33,8 +33,8 @@ BUILD_DIR="build-libbitcoin-network"
 
 # Boost archive.
 #------------------------------------------------------------------------------
-BOOST_URL="http://downloads.sourceforge.net/project/boost/boost/1.62.0/boost_1_62_0.tar.bz2"
-BOOST_ARCHIVE="boost_1_62_0.tar.bz2"
+BOOST_URL="http://downloads.sourceforge.net/project/boost/boost/1.66.0/boost_1_66_0.tar.bz2"
+BOOST_ARCHIVE="boost_1_66_0.tar.bz2"
 
 
 # Define utility functions.
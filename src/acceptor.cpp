@@ -26,6 +26,7 @@
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -35,11 +36,24 @@ namespace network {
 using namespace std::placeholders;
 
 static const auto reuse_address = asio::acceptor::reuse_address(true);
+static const auto v6_only = boost::asio::ip::v6_only(true);
+
+#ifdef SO_REUSEPORT
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>
+    reuse_port;
+#endif
 
 acceptor::acceptor(threadpool& pool, const settings& settings)
+  : acceptor(pool, settings, nullptr)
+{
+}
+
+acceptor::acceptor(threadpool& pool, const settings& settings,
+    thread_shards::ptr shards)
   : stopped_(true),
     pool_(pool),
     settings_(settings),
+    shards_(shards),
     dispatch_(pool, NAME),
     acceptor_(pool_.service()),
     CONSTRUCT_TRACK(acceptor)
@@ -65,6 +79,9 @@ void acceptor::stop(const code&)
         // This will asynchronously invoke the handler of the pending accept.
         acceptor_.cancel();
 
+        // Release the admission handler, which may retain its session.
+        admit_ = nullptr;
+
         stopped_ = true;
         //---------------------------------------------------------------------
         mutex_.unlock();
@@ -81,8 +98,24 @@ bool acceptor::stopped() const
     return stopped_;
 }
 
-// This is hardwired to listen on IPv6.
-code acceptor::listen(uint16_t )
+// static
+bool acceptor::shareable()
+{
+#ifdef SO_REUSEPORT
+    return true;
+#else
+    return false;
+#endif
+}
+
+// This listens on IPv6, which also accepts IPv4 where dual stack.
+code acceptor::listen(uint16_t port)
+{
+    return listen(asio::endpoint(asio::tcp::v6(), port), false, false);
+}
+
+code acceptor::listen(const asio::endpoint& endpoint, bool shared,
+    bool ipv6_only)
 {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
@@ -96,7 +129,6 @@ code acceptor::listen(uint16_t )
     }
 
     boost_code error;
-    asio::endpoint endpoint(asio::tcp::v6(), settings_.inbound_port);
 
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -105,6 +137,31 @@ code acceptor::listen(uint16_t )
     if (!error)
         acceptor_.set_option(reuse_address, error);
 
+    // An ipv6 listener does not then also claim the port for ipv4.
+    if (!error && ipv6_only && endpoint.address().is_v6())
+        acceptor_.set_option(v6_only, error);
+
+#ifdef SO_REUSEPORT
+    if (!error && shared)
+        acceptor_.set_option(reuse_port(true), error);
+#else
+    if (!error && shared)
+        error = boost::asio::error::operation_not_supported;
+#endif
+
+    // Accepted sockets inherit the buffer sizes, which must precede listen.
+    if (!error)
+    {
+        const auto ec = profile_.apply(acceptor_);
+
+        if (ec)
+        {
+            LOG_DEBUG(LOG_NETWORK)
+                << "Socket buffer sizes not applied to listener ["
+                << endpoint << "] " << ec.message();
+        }
+    }
+
     if (!error)
         acceptor_.bind(endpoint, error);
 
@@ -133,7 +190,9 @@ void acceptor::accept(accept_handler handler)
         return;
     }
 
-    const auto socket = std::make_shared<bc::socket>(pool_);
+    // The socket and its channel share the selected pool.
+    auto& pool = shards_ ? shards_->next() : pool_;
+    const auto socket = make_pooled<bc::socket>(pool);
 
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -143,16 +202,46 @@ void acceptor::accept(accept_handler handler)
     // TODO: if the accept is invoked on a thread of the acceptor, as opposed
     // to the thread of the socket, then this is unnecessary.
     acceptor_.async_accept(socket->get(),
-        std::bind(&acceptor::handle_accept,
-            shared_from_this(), _1, socket, handler));
+        make_slab_handler(std::bind(&acceptor::handle_accept,
+            shared_from_this(), _1, std::ref(pool), socket, handler)));
 
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
+void acceptor::set_admission(admission_handler admit)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    admit_ = admit;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void acceptor::set_socket_profile(const socket_profile& profile)
+{
+    profile_ = profile;
+}
+
+// private:
+code acceptor::admit(const config::authority& authority) const
+{
+    admission_handler admit;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock_shared();
+    admit = admit_;
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return admit ? admit(authority) : error::success;
+}
+
 // private:
-void acceptor::handle_accept(const boost_code& ec, socket::ptr socket,
-    accept_handler handler)
+void acceptor::handle_accept(const boost_code& ec, threadpool& pool,
+    socket::ptr socket, accept_handler handler)
 {
     if (ec)
     {
@@ -160,8 +249,34 @@ void acceptor::handle_accept(const boost_code& ec, socket::ptr socket,
         return;
     }
 
+    // Admission precedes channel construction, so that a rejected socket
+    // costs no buffers, timers or subscribers.
+    const auto authority = socket->authority();
+    const auto rejected = admit(authority);
+
+    if (rejected)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Rejected inbound connection from [" << authority << "] "
+            << rejected.message();
+        socket->stop();
+        accept(handler);
+        return;
+    }
+
+    const auto applied = profile_.apply(socket->get());
+
+    // A socket option failure does not preclude the connection.
+    if (applied)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Socket options not applied to [" << authority << "] "
+            << applied.message();
+    }
+
     // Ensure that channel is not passed as an r-value.
-    const auto created = std::make_shared<channel>(pool_, socket, settings_);
+    const auto created = make_pooled<channel>(pool, socket, settings_);
+    created->trace().record(handshake_trace::stage::connected);
     handler(error::success, created);
 }
 
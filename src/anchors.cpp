@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/anchors.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::message;
+
+// The file begins with this magic and format version.
+static const uint32_t anchors_magic = 0x72636e61;
+static const uint32_t anchors_version = 1;
+static const size_t anchors_header_size = 2 * sizeof(uint32_t);
+static const auto record_version = version::level::maximum;
+
+// static
+code anchors::load(const boost::filesystem::path& file,
+    config::authority::list& out)
+{
+    out.clear();
+
+    if (file.empty())
+        return error::success;
+
+    data_chunk data;
+
+    {
+        bc::ifstream stream(file.string(), std::ios::in | std::ios::binary);
+
+        // There is no file after a first run or a crash.
+        if (!stream)
+            return error::success;
+
+        data.assign(std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>());
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(file, ec);
+
+    if (ec)
+        return error::file_system;
+
+    auto source = make_safe_deserializer(data.begin(), data.end());
+
+    if (data.size() < anchors_header_size ||
+        source.read_4_bytes_little_endian() != anchors_magic ||
+        source.read_4_bytes_little_endian() != anchors_version)
+        return error::bad_stream;
+
+    while (!source.is_exhausted())
+    {
+        network_address address;
+
+        if (!address.from_data(record_version, source, true))
+            break;
+
+        out.push_back(address);
+    }
+
+    return error::success;
+}
+
+// static
+// The file is replaced by rename, so a failure does not lose prior content.
+code anchors::save(const boost::filesystem::path& file,
+    const config::authority::list& anchors)
+{
+    if (file.empty())
+        return error::success;
+
+    boost::system::error_code ec;
+
+    if (anchors.empty())
+    {
+        boost::filesystem::remove(file, ec);
+        return ec ? error::file_system : error::success;
+    }
+
+    const auto record_size = network_address::satoshi_fixed_size(
+        record_version, true);
+
+    data_chunk data(anchors_header_size + anchors.size() * record_size);
+    auto sink = make_unsafe_serializer(data.begin());
+    sink.write_4_bytes_little_endian(anchors_magic);
+    sink.write_4_bytes_little_endian(anchors_version);
+
+    for (const auto& anchor: anchors)
+        anchor.to_network_address().to_data(record_version, sink, true);
+
+    const auto temporary = file.string() + ".tmp";
+
+    {
+        bc::ofstream stream(temporary, std::ios::out | std::ios::binary);
+
+        if (stream.bad())
+            return error::file_system;
+
+        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        if (!stream.good())
+            return error::file_system;
+    }
+
+    boost::filesystem::rename(temporary, file, ec);
+    return ec ? error::file_system : error::success;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/announcement_queue.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+announcement_queue::announcement_queue(size_t threshold)
+  : threshold_(threshold)
+{
+}
+
+announcement_queue::action announcement_queue::push(
+    const message::inventory_vector::list& items)
+{
+    if (items.empty())
+        return action::none;
+
+    const auto block = std::any_of(items.begin(), items.end(),
+        [](const message::inventory_vector& item)
+        {
+            return item.is_block_type();
+        });
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto empty = pending_.empty();
+    pending_.insert(pending_.end(), items.begin(), items.end());
+
+    if (block || pending_.size() >= threshold_)
+        return action::flush;
+
+    return empty ? action::schedule : action::none;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+message::inventory_vector::list announcement_queue::pop()
+{
+    message::inventory_vector::list out;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    out.swap(pending_);
+    return out;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t announcement_queue::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return pending_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,270 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/blacklist.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::config;
+
+static const uint8_t ipv4_mapped_bits = 96;
+
+const uint8_t blacklist::address_bits = 128;
+
+blacklist::blacklist()
+  : subnets_(0)
+{
+    // The root node is terminal only if a zero length prefix is added.
+    nodes_.push_back({ { 0, 0 }, false });
+}
+
+blacklist::blacklist(const authority::list& addresses,
+    const subnets& subnets)
+  : blacklist()
+{
+    for (const auto& address: addresses)
+        do_add(address.ip(), address_bits);
+
+    message::ip_address ip;
+    uint8_t prefix;
+
+    for (const auto& subnet: subnets)
+        if (parse(subnet, ip, prefix))
+            do_add(ip, prefix);
+}
+
+// static
+bool blacklist::parse(const std::string& subnet, message::ip_address& ip,
+    uint8_t& prefix)
+{
+    using namespace boost::asio::ip;
+    const auto separator = subnet.find('/');
+    const auto host = subnet.substr(0, separator);
+
+    boost_code ec;
+    const auto address = make_address(host, ec);
+
+    if (ec)
+        return false;
+
+    const auto v4 = address.is_v4();
+    const auto limit = v4 ? address_bits - ipv4_mapped_bits : address_bits;
+    size_t bits = limit;
+
+    if (separator != std::string::npos)
+    {
+        const auto digits = subnet.substr(separator + 1);
+
+        const auto is_digit = [](char value)
+        {
+            return value >= '0' && value <= '9';
+        };
+
+        if (digits.empty() || digits.size() > 3 ||
+            !std::all_of(digits.begin(), digits.end(), is_digit))
+            return false;
+
+        bits = std::stoul(digits);
+
+        if (bits > limit)
+            return false;
+    }
+
+    const auto v6 = v4 ?
+        make_address_v6(v4_mapped, address.to_v4()) : address.to_v6();
+
+    const auto bytes = v6.to_bytes();
+    std::copy(bytes.begin(), bytes.end(), ip.begin());
+    prefix = static_cast<uint8_t>(v4 ? bits + ipv4_mapped_bits : bits);
+    return true;
+}
+
+size_t blacklist::address_hash::operator()(
+    const message::ip_address& value) const
+{
+    return boost::hash_range(value.begin(), value.end());
+}
+
+// private
+bool blacklist::bit(const message::ip_address& ip, uint8_t index)
+{
+    return ((ip[index / 8] >> (7 - (index % 8))) & 1) != 0;
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+size_t blacklist::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return addresses_.size() + subnets_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool blacklist::contains(const authority& authority) const
+{
+    return contains(authority.ip());
+}
+
+// Walk the trie at most one step per bit, stopping at the first subnet.
+bool blacklist::contains(const message::ip_address& ip) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    if (addresses_.find(ip) != addresses_.end())
+        return true;
+
+    node_index index = 0;
+
+    for (uint8_t depth = 0; depth < address_bits; ++depth)
+    {
+        if (nodes_[index].terminal)
+            return true;
+
+        index = nodes_[index].children[bit(ip, depth) ? 1 : 0];
+
+        // The root is never a child, so zero terminates the walk.
+        if (index == 0)
+            return false;
+    }
+
+    return nodes_[index].terminal;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Methods.
+// ----------------------------------------------------------------------------
+
+void blacklist::add(const message::ip_address& ip, uint8_t prefix)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    do_add(ip, prefix);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool blacklist::add(const std::string& subnet)
+{
+    message::ip_address ip;
+    uint8_t prefix;
+
+    if (!parse(subnet, ip, prefix))
+        return false;
+
+    add(ip, prefix);
+    return true;
+}
+
+void blacklist::remove(const message::ip_address& ip, uint8_t prefix)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    do_remove(ip, prefix);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool blacklist::remove(const std::string& subnet)
+{
+    message::ip_address ip;
+    uint8_t prefix;
+
+    if (!parse(subnet, ip, prefix))
+        return false;
+
+    remove(ip, prefix);
+    return true;
+}
+
+// private
+void blacklist::do_add(const message::ip_address& ip, uint8_t prefix)
+{
+    if (prefix >= address_bits)
+    {
+        addresses_.insert(ip);
+        return;
+    }
+
+    node_index index = 0;
+
+    for (uint8_t depth = 0; depth < prefix; ++depth)
+    {
+        const auto side = bit(ip, depth) ? 1 : 0;
+
+        if (nodes_[index].children[side] == 0)
+        {
+            const auto child = static_cast<node_index>(nodes_.size());
+            nodes_[index].children[side] = child;
+            nodes_.push_back({ { 0, 0 }, false });
+        }
+
+        index = nodes_[index].children[side];
+    }
+
+    if (!nodes_[index].terminal)
+    {
+        nodes_[index].terminal = true;
+        ++subnets_;
+    }
+}
+
+// private
+// Emptied branches are retained, they are reused if the subnet is re-added.
+void blacklist::do_remove(const message::ip_address& ip, uint8_t prefix)
+{
+    if (prefix >= address_bits)
+    {
+        addresses_.erase(ip);
+        return;
+    }
+
+    node_index index = 0;
+
+    for (uint8_t depth = 0; depth < prefix; ++depth)
+    {
+        index = nodes_[index].children[bit(ip, depth) ? 1 : 0];
+
+        if (index == 0)
+            return;
+    }
+
+    if (nodes_[index].terminal)
+    {
+        nodes_[index].terminal = false;
+        --subnets_;
+    }
+}
+
+} // namespace network
+} // namespace libbitcoin
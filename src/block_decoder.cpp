@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/block_decoder.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::chain;
+
+block_decoder::block_decoder()
+  : stage_(stage::idle),
+    version_(0),
+    size_(0),
+    offset_(0),
+    retry_(0),
+    count_(0)
+{
+}
+
+void block_decoder::start(uint32_t version, size_t payload_size)
+{
+    reset();
+    stage_ = stage::header;
+    version_ = version;
+    size_ = payload_size;
+}
+
+bool block_decoder::active() const
+{
+    return stage_ != stage::idle;
+}
+
+size_t block_decoder::decoded() const
+{
+    return offset_;
+}
+
+void block_decoder::reset()
+{
+    stage_ = stage::idle;
+    size_ = 0;
+    offset_ = 0;
+    retry_ = 0;
+    count_ = 0;
+    header_ = {};
+    transactions_.clear();
+}
+
+// A failed attempt (an incomplete element) is retried once the undecoded
+// data available has doubled, which bounds the cost of retries for a large
+// transaction to a multiple of its size. The full payload is always tried.
+void block_decoder::decode(const uint8_t* payload, size_t available)
+{
+    available = std::min(available, size_);
+
+    if (available < retry_)
+        return;
+
+    while (stage_ != stage::idle && stage_ != stage::failed &&
+        decode_next(payload, available));
+
+    if (stage_ != stage::failed)
+        retry_ = std::min(offset_ + 2 * (available - offset_), size_);
+}
+
+// private
+// Returns true if an element was decoded and another may follow.
+bool block_decoder::decode_next(const uint8_t* payload, size_t available)
+{
+    const auto begin = payload + offset_;
+    const auto end = payload + available;
+
+    if (begin >= end)
+        return false;
+
+    auto source = make_safe_deserializer(begin, end);
+
+    switch (stage_)
+    {
+        case stage::header:
+        {
+            if (!header_.from_data(source))
+                return false;
+
+            offset_ += header::satoshi_fixed_size();
+            stage_ = stage::count;
+            return true;
+        }
+
+        case stage::count:
+        {
+            const auto count = source.read_size_little_endian();
+
+            if (!source)
+                return false;
+
+            // Each transaction is at least a byte, which bounds allocation.
+            if (count > size_)
+            {
+                stage_ = stage::failed;
+                return false;
+            }
+
+            count_ = static_cast<size_t>(count);
+            transactions_.reserve(count_);
+            offset_ += variable_uint_size(count);
+            stage_ = stage::transactions;
+            return count_ != 0;
+        }
+
+        case stage::transactions:
+        {
+            if (transactions_.size() == count_)
+                return false;
+
+            // The offset advances by the bytes read, which may differ from the
+            // serialized size (e.g. a witness marker with empty witnesses).
+            typedef boost::iostreams::array_source device;
+            boost::iostreams::stream<device> input(
+                reinterpret_cast<const char*>(begin),
+                static_cast<size_t>(end - begin));
+            transaction tx;
+
+            if (!tx.from_data(input, true, true))
+                return false;
+
+            // The buffer position is unaffected by an end of stream state.
+            const auto consumed = input.rdbuf()->pubseekoff(0, std::ios::cur,
+                std::ios::in);
+
+            if (consumed <= 0)
+            {
+                stage_ = stage::failed;
+                return false;
+            }
+
+            offset_ += static_cast<size_t>(consumed);
+            transactions_.push_back(std::move(tx));
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+message::block::ptr block_decoder::complete(const uint8_t* payload)
+{
+    retry_ = 0;
+    decode(payload, size_);
+
+    const auto decoded = stage_ == stage::transactions &&
+        transactions_.size() == count_ && offset_ == size_;
+
+    message::block::ptr block;
+
+    if (decoded)
+    {
+        block = std::make_shared<message::block>(std::move(header_),
+            std::move(transactions_));
+    }
+    else
+    {
+        // Decode in full, as the block is invalid or was not decodable in
+        // parts (such as by a size computation that differs from the wire).
+        block = std::make_shared<message::block>();
+        auto source = make_safe_deserializer(payload, payload + size_);
+
+        if (!block->from_data(version_, source) || !source.is_exhausted())
+            block.reset();
+    }
+
+    reset();
+    return block;
+}
+
+} // namespace network
+} // namespace libbitcoin
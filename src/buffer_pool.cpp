@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/buffer_pool.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+buffer_pool::buffer_pool(size_t count, size_t limit)
+  : count_(count),
+    limit_(limit)
+{
+    buffers_.reserve(count_);
+}
+
+buffer_pool::buffer_ptr buffer_pool::acquire(size_t size)
+{
+    // Pooling oversized buffers would retain their memory indefinitely.
+    if (size > limit_)
+        return std::make_shared<data_chunk>(size);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // A buffer referenced only by the pool is idle, and cannot be referenced
+    // concurrently because references are only obtained under this lock.
+    for (const auto& buffer: buffers_)
+    {
+        if (buffer.use_count() == 1)
+        {
+            // This reallocates only if the buffer has held no larger message.
+            buffer->resize(size);
+            return buffer;
+        }
+    }
+
+    const auto buffer = std::make_shared<data_chunk>();
+
+    // A pooled buffer grows only to the largest message it has held.
+    if (buffers_.size() < count_)
+        buffers_.push_back(buffer);
+
+    buffer->resize(size);
+    return buffer;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -18,15 +18,21 @@
  */
 #include <bitcoin/network/channel.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/pooled_timer.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
+#include <bitcoin/network/tcp_transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -34,19 +40,36 @@ namespace network {
 using namespace bc::message;
 using namespace std::placeholders;
 
-// Factory for deadline timer pointer construction.
-static deadline::ptr alarm(threadpool& pool, const asio::duration& duration)
+channel::channel(threadpool& pool, socket::ptr socket,
+    const settings& settings)
+  : channel(pool, make_pooled<tcp_transport>(socket), settings)
 {
-    return std::make_shared<deadline>(pool, pseudo_random::duration(duration));
 }
 
-channel::channel(threadpool& pool, socket::ptr socket,
+channel::channel(threadpool& pool, transport::ptr transport,
     const settings& settings)
-  : proxy(pool, socket, settings),
+  : proxy(pool, transport, settings),
     notify_(false),
+    outbound_(false),
+    fee_filter_(0),
     nonce_(0),
-    expiration_(alarm(pool, settings.channel_expiration())),
-    inactivity_(alarm(pool, settings.channel_inactivity())),
+    expiration_period_(pseudo_random::duration(
+        settings.channel_expiration())),
+    inactivity_period_(pseudo_random::duration(
+        settings.channel_inactivity())),
+    expiration_(settings.timer_wheel_milliseconds != 0 ? nullptr :
+        make_pooled<pooled_timer>(pool, expiration_period_)),
+    inactivity_(settings.timer_wheel_milliseconds != 0 ? nullptr :
+        make_pooled<pooled_timer>(pool, inactivity_period_)),
+    trickle_period_(settings.announcement_trickle()),
+    trickle_(settings.announcement_trickle_milliseconds == 0 ? nullptr :
+        make_pooled<pooled_timer>(pool, trickle_period_)),
+    announcements_(settings.announcement_batch_size),
+    last_activity_(0),
+    last_round_trip_(0),
+    minimum_round_trip_(0),
+    average_round_trip_(0),
+    round_trips_(0),
     CONSTRUCT_TRACK(channel)
 {
 }
@@ -83,6 +106,31 @@ void channel::set_notify(bool value)
     notify_ = value;
 }
 
+bool channel::outbound() const
+{
+    return outbound_;
+}
+
+void channel::set_outbound(bool value)
+{
+    outbound_ = value;
+}
+
+uint64_t channel::fee_filter() const
+{
+    return fee_filter_;
+}
+
+void channel::set_fee_filter(uint64_t value)
+{
+    fee_filter_ = value;
+}
+
+bool channel::accepts_fee(uint64_t fee_rate) const
+{
+    return fee_rate >= fee_filter_;
+}
+
 uint64_t channel::nonce() const
 {
     return nonce_;
@@ -105,19 +153,170 @@ void channel::set_peer_version(version_const_ptr value)
     peer_version_.store(value);
 }
 
+channel::latency channel::round_trip() const
+{
+    return
+    {
+        asio::duration(last_round_trip_.load()),
+        asio::duration(minimum_round_trip_.load()),
+        asio::duration(average_round_trip_.load()),
+        round_trips_.load()
+    };
+}
+
+// Samples are recorded by the pong handler of one protocol, which is not
+// invoked concurrently with itself, so updates are not concurrent.
+// The average is exponentially weighted, by 1/8 per sample (as tcp srtt).
+void channel::record_round_trip(const asio::duration& value)
+{
+    const auto sample = value.count();
+    const auto minimum = minimum_round_trip_.load();
+    const auto average = average_round_trip_.load();
+    const auto first = round_trips_++ == 0;
+
+    last_round_trip_.store(sample);
+    minimum_round_trip_.store(first ? sample : std::min(minimum, sample));
+    average_round_trip_.store(first ? sample :
+        average + (sample - average) / 8);
+}
+
+handshake_trace& channel::trace()
+{
+    return trace_;
+}
+
+void channel::set_timers(timer_wheel::ptr timers)
+{
+    timers_ = timers;
+}
+
+// Announcement.
+// ----------------------------------------------------------------------------
+
+void channel::announce(const inventory_vector::list& items)
+{
+    if (proxy::stopped())
+        return;
+
+    const auto version = peer_version_.load();
+    auto action = announcement_queue::action::none;
+
+    if (version && !version->relay())
+    {
+        inventory_vector::list blocks;
+        std::copy_if(items.begin(), items.end(), std::back_inserter(blocks),
+            [](const inventory_vector& item)
+            {
+                return !item.is_transaction_type();
+            });
+
+        action = announcements_.push(blocks);
+    }
+    else
+    {
+        action = announcements_.push(items);
+    }
+
+    // A zero trickle interval disables batching by time.
+    if (action == announcement_queue::action::flush ||
+        (action == announcement_queue::action::schedule &&
+            trickle_period_ == asio::duration::zero()))
+    {
+        flush_announcements();
+        return;
+    }
+
+    if (action == announcement_queue::action::schedule)
+        start_trickle();
+}
+
+// The interval is randomized so that announcement timing is not a tell of
+// the origin of a transaction. A zero interval does not schedule the timer.
+void channel::start_trickle()
+{
+    BITCOIN_ASSERT(trickle_);
+    trickle_->start(stranded(
+        std::bind(&channel::handle_trickle,
+            shared_from_base<channel>(), _1)),
+            pseudo_random::duration(trickle_period_));
+}
+
+void channel::handle_trickle(const code& ec)
+{
+    if (stopped(ec))
+        return;
+
+    flush_announcements();
+}
+
+// Each batch is one serialization and one write, chunked at the message limit.
+void channel::flush_announcements()
+{
+    auto items = announcements_.pop();
+
+    if (items.empty())
+        return;
+
+    const auto nop = [](const code&){};
+
+    for (auto it = items.begin(); it != items.end();)
+    {
+        const auto remaining = static_cast<size_t>(
+            std::distance(it, items.end()));
+        const auto end = std::next(it, std::min(remaining, max_inventory));
+        send(inventory(inventory_vector::list(it, end)), nop);
+        it = end;
+    }
+}
+
 // Proxy pure virtual protected and ordered handlers.
 // ----------------------------------------------------------------------------
 
 // It is possible that this may be called multiple times.
 void channel::handle_stopping()
 {
-    expiration_->stop();
-    inactivity_->stop();
+    if (expiration_)
+        expiration_->stop();
+
+    if (inactivity_)
+        inactivity_->stop();
+
+    if (trickle_)
+        trickle_->stop();
+
+    if (!timers_)
+        return;
+
+    const auto expiration = expiration_timer_.load();
+    const auto inactivity = inactivity_timer_.load();
+
+    if (expiration)
+        timers_->cancel(expiration);
+
+    if (inactivity)
+        timers_->cancel(inactivity);
 }
 
+// Activity only records a timestamp (or on the wheel moves the expiry), the
+// inactivity timer is not reset per message.
 void channel::signal_activity()
 {
-    start_inactivity();
+    const auto inactivity = inactivity_timer_.load();
+
+    if (timers_ && inactivity)
+    {
+        timers_->touch(inactivity);
+        return;
+    }
+
+    last_activity_.store(clock::now().time_since_epoch().count());
+}
+
+asio::duration channel::idle() const
+{
+    const clock::duration last(last_activity_.load());
+    return std::chrono::duration_cast<asio::duration>(
+        clock::now().time_since_epoch() - last);
 }
 
 bool channel::stopped(const code& ec) const
@@ -126,7 +325,7 @@ bool channel::stopped(const code& ec) const
         ec == error::service_stopped;
 }
 
-// Timers (these are inherent races, requiring stranding by stop only).
+// Timers (completions are invoked on the strand of the channel).
 // ----------------------------------------------------------------------------
 
 void channel::start_expiration()
@@ -134,9 +333,20 @@ void channel::start_expiration()
     if (proxy::stopped())
         return;
 
-    expiration_->start(
+    if (timers_)
+    {
+        expiration_timer_.store(timers_->schedule(expiration_period_,
+            stranded(std::bind(&channel::handle_expiration,
+                shared_from_base<channel>(), _1))));
+        return;
+    }
+
+    if (!expiration_)
+        return;
+
+    expiration_->start(stranded(
         std::bind(&channel::handle_expiration,
-            shared_from_base<channel>(), _1));
+            shared_from_base<channel>(), _1)));
 }
 
 void channel::handle_expiration(const code& ec)
@@ -155,16 +365,41 @@ void channel::start_inactivity()
     if (proxy::stopped())
         return;
 
-    inactivity_->start(
+    if (timers_)
+    {
+        inactivity_timer_.store(timers_->schedule(inactivity_period_,
+            stranded(std::bind(&channel::handle_inactivity,
+                shared_from_base<channel>(), _1))));
+        return;
+    }
+
+    if (!inactivity_)
+        return;
+
+    last_activity_.store(clock::now().time_since_epoch().count());
+
+    inactivity_->start(stranded(
         std::bind(&channel::handle_inactivity,
-            shared_from_base<channel>(), _1));
+            shared_from_base<channel>(), _1)));
 }
 
+// The deadline is rearmed for the remainder if there has been activity.
 void channel::handle_inactivity(const code& ec)
 {
     if (stopped(ec))
         return;
 
+    const auto elapsed = idle();
+
+    if (inactivity_ && elapsed < inactivity_period_)
+    {
+        inactivity_->start(stranded(
+            std::bind(&channel::handle_inactivity,
+                shared_from_base<channel>(), _1)),
+                inactivity_period_ - elapsed);
+        return;
+    }
+
     LOG_DEBUG(LOG_NETWORK)
         << "Channel inactivity timeout [" << authority() << "]";
 
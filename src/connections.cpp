@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/connections.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::config;
+
+connections::connections(size_t capacity)
+  : stopped_(false)
+{
+    channels_.reserve(capacity);
+    authorities_.reserve(capacity);
+    nonces_.reserve(capacity);
+}
+
+size_t connections::key_hash::operator()(const key& value) const
+{
+    auto seed = boost::hash_range(value.first.begin(), value.first.end());
+    boost::hash_combine(seed, value.second);
+    return seed;
+}
+
+// private
+connections::key connections::to_key(const authority& authority)
+{
+    return std::make_pair(authority.ip(), authority.port());
+}
+
+// private
+template <typename Map, typename Key>
+void connections::decrement(Map& map, const Key& value)
+{
+    const auto it = map.find(value);
+
+    if (it != map.end() && --it->second == 0)
+        map.erase(it);
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+size_t connections::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return channels_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool connections::exists(const authority& authority) const
+{
+    const auto value = to_key(authority);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return authorities_.find(value) != authorities_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool connections::exists(uint64_t nonce) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return nonces_.find(nonce) != nonces_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The snapshot is rebuilt at most once per change, by the first reader.
+connections::snapshot_ptr connections::snapshot() const
+{
+    // Readers share the current snapshot without taking the mutex.
+    const auto current = std::atomic_load(&snapshot_);
+
+    if (current)
+        return current;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // Another reader may have rebuilt it while this one waited.
+    auto rebuilt = std::atomic_load(&snapshot_);
+
+    if (!rebuilt)
+    {
+        const auto channels = std::make_shared<list>();
+        channels->reserve(channels_.size());
+
+        for (const auto& entry: channels_)
+            channels->push_back(entry.first);
+
+        rebuilt = channels;
+        std::atomic_store(&snapshot_, rebuilt);
+    }
+
+    return rebuilt;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Methods.
+// ----------------------------------------------------------------------------
+
+code connections::store(channel::ptr channel, bool unique)
+{
+    // The nonce must be set before the channel is stored.
+    const record entry{ to_key(channel->authority()), channel->nonce() };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    if (unique && authorities_.find(entry.authority) != authorities_.end())
+        return error::address_in_use;
+
+    if (!channels_.emplace(channel, entry).second)
+        return error::success;
+
+    ++authorities_[entry.authority];
+    ++nonces_[entry.nonce];
+    std::atomic_store(&snapshot_, snapshot_ptr());
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void connections::remove(channel::ptr channel)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto it = channels_.find(channel);
+
+    if (it == channels_.end())
+        return;
+
+    // Use the recorded keys, the channel's own values may have changed.
+    decrement(authorities_, it->second.authority);
+    decrement(nonces_, it->second.nonce);
+    channels_.erase(it);
+    std::atomic_store(&snapshot_, snapshot_ptr());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void connections::stop(const code& ec)
+{
+    list channels;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    stopped_ = true;
+    channels.reserve(channels_.size());
+
+    for (const auto& entry: channels_)
+        channels.push_back(entry.first);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Stop outside of the lock, as stop handlers may remove from the registry.
+    for (const auto channel: channels)
+        channel->stop(ec);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -18,15 +18,19 @@
  */
 #include <bitcoin/network/connector.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -37,9 +41,24 @@ using namespace bc::config;
 using namespace std::placeholders;
 
 connector::connector(threadpool& pool, const settings& settings)
+  : connector(pool, settings, nullptr)
+{
+}
+
+connector::connector(threadpool& pool, const settings& settings,
+    dns_cache::ptr cache)
+  : connector(pool, settings, cache, nullptr)
+{
+}
+
+// The shard is selected upon construction, as a connector is used once.
+connector::connector(threadpool& pool, const settings& settings,
+    dns_cache::ptr cache, thread_shards::ptr shards)
   : stopped_(false),
     pool_(pool),
+    channel_pool_(shards ? shards->next() : pool),
     settings_(settings),
+    cache_(cache),
     dispatch_(pool, NAME),
     resolver_(pool.service()),
     CONSTRUCT_TRACK(connector)
@@ -68,6 +87,13 @@ void connector::stop(const code&)
         if (timer_)
             timer_->stop();
 
+        // This cancels a pending connect, so that no channel is created.
+        // The socket is released upon connect, so a channel is not stopped.
+        if (socket_)
+            socket_->stop();
+
+        socket_.reset();
+
         stopped_ = true;
         //---------------------------------------------------------------------
         mutex_.unlock();
@@ -78,6 +104,22 @@ void connector::stop(const code&)
     ///////////////////////////////////////////////////////////////////////////
 }
 
+void connector::set_socket_profile(const socket_profile& profile)
+{
+    profile_ = profile;
+}
+
+void connector::set_claim(claim_handler claim)
+{
+    claim_ = claim;
+}
+
+// protected
+bool connector::claimed() const
+{
+    return !claim_ || claim_();
+}
+
 // private
 bool connector::stopped() const
 {
@@ -89,9 +131,28 @@ void connector::connect(const endpoint& endpoint, connect_handler handler)
     connect(endpoint.host(), endpoint.port(), handler);
 }
 
+// An authority is numeric, so it is connected without resolution.
 void connector::connect(const authority& authority, connect_handler handler)
 {
-    connect(authority.to_hostname(), authority.port(), handler);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (stopped())
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        dispatch_.concurrent(handler, error::service_stopped, nullptr);
+        return;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    started_ = handshake_trace::clock::now();
+    start_connect({ to_endpoint(authority) }, handler);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 void connector::connect(const std::string& hostname, uint16_t port,
@@ -109,48 +170,121 @@ void connector::connect(const std::string& hostname, uint16_t port,
         return;
     }
 
-    query_ = std::make_shared<asio::query>(hostname, std::to_string(port));
-
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+    started_ = handshake_trace::clock::now();
+    boost_code ec;
+    const auto ip = boost::asio::ip::make_address(hostname, ec);
+
+    // A numeric host is connected without name resolution.
+    if (!ec)
+    {
+        start_connect({ asio::endpoint(ip, port) }, handler);
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    endpoints cached;
+
+    // A cached failure is reported without resolution.
+    if (cache_ && cache_->find(hostname, port, cached))
+    {
+        if (cached.empty())
+        {
+            mutex_.unlock();
+            //-----------------------------------------------------------------
+            dispatch_.concurrent(handler, error::resolve_failed, nullptr);
+            return;
+        }
+
+        resolved_ = handshake_trace::clock::now();
+        start_connect(std::move(cached), handler);
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    query_ = std::make_shared<asio::query>(hostname, std::to_string(port));
+
     // async_resolve will not invoke the handler within this function.
     resolver_.async_resolve(*query_,
-        std::bind(&connector::handle_resolve,
-            shared_from_this(), _1, _2, handler));
+        make_slab_handler(std::bind(&connector::handle_resolve,
+            shared_from_this(), _1, _2, hostname, port, handler)));
 
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
 void connector::handle_resolve(const boost_code& ec, asio::iterator iterator,
-    connect_handler handler)
+    const std::string& hostname, uint16_t port, connect_handler handler)
 {
-    using namespace boost::asio;
-
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_shared();
+    mutex_.lock_upgrade();
 
     if (stopped())
     {
-        mutex_.unlock_shared();
+        mutex_.unlock_upgrade();
         //---------------------------------------------------------------------
         dispatch_.concurrent(handler, error::service_stopped, nullptr);
         return;
     }
 
-    if (ec)
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    auto targets = interleave(iterator);
+
+    if (ec || targets.empty())
     {
-        mutex_.unlock_shared();
+        if (cache_)
+            cache_->store_failure(hostname, port);
+
+        mutex_.unlock();
         //---------------------------------------------------------------------
         dispatch_.concurrent(handler, error::resolve_failed, nullptr);
         return;
     }
 
-    const auto socket = std::make_shared<bc::socket>(pool_);
+    if (cache_)
+        cache_->store(hostname, port, targets);
+
+    resolved_ = handshake_trace::clock::now();
+
+    start_connect(std::move(targets), handler);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+// The caller must hold the exclusive lock and there must be a target.
+void connector::start_connect(endpoints&& targets, connect_handler handler)
+{
+    BITCOIN_ASSERT(!targets.empty());
     timer_ = std::make_shared<deadline>(pool_, settings_.connect_timeout());
 
+    // Race attempts when there is more than one endpoint.
+    if (targets.size() > 1)
+    {
+        const auto state = std::make_shared<race>();
+        state->targets = std::move(targets);
+        state->handler = handler;
+
+        // timer.async_wait will not invoke the handler within this function.
+        timer_->start(
+            std::bind(&connector::handle_race_timer,
+                shared_from_this(), _1, state));
+
+        start_attempt(state);
+        return;
+    }
+
+    const auto socket = make_pooled<bc::socket>(channel_pool_);
+    socket_ = socket;
+
     // Manage the timer-connect race, returning upon first completion.
     const auto join_handler = synchronize(handler, 1, NAME,
         synchronizer_terminate::on_error);
@@ -160,19 +294,18 @@ void connector::handle_resolve(const boost_code& ec, asio::iterator iterator,
         std::bind(&connector::handle_timer,
             shared_from_this(), _1, socket, join_handler));
 
+    prepare(socket, targets.front());
+
     // async_connect will not invoke the handler within this function.
     // The bound delegate ensures handler completion before loss of scope.
-    async_connect(socket->get(), iterator,
-        std::bind(&connector::handle_connect,
-            shared_from_this(), _1, _2, socket, join_handler));
-
-    mutex_.unlock_shared();
-    ///////////////////////////////////////////////////////////////////////////
+    socket->get().async_connect(targets.front(),
+        make_slab_handler(std::bind(&connector::handle_connect,
+            shared_from_this(), _1, socket, join_handler)));
 }
 
 // private:
-void connector::handle_connect(const boost_code& ec, asio::iterator,
-    socket::ptr socket, connect_handler handler)
+void connector::handle_connect(const boost_code& ec, socket::ptr socket,
+    connect_handler handler)
 {
     if (ec)
     {
@@ -180,8 +313,36 @@ void connector::handle_connect(const boost_code& ec, asio::iterator,
         return;
     }
 
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    // A channel is not created for a cancelled attempt.
+    if (stopped())
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        socket->stop();
+        handler(error::service_stopped, nullptr);
+        return;
+    }
+
+    // The connected socket is no longer pending, so stop must not close it.
+    socket_.reset();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // A channel is not created for an unclaimed connection.
+    if (!claimed())
+    {
+        socket->stop();
+        handler(error::channel_stopped, nullptr);
+        return;
+    }
+
     // Ensure that channel is not passed as an r-value.
-    const auto created = std::make_shared<channel>(pool_, socket, settings_);
+    const auto created = create_channel(socket);
     handler(error::success, created);
 }
 
@@ -192,5 +353,250 @@ void connector::handle_timer(const code& ec, socket::ptr ,
     handler(ec ? ec : error::channel_timeout, nullptr);
 }
 
+// Connection race.
+// ----------------------------------------------------------------------------
+
+// private:
+// An ipv4-mapped address is connected as ipv4, for ipv6-only hosts.
+asio::endpoint connector::to_endpoint(const authority& authority)
+{
+    using namespace boost::asio::ip;
+    const auto ip = authority.asio_ip();
+
+    if (ip.is_v4_mapped())
+        return { make_address_v4(v4_mapped, ip), authority.port() };
+
+    return { ip, authority.port() };
+}
+
+// private:
+// Alternate address families, preserving resolver order within each family.
+connector::endpoints connector::interleave(asio::iterator iterator)
+{
+    const asio::iterator end;
+
+    if (iterator == end)
+        return{};
+
+    endpoints first;
+    endpoints second;
+    const auto family = iterator->endpoint().address().is_v6();
+
+    for (; iterator != end; ++iterator)
+    {
+        const auto endpoint = iterator->endpoint();
+        auto& targets = endpoint.address().is_v6() == family ? first : second;
+        targets.push_back(endpoint);
+    }
+
+    endpoints out;
+    out.reserve(first.size() + second.size());
+
+    for (size_t index = 0; index < std::max(first.size(), second.size());
+        ++index)
+    {
+        if (index < first.size())
+            out.push_back(first[index]);
+
+        if (index < second.size())
+            out.push_back(second[index]);
+    }
+
+    return out;
+}
+
+// private:
+// Start an attempt to the next endpoint, and stagger any remaining.
+void connector::start_attempt(race::ptr state)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(state->mutex);
+
+    if (state->finished || state->next == state->targets.size())
+        return;
+
+    const auto& endpoint = state->targets[state->next++];
+    const auto socket = make_pooled<bc::socket>(channel_pool_);
+    state->sockets.push_back(socket);
+    ++state->pending;
+
+    if (state->stagger)
+        state->stagger->stop();
+
+    state->stagger.reset();
+
+    // A zero stagger attempts endpoints sequentially, upon each failure.
+    if (state->next < state->targets.size() &&
+        settings_.connect_stagger_milliseconds != 0)
+    {
+        state->stagger = std::make_shared<deadline>(pool_,
+            settings_.connect_stagger());
+
+        // timer.async_wait will not invoke the handler within this function.
+        state->stagger->start(
+            std::bind(&connector::handle_stagger,
+                shared_from_this(), _1, state));
+    }
+
+    prepare(socket, endpoint);
+
+    // async_connect will not invoke the handler within this function.
+    socket->get().async_connect(endpoint,
+        make_slab_handler(std::bind(&connector::handle_attempt,
+            shared_from_this(), _1, socket, state)));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+void connector::handle_stagger(const code& ec, race::ptr state)
+{
+    // The stagger is stopped when replaced or when the race is finished.
+    if (ec)
+        return;
+
+    start_attempt(state);
+}
+
+// private:
+void connector::handle_attempt(const boost_code& ec, socket::ptr socket,
+    race::ptr state)
+{
+    auto exhausted = false;
+
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(state->mutex);
+        --state->pending;
+        exhausted = state->pending == 0 &&
+            state->next == state->targets.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    if (!ec)
+    {
+        finish(state, error::success, socket);
+        return;
+    }
+
+    if (exhausted)
+    {
+        finish(state, error::boost_to_error_code(ec), nullptr);
+        return;
+    }
+
+    // A failed attempt starts the next without waiting for the stagger.
+    start_attempt(state);
+}
+
+// private:
+void connector::handle_race_timer(const code& ec, race::ptr state)
+{
+    finish(state, ec ? ec : error::channel_timeout, nullptr);
+}
+
+// private:
+// The first completion is taken, all other attempts are cancelled.
+void connector::finish(race::ptr state, const code& ec, socket::ptr winner)
+{
+    connect_handler handler;
+
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(state->mutex);
+
+        if (state->finished)
+            return;
+
+        state->finished = true;
+
+        if (state->stagger)
+            state->stagger->stop();
+
+        for (const auto& socket: state->sockets)
+            if (socket != winner)
+                socket->stop();
+
+        state->sockets.clear();
+        handler = std::move(state->handler);
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+
+        if (timer_)
+            timer_->stop();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    if (ec)
+    {
+        handler(ec, nullptr);
+        return;
+    }
+
+    // A channel is not created for a cancelled attempt.
+    if (stopped())
+    {
+        winner->stop();
+        handler(error::service_stopped, nullptr);
+        return;
+    }
+
+    // A channel is not created for an unclaimed connection.
+    if (!claimed())
+    {
+        winner->stop();
+        handler(error::channel_stopped, nullptr);
+        return;
+    }
+
+    // Ensure that channel is not passed as an r-value.
+    const auto created = create_channel(winner);
+    handler(error::success, created);
+}
+
+// private:
+// The socket is opened so that its options precede the connection, as the
+// receive window scale is negotiated upon connect. A socket option failure
+// does not preclude the connection (and async_connect opens if not open).
+void connector::prepare(socket::ptr socket,
+    const asio::endpoint& endpoint) const
+{
+    boost_code opened;
+    socket->get().open(endpoint.protocol(), opened);
+    const auto ec = opened ? error::boost_to_error_code(opened) :
+        profile_.apply(socket->get());
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Socket options not applied for [" << endpoint << "] "
+            << ec.message();
+    }
+}
+
+// private:
+// A numeric or cached host is not resolved, so its stage is not recorded.
+channel::ptr connector::create_channel(socket::ptr socket) const
+{
+    typedef handshake_trace::stage stage;
+    const auto created = make_pooled<channel>(channel_pool_, socket,
+        settings_);
+
+    created->trace().record(stage::connecting, started_);
+
+    if (resolved_ != handshake_trace::clock::time_point())
+        created->trace().record(stage::resolved, resolved_);
+
+    created->trace().record(stage::connected);
+    return created;
+}
+
 } // namespace network
 } // namespace libbitcoin
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/dispatch_policy.hpp>
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::message;
+
+dispatch_policy::dispatch_policy()
+  : invoked_()
+{
+    invoked_.set(to_index(message_type::block));
+    invoked_.set(to_index(message_type::ping));
+    invoked_.set(to_index(message_type::pong));
+    invoked_.set(to_index(message_type::transaction));
+    invoked_.set(to_index(message_type::verack));
+    invoked_.set(to_index(message_type::version));
+}
+
+// static
+size_t dispatch_policy::to_index(message_type type)
+{
+    return static_cast<size_t>(type);
+}
+
+dispatch_policy::delivery dispatch_policy::get(message_type type) const
+{
+    return invoked_.test(to_index(type)) ? delivery::invoke : delivery::relay;
+}
+
+void dispatch_policy::set(message_type type, delivery value)
+{
+    invoked_.set(to_index(type), value == delivery::invoke);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/dns_cache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+dns_cache::dns_cache(size_t capacity, const asio::duration& expiration,
+    const asio::duration& failure_expiration)
+  : capacity_(capacity),
+    expiration_(expiration),
+    failure_expiration_(failure_expiration)
+{
+}
+
+// private
+std::string dns_cache::to_key(const std::string& hostname, uint16_t port)
+{
+    return hostname + ":" + std::to_string(port);
+}
+
+bool dns_cache::find(const std::string& hostname, uint16_t port,
+    endpoints& out) const
+{
+    const auto key = to_key(hostname, port);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    const auto it = table_.find(key);
+
+    if (it == table_.end() || it->second.expiry <= clock::now())
+        return false;
+
+    out = it->second.targets;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void dns_cache::store(const std::string& hostname, uint16_t port,
+    const endpoints& targets)
+{
+    insert(to_key(hostname, port), targets, expiration_);
+}
+
+void dns_cache::store_failure(const std::string& hostname, uint16_t port)
+{
+    insert(to_key(hostname, port), {}, failure_expiration_);
+}
+
+void dns_cache::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    table_.clear();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+void dns_cache::insert(const std::string& key, const endpoints& targets,
+    const asio::duration& expiration)
+{
+    if (capacity_ == 0 || expiration == asio::duration::zero())
+        return;
+
+    const auto now = clock::now();
+    const auto expiry = now +
+        std::chrono::duration_cast<clock::duration>(expiration);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Purge expired entries when full, and if none then start over.
+    if (table_.size() >= capacity_ && table_.find(key) == table_.end())
+    {
+        for (auto it = table_.begin(); it != table_.end();)
+            it = it->second.expiry <= now ? table_.erase(it) : std::next(it);
+
+        if (table_.size() >= capacity_)
+            table_.clear();
+    }
+
+    table_[key] = { targets, expiry };
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
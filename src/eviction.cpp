@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/eviction.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/traffic.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::message;
+
+// An unmeasured round trip is the worst.
+static asio::duration round_trip(const eviction::candidate& value)
+{
+    return value.round_trip == asio::duration::zero() ?
+        asio::duration::max() : value.round_trip;
+}
+
+// Remove the first of the values as ordered by the comparison.
+template <typename Compare>
+static void protect(eviction::candidates& values, size_t count,
+    Compare compare)
+{
+    const auto end = std::next(values.begin(), std::min(count,
+        values.size()));
+    std::partial_sort(values.begin(), end, values.end(), compare);
+    values.erase(values.begin(), end);
+}
+
+// static
+bool eviction::select(candidates values, size_t count, size_t& out_index)
+{
+    protect(values, count, [](const candidate& left, const candidate& right)
+    {
+        return round_trip(left) < round_trip(right);
+    });
+
+    protect(values, count, [](const candidate& left, const candidate& right)
+    {
+        return left.useful_rate > right.useful_rate;
+    });
+
+    protect(values, count, [](const candidate& left, const candidate& right)
+    {
+        return left.age > right.age;
+    });
+
+    if (values.empty())
+        return false;
+
+    const auto worst = std::min_element(values.begin(), values.end(),
+        [](const candidate& left, const candidate& right)
+        {
+            return left.useful_rate < right.useful_rate ||
+                (left.useful_rate == right.useful_rate &&
+                    left.age < right.age);
+        });
+
+    out_index = worst->index;
+    return true;
+}
+
+// static
+uint64_t eviction::useful_messages(const traffic::snapshot& traffic)
+{
+    uint64_t count = 0;
+
+    for (const auto& command: traffic.commands)
+    {
+        const auto& name = command.command;
+
+        if (name == block::command || name == transaction::command ||
+            name == headers::command || name == inventory::command ||
+            name == compact_block::command ||
+            name == block_transactions::command ||
+            name == merkle_block::command)
+            count += command.counts.messages_in;
+    }
+
+    return count;
+}
+
+} // namespace network
+} // namespace libbitcoin
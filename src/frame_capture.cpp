@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/frame_capture.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::chrono;
+
+// The file begins with this magic and format version.
+static const uint32_t capture_magic = 0x70616362;
+static const uint32_t capture_version = 1;
+
+// Records are buffered per channel and submitted in batches of about this size.
+static const size_t write_batch = 64 * 1024;
+
+// [microseconds:8][channel:4][size:4]
+static const size_t record_overhead = 8 + 4 + 4;
+
+frame_capture::frame_capture(const boost::filesystem::path& file)
+  : start_(clock::now()),
+    channels_(0),
+    file_(file.string(), std::ios::out | std::ios::binary | std::ios::trunc),
+    opened_(file_.good()),
+    writing_(false),
+    stopping_(false)
+{
+    data_chunk header;
+    extend_data(header, to_little_endian(capture_magic));
+    extend_data(header, to_little_endian(capture_version));
+    file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    writer_ = std::thread(&frame_capture::write_buffers, this);
+}
+
+frame_capture::~frame_capture()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    submitted_condition_.notify_one();
+    writer_.join();
+    file_.flush();
+}
+
+// static
+bool frame_capture::load(const boost::filesystem::path& file, frames& out)
+{
+    bc::ifstream stream(file.string(), std::ios::in | std::ios::binary);
+
+    if (!stream)
+        return false;
+
+    const data_chunk data((std::istreambuf_iterator<char>(stream)),
+        std::istreambuf_iterator<char>());
+
+    auto source = make_safe_deserializer(data.begin(), data.end());
+
+    if (source.read_4_bytes_little_endian() != capture_magic ||
+        source.read_4_bytes_little_endian() != capture_version || !source)
+        return false;
+
+    out.clear();
+
+    while (!source.is_exhausted())
+    {
+        frame record;
+        record.microseconds = source.read_8_bytes_little_endian();
+        record.channel = source.read_4_bytes_little_endian();
+        record.data = source.read_bytes(source.read_4_bytes_little_endian());
+
+        // A truncated final record (e.g. from a crash) ends the capture.
+        if (!source)
+            break;
+
+        out.push_back(std::move(record));
+    }
+
+    // Buffers of channels are written as they fill, not in time order.
+    std::stable_sort(out.begin(), out.end(),
+        [](const frame& left, const frame& right)
+        {
+            return left.microseconds < right.microseconds;
+        });
+
+    return true;
+}
+
+bool frame_capture::opened() const
+{
+    return opened_;
+}
+
+uint32_t frame_capture::next_channel()
+{
+    return ++channels_;
+}
+
+void frame_capture::record(data_chunk& buffer, uint32_t channel,
+    const uint8_t* data, size_t size)
+{
+    const auto time = duration_cast<microseconds>(clock::now() - start_);
+    const auto microseconds = static_cast<uint64_t>(time.count());
+
+    if (buffer.capacity() == 0)
+        buffer.reserve(write_batch + record_overhead);
+
+    extend_data(buffer, to_little_endian(microseconds));
+    extend_data(buffer, to_little_endian(channel));
+    extend_data(buffer, to_little_endian(static_cast<uint32_t>(size)));
+    buffer.insert(buffer.end(), data, data + size);
+
+    if (buffer.size() >= write_batch)
+        submit(buffer);
+}
+
+void frame_capture::submit(data_chunk& buffer)
+{
+    if (buffer.empty())
+        return;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        submitted_.push_back(std::move(buffer));
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    buffer = data_chunk();
+    submitted_condition_.notify_one();
+}
+
+// The writer is idle once nothing is submitted, so the file may be flushed.
+void frame_capture::flush()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    written_condition_.wait(lock, [this]()
+    {
+        return submitted_.empty() && !writing_;
+    });
+
+    file_.flush();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+// The writer takes all submitted buffers at once and writes them unlocked.
+// Submitted buffers are written before the writer stops.
+void frame_capture::write_buffers()
+{
+    buffers batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        submitted_condition_.wait(lock, [this]()
+        {
+            return stopping_ || !submitted_.empty();
+        });
+
+        if (submitted_.empty())
+            return;
+
+        std::swap(batch, submitted_);
+        writing_ = true;
+        lock.unlock();
+
+        // A failed stream ignores the write, so capture degrades to nothing.
+        for (const auto& buffer: batch)
+            file_.write(reinterpret_cast<const char*>(buffer.data()),
+                buffer.size());
+
+        batch.clear();
+        lock.lock();
+        writing_ = false;
+        written_condition_.notify_all();
+    }
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/frame_checksum.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+// Define BCT_DISABLE_SHA_EXTENSIONS to always use the system implementation.
+#if !defined(BCT_DISABLE_SHA_EXTENSIONS) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define HAVE_SHA_EXTENSIONS
+    #include <cpuid.h>
+    #include <immintrin.h>
+#endif
+
+namespace libbitcoin {
+namespace network {
+
+#ifdef HAVE_SHA_EXTENSIONS
+
+// cpuid leaf 1 (ecx) and leaf 7 (ebx) feature bits.
+static const uint32_t ssse3_bit = 1u << 9;
+static const uint32_t sse41_bit = 1u << 19;
+static const uint32_t sha_bit = 1u << 29;
+
+static const uint32_t initial[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+alignas(16) static const uint32_t rounds[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void transform(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+    const auto mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull,
+        0x0405060700010203ull);
+
+    // Reorder the state words for the sha extensions (abef, cdgh).
+    auto cdab = _mm_shuffle_epi32(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&state[0])), 0xb1);
+    auto cdgh = _mm_shuffle_epi32(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&state[4])), 0x1b);
+    auto abef = _mm_alignr_epi8(cdab, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, cdab, 0xf0);
+
+    for (; blocks != 0; --blocks, data += 64)
+    {
+        const auto abef_prior = abef;
+        const auto cdgh_prior = cdgh;
+        __m128i words[4];
+
+        // Each group is four rounds, with its four schedule words.
+        for (size_t group = 0; group < 16; ++group)
+        {
+            auto& message = words[group % 4];
+
+            if (group < 4)
+            {
+                message = _mm_shuffle_epi8(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(data + group * 16)),
+                    mask);
+            }
+            else
+            {
+                const auto& last = words[(group + 3) % 4];
+                const auto& prior = words[(group + 2) % 4];
+                message = _mm_sha256msg2_epu32(_mm_add_epi32(
+                    _mm_sha256msg1_epu32(message, words[(group + 1) % 4]),
+                    _mm_alignr_epi8(last, prior, 4)), last);
+            }
+
+            auto sum = _mm_add_epi32(message, _mm_load_si128(
+                reinterpret_cast<const __m128i*>(&rounds[group * 4])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, sum);
+            sum = _mm_shuffle_epi32(sum, 0x0e);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, sum);
+        }
+
+        abef = _mm_add_epi32(abef, abef_prior);
+        cdgh = _mm_add_epi32(cdgh, cdgh_prior);
+    }
+
+    // Restore the state word order (abcd, efgh).
+    const auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    const auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]),
+        _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]),
+        _mm_alignr_epi8(dchg, feba, 8));
+}
+
+// Hash the message from the initial state, padding the final block(s).
+static void sha256(uint32_t* state, const uint8_t* data, size_t size)
+{
+    std::copy_n(initial, 8, state);
+    const auto blocks = size / 64;
+    transform(state, data, blocks);
+
+    uint8_t tail[128] = { 0 };
+    const auto remainder = size % 64;
+    std::copy_n(data + blocks * 64, remainder, tail);
+    tail[remainder] = 0x80;
+
+    const auto padded = remainder < 56 ? 64 : 128;
+    const auto bits = static_cast<uint64_t>(size) * 8;
+
+    for (size_t byte = 0; byte < 8; ++byte)
+        tail[padded - 1 - byte] = static_cast<uint8_t>(bits >> (byte * 8));
+
+    transform(state, tail, padded / 64);
+}
+
+// The checksum is the first four bytes of the double hash, little endian.
+static uint32_t double_sha256_checksum(const uint8_t* data, size_t size)
+{
+    uint32_t state[8];
+    sha256(state, data, size);
+
+    // The second hash is of the 32 byte digest, in one padded block.
+    uint8_t block[64] = { 0 };
+
+    for (size_t word = 0; word < 8; ++word)
+        for (size_t byte = 0; byte < 4; ++byte)
+            block[word * 4 + byte] = static_cast<uint8_t>(
+                state[word] >> (24 - byte * 8));
+
+    block[32] = 0x80;
+    block[62] = 0x01;
+
+    std::copy_n(initial, 8, state);
+    transform(state, block, 1);
+
+    // The first digest byte is the high byte of the first state word.
+    return ((state[0] >> 24) & 0xff) | ((state[0] >> 8) & 0xff00) |
+        ((state[0] << 8) & 0xff0000) | ((state[0] << 24) & 0xff000000);
+}
+
+static bool detect()
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid_max(0, nullptr) < 7 ||
+        !__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    if ((ecx & ssse3_bit) == 0 || (ecx & sse41_bit) == 0)
+        return false;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & sha_bit) != 0;
+}
+
+#endif // HAVE_SHA_EXTENSIONS
+
+uint32_t frame_checksum::compute(const uint8_t* begin, const uint8_t* end)
+{
+#ifdef HAVE_SHA_EXTENSIONS
+    if (accelerated())
+        return double_sha256_checksum(begin,
+            static_cast<size_t>(end - begin));
+#endif
+
+    return bitcoin_checksum(data_slice(begin, end));
+}
+
+uint32_t frame_checksum::compute(const data_slice& payload)
+{
+    return compute(payload.begin(), payload.end());
+}
+
+// Detection is once, upon first use.
+bool frame_checksum::accelerated()
+{
+#ifdef HAVE_SHA_EXTENSIONS
+    static const auto detected = detect();
+    return detected;
+#else
+    return false;
+#endif
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/handler_memory.hpp>
+
+#include <cstddef>
+#include <new>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+handler_memory::handler_memory()
+  : storage_(), in_use_(false)
+{
+}
+
+void* handler_memory::allocate(size_t size)
+{
+    if (size <= capacity && !in_use_.exchange(true))
+        return &storage_;
+
+    return ::operator new(size);
+}
+
+void handler_memory::deallocate(void* pointer)
+{
+    if (pointer == &storage_)
+    {
+        in_use_.store(false);
+        return;
+    }
+
+    ::operator delete(pointer);
+}
+
+} // namespace network
+} // namespace libbitcoin
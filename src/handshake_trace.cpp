@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/handshake_trace.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+static const std::array<std::string, handshake_trace::stage_count> names
+{
+    {
+        "connecting",
+        "resolved",
+        "connected",
+        "started",
+        "version_sent",
+        "version_received",
+        "verack_received",
+        "complete"
+    }
+};
+
+const std::string& handshake_trace::to_string(stage value)
+{
+    return names[static_cast<size_t>(value)];
+}
+
+handshake_trace::handshake_trace()
+  : stages_()
+{
+}
+
+// private
+handshake_trace::ticks handshake_trace::get(size_t index) const
+{
+    return stages_[index].load(std::memory_order_relaxed);
+}
+
+void handshake_trace::record(stage value, clock::time_point time)
+{
+    const auto count = std::max(time.time_since_epoch().count(), ticks(1));
+    auto expected = ticks(0);
+    stages_[static_cast<size_t>(value)].compare_exchange_strong(expected,
+        count, std::memory_order_relaxed);
+}
+
+bool handshake_trace::recorded(stage value) const
+{
+    return get(static_cast<size_t>(value)) != 0;
+}
+
+bool handshake_trace::interval(stage value, asio::duration& out) const
+{
+    const auto index = static_cast<size_t>(value);
+    const auto end = get(index);
+
+    if (end == 0)
+        return false;
+
+    ticks start = 0;
+
+    for (size_t prior = 0; prior < index; ++prior)
+    {
+        const auto time = get(prior);
+
+        if (time != 0 && time <= end)
+            start = std::max(start, time);
+    }
+
+    if (start == 0)
+        return false;
+
+    out = clock::duration(end - start);
+    return true;
+}
+
+bool handshake_trace::elapsed(stage value, asio::duration& out) const
+{
+    const auto end = get(static_cast<size_t>(value));
+
+    if (end == 0)
+        return false;
+
+    auto start = end;
+
+    for (size_t index = 0; index < stage_count; ++index)
+    {
+        const auto time = get(index);
+
+        if (time != 0)
+            start = std::min(start, time);
+    }
+
+    out = clock::duration(end - start);
+    return true;
+}
+
+bool handshake_trace::age(stage value, asio::duration& out,
+    clock::time_point now) const
+{
+    const auto time = get(static_cast<size_t>(value));
+
+    if (time == 0)
+        return false;
+
+    out = clock::duration(std::max(now.time_since_epoch().count(), time) -
+        time);
+    return true;
+}
+
+} // namespace network
+} // namespace libbitcoin
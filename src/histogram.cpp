@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/histogram.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+
+size_t histogram::to_bucket(uint64_t microseconds)
+{
+    size_t bucket = 0;
+
+    while (microseconds != 0 && bucket < bucket_count - 1)
+    {
+        microseconds >>= 1;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+uint64_t histogram::upper_bound(size_t bucket)
+{
+    return bucket >= bucket_count - 1 ? max_uint64 : uint64_t(1) << bucket;
+}
+
+uint64_t histogram::percentile(const snapshot& values, size_t percent)
+{
+    if (values.count == 0)
+        return 0;
+
+    // The rank is rounded up, so that the 100th percentile is the last value.
+    const auto rank = std::max(uint64_t(1),
+        (values.count * std::min(percent, size_t(100)) + 99) / 100);
+    uint64_t counted = 0;
+
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket)
+    {
+        counted += values.buckets[bucket];
+
+        if (counted >= rank)
+            return upper_bound(bucket);
+    }
+
+    // Buckets are read individually, so the count may lead them.
+    return upper_bound(bucket_count - 1);
+}
+
+histogram::histogram()
+  : count_(0),
+    microseconds_(0),
+    buckets_()
+{
+}
+
+void histogram::record(const asio::duration& elapsed)
+{
+    const auto count = std::chrono::duration_cast<std::chrono::microseconds>(
+        elapsed).count();
+    const auto microseconds = count < 0 ? 0 : static_cast<uint64_t>(count);
+
+    buckets_[to_bucket(microseconds)].fetch_add(1, relaxed);
+    microseconds_.fetch_add(microseconds, relaxed);
+    count_.fetch_add(1, relaxed);
+}
+
+histogram::snapshot histogram::collect() const
+{
+    snapshot out;
+    out.count = count_.load(relaxed);
+    out.microseconds = microseconds_.load(relaxed);
+
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket)
+        out.buckets[bucket] = buckets_[bucket].load(relaxed);
+
+    return out;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -19,8 +19,17 @@
 #include <bitcoin/network/hosts.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <ios>
+#include <iterator>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/settings.hpp>
@@ -32,224 +41,721 @@ using namespace bc::config;
 
 #define NAME "hosts"
 
-// TODO: change to network_address bimap hash table with services and age.
+// Addresses are partitioned so that locks are rarely contended, but a small
+// store is not partitioned, as that would reduce its effective capacity.
+static const size_t maximum_shards = 16;
+static const size_t minimum_shard_capacity = 64;
+
+// Selection takes the most promising of a small random sample of addresses.
+static const size_t fetch_samples = 4;
+static const size_t evict_samples = 4;
+
+// Gossip takes the freshest of a random slice this multiple of its size.
+static const size_t freshness_factor = 4;
+
+// An address attempted within this period is unlikely to be selected.
+static const uint32_t recent_attempt_seconds = 10 * 60;
+
+// Chance is reduced geometrically by failed attempts, to this limit.
+static const uint32_t maximum_penalized_attempts = 8;
+
+// An address not seen within this period is stale (evicted, not gossiped).
+static const uint32_t stale_seconds = 30 * 24 * 60 * 60;
+
+// A stored timestamp is refreshed only by one at least this much newer.
+static const uint32_t refresh_seconds = 60 * 60;
+
+static uint32_t unix_time()
+{
+    return static_cast<uint32_t>(std::time(nullptr));
+}
+
 hosts::hosts(const settings& settings)
   : capacity_(static_cast<size_t>(settings.host_pool_capacity)),
-    buffer_(std::max(capacity_, static_cast<size_t>(1u))),
     stopped_(true),
     file_path_(settings.hosts_file),
-    disabled_(capacity_ == 0)
+    disabled_(capacity_ == 0),
+    verbose_(settings.verbose)
+{
+    const auto count = disabled_ ? 0 : std::max(size_t(1),
+        std::min(capacity_ / minimum_shard_capacity, maximum_shards));
+
+    shards_.reserve(count);
+
+    // Distribute capacity evenly across shards.
+    for (size_t index = 0; index < count; ++index)
+    {
+        const auto remainder = (index < capacity_ % count) ? 1 : 0;
+        std::unique_ptr<shard> part(new shard);
+        part->capacity = capacity_ / count + remainder;
+        part->size = 0;
+        part->buffer.reserve(part->capacity);
+        part->table.reserve(part->capacity);
+        shards_.push_back(std::move(part));
+    }
+}
+
+size_t hosts::key_hash::operator()(const key& value) const
+{
+    auto seed = boost::hash_range(value.first.begin(), value.first.end());
+    boost::hash_combine(seed, value.second);
+    return seed;
+}
+
+// private
+hosts::key hosts::to_key(const address& host)
+{
+    return std::make_pair(host.ip(), host.port());
+}
+
+// private
+hosts::entry hosts::to_entry(const address& host)
+{
+    return { host, 0, 0, 0, 0 };
+}
+
+// private
+// The address timestamp is refreshed by gossip and by our own connections.
+// A zero timestamp is unknown (not gossiped), such as from a legacy file.
+bool hosts::is_stale(const entry& value, uint32_t now)
 {
+    const auto seen = value.host.timestamp();
+    return seen != 0 && seen < now && now - seen > stale_seconds;
+}
+
+// private
+// The relative likelihood of connection, independent of attempt recency.
+double hosts::quality(const entry& value, uint32_t now)
+{
+    const auto tried = value.last_success != 0;
+    const auto failures = std::min(value.attempts, maximum_penalized_attempts);
+    const auto age = is_stale(value, now) ? 0.1 : 1.0;
+    return (tried ? 1.0 : 0.5) * age * std::pow(0.66, failures);
+}
+
+// private
+// The relative likelihood of connection, avoiding repeated attempts.
+double hosts::chance(const entry& value, uint32_t now)
+{
+    const auto recent = value.last_attempt != 0 &&
+        now - value.last_attempt < recent_attempt_seconds;
+
+    return quality(value, now) * (recent ? 0.01 : 1.0);
 }
 
 // private
-hosts::iterator hosts::find(const address& host)
+hosts::shard& hosts::select(const address& host) const
 {
-    const auto found = [&host](const address& entry)
+    BITCOIN_ASSERT(!shards_.empty());
+    const auto index = key_hash()(to_key(host)) % shards_.size();
+    return *shards_[index];
+}
+
+// Shard operations, these require the shard lock.
+// ----------------------------------------------------------------------------
+
+// private
+bool hosts::exists(const shard& part, const address& host)
+{
+    return part.table.find(to_key(host)) != part.table.end();
+}
+
+// private
+// The address must not exist, the buffer is bounded by replacement.
+// Returns false if the store is full and no address may be replaced.
+bool hosts::insert(shard& part, const entry& value, uint32_t now)
+{
+    auto& buffer = part.buffer;
+
+    if (buffer.size() < part.capacity)
     {
-        return entry.port() == host.port() && entry.ip() == host.ip();
-    };
+        part.table.emplace(to_key(value.host), buffer.size());
+        buffer.push_back(value);
+        part.size = buffer.size();
+        return true;
+    }
+
+    // Select the least promising of a random sample for replacement.
+    auto position = static_cast<size_t>(pseudo_random::next(0,
+        buffer.size() - 1));
+
+    for (size_t sample = 1; sample < evict_samples; ++sample)
+    {
+        const auto other = static_cast<size_t>(pseudo_random::next(0,
+            buffer.size() - 1));
+
+        if (quality(buffer[other], now) < quality(buffer[position], now))
+            position = other;
+    }
+
+    const auto& replaced = buffer[position];
+
+    // A new address does not displace a current tried address without
+    // failures, and a stale address does not displace a current address.
+    if ((replaced.last_success != 0 && replaced.attempts == 0 &&
+        !is_stale(replaced, now) && value.last_success == 0) ||
+        (is_stale(value, now) && !is_stale(replaced, now)))
+        return false;
 
-    return std::find_if(buffer_.begin(), buffer_.end(), found);
+    part.table.erase(to_key(replaced.host));
+    part.table.emplace(to_key(value.host), position);
+    buffer[position] = value;
+    return true;
 }
 
-size_t hosts::count() const
+// private
+// Erase by moving the last address into the vacated position.
+void hosts::erase(shard& part, size_t position)
+{
+    auto& buffer = part.buffer;
+    const auto last = buffer.size() - 1;
+    part.table.erase(to_key(buffer[position].host));
+
+    if (position != last)
+    {
+        buffer[position] = buffer[last];
+        part.table[to_key(buffer[position].host)] = position;
+    }
+
+    buffer.pop_back();
+    part.size = buffer.size();
+}
+
+// private
+// The address must exist, its timestamp and services are updated if newer.
+void hosts::refresh(shard& part, const entry& value)
+{
+    auto& host = part.buffer[part.table.find(to_key(value.host))->second].host;
+    host.set_timestamp(value.host.timestamp());
+    host.set_services(value.host.services());
+}
+
+// private
+// Returns true if the address was inserted (not if only refreshed).
+bool hosts::insert(const entry& value)
 {
+    auto& part = select(value.host);
+    const auto now = unix_time();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    part.mutex.lock_upgrade();
 
-    return buffer_.size();
+    // Stop is signaled before shards are cleared, so this is sufficient.
+    if (stopped_)
+    {
+        part.mutex.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    const auto it = part.table.find(to_key(value.host));
+
+    if (it != part.table.end())
+    {
+        const auto seen = part.buffer[it->second].host.timestamp();
+
+        if (value.host.timestamp() < seen + refresh_seconds)
+        {
+            part.mutex.unlock_upgrade();
+            //-----------------------------------------------------------------
+            return false;
+        }
+
+        part.mutex.unlock_upgrade_and_lock();
+        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        refresh(part, value);
+
+        part.mutex.unlock();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    part.mutex.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    const auto inserted = insert(part, value, now);
+
+    part.mutex.unlock();
     ///////////////////////////////////////////////////////////////////////////
+
+    return inserted;
 }
 
-code hosts::fetch(address& out) const
+// private
+code hosts::record(const address& host, outcome value)
 {
     if (disabled_)
         return error::not_found;
 
+    auto& part = select(host);
+    const auto now = unix_time();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    unique_lock lock(part.mutex);
 
     if (stopped_)
         return error::service_stopped;
 
-    if (buffer_.empty())
+    const auto it = part.table.find(to_key(host));
+
+    if (it == part.table.end())
         return error::not_found;
 
-    // Randomly select an address from the buffer.
-    const auto random = pseudo_random::next(0, buffer_.size() - 1);
-    const auto index = static_cast<size_t>(random);
-    out = buffer_[index];
+    auto& item = part.buffer[it->second];
+
+    switch (value)
+    {
+        case outcome::attempt:
+            ++item.attempts;
+            item.last_attempt = now;
+            break;
+        case outcome::success:
+            item.attempts = 0;
+            item.last_success = now;
+            item.host.set_timestamp(now);
+            break;
+        case outcome::failure:
+            item.last_failure = now;
+            break;
+    }
+
     return error::success;
     ///////////////////////////////////////////////////////////////////////////
 }
 
+// Properties.
+// ----------------------------------------------------------------------------
+
+// This is lock-free, each shard size is maintained atomically.
+size_t hosts::count() const
+{
+    size_t total = 0;
+
+    for (const auto& part: shards_)
+        total += part->size;
+
+    return total;
+}
+
+code hosts::fetch(address& out) const
+{
+    if (disabled_)
+        return error::not_found;
+
+    if (stopped_)
+        return error::service_stopped;
+
+    const auto total = count();
+
+    if (total == 0)
+        return error::not_found;
+
+    // Locate the shard of a randomly-selected position.
+    auto position = static_cast<size_t>(pseudo_random::next(0, total - 1));
+    size_t first = 0;
+
+    for (; first < shards_.size(); ++first)
+    {
+        const auto size = shards_[first]->size.load();
+
+        if (position < size)
+            break;
+
+        position -= size;
+    }
+
+    const auto now = unix_time();
+
+    // Sizes may change concurrently, so fall through to populated shards.
+    for (size_t offset = 0; offset < shards_.size(); ++offset)
+    {
+        const auto& part = *shards_[(first + offset) % shards_.size()];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(part.mutex);
+
+        const auto& buffer = part.buffer;
+
+        if (buffer.empty())
+            continue;
+
+        // Bias toward addresses likely to connect (tried and not failing).
+        auto selected = position % buffer.size();
+
+        for (size_t sample = 1; sample < fetch_samples; ++sample)
+        {
+            const auto other = static_cast<size_t>(pseudo_random::next(0,
+                buffer.size() - 1));
+
+            if (chance(buffer[other], now) > chance(buffer[selected], now))
+                selected = other;
+        }
+
+        out = buffer[selected].host;
+        return error::success;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return error::not_found;
+}
+
 code hosts::fetch(address::list& out) const
 {
     if (disabled_)
         return error::not_found;
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
+    if (stopped_)
+        return error::service_stopped;
+
+    const auto total = count();
+
+    if (total == 0)
+        return error::not_found;
+
+    const auto out_count = std::min(max_address, std::min(total, capacity_) /
+        static_cast<size_t>(pseudo_random::next(5, 10)));
+
+    if (out_count == 0)
+        return error::success;
+
+    out.reserve(out_count);
+    const auto now = unix_time();
+    const auto newer = [](const address& left, const address& right)
+    {
+        return left.timestamp() > right.timestamp();
+    };
+
+    address::list candidates;
+
+    // Take the freshest of a random slice from each shard in proportion to
+    // its size. Stale addresses are not gossiped.
+    for (const auto& part: shards_)
     {
-        shared_lock lock(mutex_);
+        candidates.clear();
+        size_t share;
 
-        if (stopped_)
-            return error::service_stopped;
+        {
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            shared_lock lock(part->mutex);
 
-        if (buffer_.empty())
-            return error::not_found;
+            const auto& buffer = part->buffer;
+            const auto size = buffer.size();
 
-        const auto out_count = std::min(max_address, std::min(buffer_.size(),
-            capacity_) / static_cast<size_t>(pseudo_random::next(5, 10)));
+            if (size == 0)
+                continue;
 
-        if (out_count == 0)
-            return error::success;
+            share = std::min(size, (out_count * size + total - 1) / total);
+            const auto slice = std::min(size, freshness_factor * share);
+            auto index = static_cast<size_t>(pseudo_random::next(0,
+                size - 1));
 
-        const auto limit = buffer_.size() - 1;
-        auto index = static_cast<size_t>(pseudo_random::next(0, limit));
+            for (size_t count = 0; count < slice; ++count)
+            {
+                const auto& value = buffer[index++ % size];
+
+                if (!is_stale(value, now))
+                    candidates.push_back(value.host);
+            }
+            ///////////////////////////////////////////////////////////////////
+        }
 
-        out.reserve(out_count);
-        for (size_t count = 0; count < out_count; ++count)
-            out.push_back(buffer_[index++ % limit]);
+        share = std::min({ share, candidates.size(), out_count - out.size() });
+        std::partial_sort(candidates.begin(), candidates.begin() + share,
+            candidates.end(), newer);
+        out.insert(out.end(), candidates.begin(), candidates.begin() + share);
     }
-    ///////////////////////////////////////////////////////////////////////////
 
     pseudo_random::shuffle(out);
     return error::success;
 }
 
-// load
-code hosts::start()
+// File format.
+// ----------------------------------------------------------------------------
+// The file is an uncompressed array of fixed-size records, allowing it to be
+// loaded with a single read (or mapped). Records retain timestamp and services.
+
+static const uint32_t file_magic = 0x74736f68;
+static const uint32_t file_version = 2;
+static const size_t file_header_size = 2 * sizeof(uint32_t);
+static const auto record_version = message::version::level::maximum;
+
+// Version 1 records are addresses only, version 2 adds connection history.
+static const size_t history_size = 3 * sizeof(uint32_t);
+
+// private
+data_chunk hosts::serialize(const list& buffer)
 {
-    if (disabled_)
-        return error::success;
+    const auto record_size = address::satoshi_fixed_size(record_version,
+        true) + history_size;
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    data_chunk out(file_header_size + buffer.size() * record_size);
+    auto sink = make_unsafe_serializer(out.begin());
+    sink.write_4_bytes_little_endian(file_magic);
+    sink.write_4_bytes_little_endian(file_version);
 
-    if (!stopped_)
+    // The time of last attempt is not retained.
+    for (const auto& value: buffer)
     {
-        mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
-        return error::operation_failed;
+        value.host.to_data(record_version, sink, true);
+        sink.write_4_bytes_little_endian(value.attempts);
+        sink.write_4_bytes_little_endian(value.last_success);
+        sink.write_4_bytes_little_endian(value.last_failure);
     }
 
-    mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    stopped_ = false;
-    bc::ifstream file(file_path_.string());
-    const auto file_error = file.bad();
+    return out;
+}
+
+// private
+hosts::list hosts::deserialize(const data_chunk& data)
+{
+    list out;
+    auto source = make_safe_deserializer(data.begin(), data.end());
 
-    if (!file_error)
+    if (data.size() >= file_header_size &&
+        source.read_4_bytes_little_endian() == file_magic)
     {
-        std::string line;
+        const auto version = source.read_4_bytes_little_endian();
 
-        while (std::getline(file, line))
+        if (version != 1 && version != file_version)
         {
-            // TODO: create full space-delimited network_address serialization.
-            // Use to/from string format as opposed to wire serialization.
-            config::authority host(line);
+            LOG_WARNING(LOG_NETWORK)
+                << "Unsupported hosts file version, ignored.";
+            return out;
+        }
+
+        const auto history = (version == file_version);
+        const auto record_size = address::satoshi_fixed_size(record_version,
+            true) + (history ? history_size : 0);
+
+        out.reserve((data.size() - file_header_size) / record_size);
+
+        while (!source.is_exhausted())
+        {
+            auto value = to_entry({});
 
-            if (host.port() != 0)
-                buffer_.push_back(host.to_network_address());
+            if (!value.host.from_data(record_version, source, true))
+                break;
+
+            if (history)
+            {
+                value.attempts = source.read_4_bytes_little_endian();
+                value.last_success = source.read_4_bytes_little_endian();
+                value.last_failure = source.read_4_bytes_little_endian();
+
+                if (!source)
+                    break;
+            }
+
+            out.push_back(value);
         }
+
+        return out;
     }
 
-    mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
+    // Otherwise this is a (legacy) line-oriented set of authority strings.
+    std::string line;
+    std::istringstream text(std::string(data.begin(), data.end()));
+
+    while (std::getline(text, line))
+        out.push_back(to_entry(config::authority(line).to_network_address()));
+
+    return out;
+}
+
+// private
+code hosts::read(list& out) const
+{
+    bc::ifstream file(file_path_.string(), std::ios::in | std::ios::binary);
+
+    if (file.bad())
+        return error::file_system;
+
+    data_chunk data((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+
+    out = deserialize(data);
+    return error::success;
+}
+
+// private
+// The file is replaced by rename, so a failure does not lose prior content.
+code hosts::write(const list& buffer) const
+{
+    const auto data = serialize(buffer);
+    const auto temporary = file_path_.string() + ".tmp";
+
+    {
+        bc::ofstream file(temporary, std::ios::out | std::ios::binary);
+
+        if (file.bad())
+            return error::file_system;
+
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        if (!file.good())
+            return error::file_system;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temporary, file_path_, ec);
+    return ec ? error::file_system : error::success;
+}
+
+// Start/Stop.
+// ----------------------------------------------------------------------------
+
+// load
+code hosts::start()
+{
+    if (disabled_)
+        return error::success;
+
+    // The file is read and parsed without holding any lock.
+    list loaded;
+    const auto file_error = read(loaded);
+    auto expected = true;
+
+    if (!stopped_.compare_exchange_strong(expected, false))
+        return error::operation_failed;
+
+    for (const auto& value: loaded)
+        if (value.host.port() != 0)
+            insert(value);
 
     if (file_error)
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Failed to save hosts file.";
+            << "Failed to load hosts file.";
         return error::file_system;
     }
 
     return error::success;
 }
 
-// load
+// save
 code hosts::stop()
 {
     if (disabled_)
         return error::success;
 
+    auto expected = false;
+
+    // Signal stop before clearing so that concurrent inserts are rejected.
+    if (!stopped_.compare_exchange_strong(expected, true))
+        return error::success;
+
+    list buffer;
+    buffer.reserve(capacity_);
+
+    for (const auto& part: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(part->mutex);
+
+        buffer.insert(buffer.end(), part->buffer.begin(), part->buffer.end());
+        part->buffer.clear();
+        part->table.clear();
+        part->size = 0;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    unique_lock lock(file_mutex_);
 
-    if (stopped_)
+    // The file is written without holding any shard lock.
+    if (write(buffer))
     {
-        mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
-        return error::success;
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failed to save hosts file.";
+        return error::file_system;
     }
 
-    mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    stopped_ = true;
-    bc::ofstream file(file_path_.string());
-    const auto file_error = file.bad();
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
 
-    if (!file_error)
+// checkpoint
+code hosts::save()
+{
+    if (disabled_)
+        return error::success;
+
+    if (stopped_)
+        return error::service_stopped;
+
+    list buffer;
+    buffer.reserve(capacity_);
+
+    // Copy the snapshot, this blocks only writers and one shard at a time.
+    for (const auto& part: shards_)
     {
-        for (const auto& entry: buffer_)
-        {
-            // TODO: create full space-delimited network_address serialization.
-            // Use to/from string format as opposed to wire serialization.
-            file << config::authority(entry) << std::endl;
-        }
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(part->mutex);
 
-        buffer_.clear();
+        buffer.insert(buffer.end(), part->buffer.begin(), part->buffer.end());
+        ///////////////////////////////////////////////////////////////////////
     }
 
-    mutex_.unlock();
+    // Critical Section
     ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(file_mutex_);
 
-    if (file_error)
+    // Do not overwrite the stop save with an older snapshot.
+    if (stopped_)
+        return error::service_stopped;
+
+    if (write(buffer))
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Failed to load hosts file.";
+            << "Failed to checkpoint hosts file.";
         return error::file_system;
     }
 
     return error::success;
+    ///////////////////////////////////////////////////////////////////////////
 }
 
+// Store/Remove.
+// ----------------------------------------------------------------------------
+
 code hosts::remove(const address& host)
 {
     if (disabled_)
         return error::not_found;
 
+    auto& part = select(host);
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    part.mutex.lock_upgrade();
 
     if (stopped_)
     {
-        mutex_.unlock_upgrade();
+        part.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return error::service_stopped;
     }
 
-    auto it = find(host);
+    const auto it = part.table.find(to_key(host));
 
-    if (it != buffer_.end())
+    if (it != part.table.end())
     {
-        mutex_.unlock_upgrade_and_lock();
+        part.mutex.unlock_upgrade_and_lock();
         //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-        buffer_.erase(it);
+        erase(part, it->second);
 
-        mutex_.unlock();
+        part.mutex.unlock();
         //---------------------------------------------------------------------
         return error::success;
     }
 
-    mutex_.unlock_upgrade();
+    part.mutex.unlock_upgrade();
     ///////////////////////////////////////////////////////////////////////////
 
     return error::not_found;
@@ -269,36 +775,12 @@ code hosts::store(const address& host)
         return error::success;
     }
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
-
     if (stopped_)
-    {
-        mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
         return error::service_stopped;
-    }
 
-    if (find(host) == buffer_.end())
-    {
-        mutex_.unlock_upgrade_and_lock();
-        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-        buffer_.push_back(host);
-
-        mutex_.unlock();
-        //---------------------------------------------------------------------
-        return error::success;
-    }
-
-    mutex_.unlock_upgrade();
-    ///////////////////////////////////////////////////////////////////////////
-
-    ////// We don't treat redundant address as an error, just log it.
-    ////LOG_DEBUG(LOG_NETWORK)
-    ////    << "Redundant host address [" << authority(host) << "] from peer.";
-
-    return error::success;
+    // We don't treat redundant address as an error.
+    insert(to_entry(host));
+    return stopped_ ? error::service_stopped : error::success;
 }
 
 void hosts::store(const address::list& hosts, result_handler handler)
@@ -309,34 +791,26 @@ void hosts::store(const address::list& hosts, result_handler handler)
         return;
     }
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
-
     if (stopped_)
     {
-        mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
         handler(error::service_stopped);
         return;
     }
 
     // Accept between 1 and all of this peer's addresses up to capacity.
-    const auto capacity = buffer_.capacity();
+    const auto capacity = capacity_;
     const auto usable = std::min(hosts.size(), capacity);
     const auto random = static_cast<size_t>(pseudo_random::next(1, usable));
 
     // But always accept at least the amount we are short if available.
-    const auto gap = capacity - buffer_.size();
+    const auto gap = capacity - std::min(count(), capacity);
     const auto accept = std::max(gap, random);
 
     // Convert minimum desired to step for iteration, no less than 1.
     const auto step = std::max(usable / accept, size_t(1));
     size_t accepted = 0;
 
-    mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
+    // Each address locks only its own shard, and only briefly.
     for (size_t index = 0; index < usable; index = ceiling_add(index, step))
     {
         const auto& host = hosts[index];
@@ -350,21 +824,33 @@ void hosts::store(const address::list& hosts, result_handler handler)
         }
 
         // Do not allow duplicates in the host cache.
-        if (find(host) == buffer_.end())
-        {
+        if (insert(to_entry(host)))
             ++accepted;
-            buffer_.push_back(host);
-        }
     }
 
-    mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
-
-    LOG_VERBOSE(LOG_NETWORK)
+    LOG_NETWORK_VERBOSE(verbose_)
         << "Accepted (" << accepted << " of " << hosts.size()
         << ") host addresses from peer.";
 
-    handler(error::success);
+    handler(stopped_ ? error::service_stopped : error::success);
+}
+
+// Connection history.
+// ----------------------------------------------------------------------------
+
+code hosts::attempted(const address& host)
+{
+    return record(host, outcome::attempt);
+}
+
+code hosts::succeeded(const address& host)
+{
+    return record(host, outcome::success);
+}
+
+code hosts::failed(const address& host)
+{
+    return record(host, outcome::failure);
 }
 
 } // namespace network
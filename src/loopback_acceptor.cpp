@@ -0,0 +1,264 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/loopback_acceptor.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "loopback_acceptor"
+
+using namespace std::placeholders;
+
+loopback_acceptor::loopback_acceptor(threadpool& pool,
+    const settings& settings, loopback_hub::ptr hub)
+  : acceptor(pool, settings),
+    pool_(pool),
+    settings_(settings),
+    hub_(hub),
+    dispatch_(pool, NAME),
+    stopped_(true),
+    port_(0)
+{
+}
+
+void loopback_acceptor::stop(const code& ec)
+{
+    accept_handler pending;
+    std::deque<transport::ptr> arrivals;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (stopped_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        acceptor::stop(ec);
+        return;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    // The hub retains this acceptor by its listener until removed.
+    hub_->unlisten(port_);
+    std::swap(pending, pending_);
+    std::swap(arrivals, arrivals_);
+
+    // Release the admission handler, which may retain its session.
+    admit_ = nullptr;
+    stopped_ = true;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto transport: arrivals)
+        transport->stop();
+
+    if (pending)
+        dispatch_.concurrent(pending, error::service_stopped, nullptr);
+
+    acceptor::stop(ec);
+}
+
+// private
+bool loopback_acceptor::stopped() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return stopped_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code loopback_acceptor::listen(uint16_t port)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (!stopped_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return error::operation_failed;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    const auto ec = hub_->listen(port,
+        std::bind(&loopback_acceptor::handle_connection,
+            shared_from_base<loopback_acceptor>(), _1));
+
+    if (!ec)
+    {
+        port_ = port;
+        stopped_ = false;
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return ec;
+}
+
+code loopback_acceptor::listen(const asio::endpoint& endpoint, bool,
+    bool)
+{
+    return listen(endpoint.port());
+}
+
+void loopback_acceptor::accept(accept_handler handler)
+{
+    transport::ptr arrival;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (stopped_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        dispatch_.concurrent(handler, error::service_stopped, nullptr);
+        return;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    // A queued arrival is accepted now, otherwise await the next.
+    if (arrivals_.empty())
+    {
+        pending_ = handler;
+    }
+    else
+    {
+        arrival = arrivals_.front();
+        arrivals_.pop_front();
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!arrival)
+        return;
+
+    // Ensure that channel is not passed as an r-value.
+    const auto created = create_channel(arrival);
+    dispatch_.concurrent(handler, error::success, created);
+}
+
+void loopback_acceptor::set_admission(admission_handler admit)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    admit_ = admit;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+// Invoked by the hub on the connecting thread, so the handler is dispatched.
+void loopback_acceptor::handle_connection(transport::ptr transport)
+{
+    accept_handler pending;
+    admission_handler admit;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+    const auto stopped = stopped_;
+    admit = admit_;
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (stopped)
+    {
+        transport->stop();
+        return;
+    }
+
+    // Admission precedes channel construction, as with socket accepts.
+    const auto authority = transport->authority();
+    const auto rejected = admit ? admit(authority) : error::success;
+
+    if (rejected)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Rejected loopback connection from [" << authority << "] "
+            << rejected.message();
+        transport->stop();
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (stopped_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        transport->stop();
+        return;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    // Queue the arrival if there is no outstanding accept.
+    if (pending_)
+        std::swap(pending, pending_);
+    else
+        arrivals_.push_back(transport);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!pending)
+        return;
+
+    // Ensure that channel is not passed as an r-value.
+    const auto created = create_channel(transport);
+    dispatch_.concurrent(pending, error::success, created);
+}
+
+// private:
+channel::ptr loopback_acceptor::create_channel(transport::ptr transport) const
+{
+    const auto created = make_pooled<channel>(pool_, transport,
+        settings_);
+    created->trace().record(handshake_trace::stage::connected);
+    return created;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/loopback_connector.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "loopback_connector"
+
+loopback_connector::loopback_connector(threadpool& pool,
+    const settings& settings, loopback_hub::ptr hub)
+  : connector(pool, settings),
+    stopped_(false),
+    pool_(pool),
+    settings_(settings),
+    hub_(hub),
+    dispatch_(pool, NAME)
+{
+}
+
+void loopback_connector::stop(const code& ec)
+{
+    stopped_ = true;
+    connector::stop(ec);
+}
+
+void loopback_connector::connect(const config::endpoint& endpoint,
+    connect_handler handler)
+{
+    connect_port(endpoint.port(), handler);
+}
+
+void loopback_connector::connect(const config::authority& authority,
+    connect_handler handler)
+{
+    connect_port(authority.port(), handler);
+}
+
+void loopback_connector::connect(const std::string&, uint16_t port,
+    connect_handler handler)
+{
+    connect_port(port, handler);
+}
+
+// private:
+// The connection is synchronous, so the handler is dispatched as if not.
+void loopback_connector::connect_port(uint16_t port,
+    connect_handler handler)
+{
+    typedef handshake_trace::stage stage;
+
+    if (stopped_)
+    {
+        dispatch_.concurrent(handler, error::service_stopped, nullptr);
+        return;
+    }
+
+    const auto started = handshake_trace::clock::now();
+    const auto transport = hub_->connect(port);
+
+    if (!transport)
+    {
+        dispatch_.concurrent(handler, error::operation_failed, nullptr);
+        return;
+    }
+
+    // A channel is not created for an unclaimed connection.
+    if (!claimed())
+    {
+        transport->stop();
+        dispatch_.concurrent(handler, error::channel_stopped, nullptr);
+        return;
+    }
+
+    // Ensure that channel is not passed as an r-value.
+    const auto created = make_pooled<channel>(pool_, transport,
+        settings_);
+    created->trace().record(stage::connecting, started);
+    created->trace().record(stage::connected);
+    dispatch_.concurrent(handler, error::success, created);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/loopback_hub.hpp>
+
+#include <cstdint>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/loopback_transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+// Listeners are addressed as the local host.
+static const std::string server_host = "127.0.0.1";
+
+// Clients are synthesized within 10.0.0.0/8 on ephemeral ports.
+static const uint16_t ephemeral_base = 49152;
+static const uint16_t ephemeral_count = 16384;
+
+loopback_hub::loopback_hub()
+  : clients_(0)
+{
+}
+
+code loopback_hub::listen(uint16_t port, listener handler)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (listeners_.find(port) != listeners_.end())
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return error::address_in_use;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    listeners_.emplace(port, handler);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return error::success;
+}
+
+void loopback_hub::unlisten(uint16_t port)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    listeners_.erase(port);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+transport::ptr loopback_hub::connect(uint16_t port)
+{
+    listener handler;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock_shared();
+    const auto it = listeners_.find(port);
+
+    if (it != listeners_.end())
+        handler = it->second;
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!handler)
+        return nullptr;
+
+    const auto ends = loopback_transport::connect(next_client(),
+        config::authority(server_host, port));
+
+    // The listener is invoked outside of the lock, as it may connect.
+    handler(ends.second);
+    return ends.first;
+}
+
+// private:
+config::authority loopback_hub::next_client()
+{
+    const auto client = ++clients_;
+    const auto host = "10." +
+        std::to_string((client >> 16) & 0xff) + "." +
+        std::to_string((client >> 8) & 0xff) + "." +
+        std::to_string(client & 0xff);
+
+    const auto port = static_cast<uint16_t>(ephemeral_base +
+        client % ephemeral_count);
+
+    return config::authority(host, port);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/loopback_transport.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace boost::asio;
+
+static const boost_code aborted = boost::asio::error::operation_aborted;
+static const boost_code broken = boost::asio::error::broken_pipe;
+static const boost_code ended = boost::asio::error::eof;
+
+// static
+loopback_transport::pair loopback_transport::connect(
+    const config::authority& client, const config::authority& server)
+{
+    const auto client_end = std::make_shared<loopback_transport>(server);
+    const auto server_end = std::make_shared<loopback_transport>(client);
+    client_end->peer_ = server_end;
+    server_end->peer_ = client_end;
+    return { client_end, server_end };
+}
+
+loopback_transport::loopback_transport(const config::authority& authority)
+  : authority_(authority),
+    offset_(0),
+    stopped_(false),
+    closed_(false),
+    reading_(false),
+    read_required_(0),
+    read_strand_(nullptr)
+{
+}
+
+config::authority loopback_transport::authority() const
+{
+    return authority_;
+}
+
+void loopback_transport::read(const mutable_buffer& buffer, size_t required,
+    strand& strand, io_handler handler)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The proxy does not overlap reads.
+    BITCOIN_ASSERT(!reading_);
+    reading_ = true;
+    read_buffer_ = buffer;
+    read_required_ = required;
+    read_strand_ = &strand;
+    read_handler_ = handler;
+    complete_read();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void loopback_transport::write(const const_buffers& buffers, strand& strand,
+    io_handler handler)
+{
+    std::shared_ptr<loopback_transport> peer;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+    const auto stopped = stopped_;
+    peer = peer_.lock();
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (stopped)
+    {
+        post(strand, std::bind(handler, aborted, 0));
+        return;
+    }
+
+    // The peer lock is not taken while holding our own.
+    const auto written = peer ? peer->receive(buffers) : 0;
+
+    if (written == 0 && buffer_size(buffers) != 0)
+    {
+        post(strand, std::bind(handler, broken, 0));
+        return;
+    }
+
+    post(strand, std::bind(handler, boost_code(), written));
+}
+
+void loopback_transport::stop()
+{
+    std::shared_ptr<loopback_transport> peer;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (stopped_)
+    {
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    stopped_ = true;
+    inbound_.clear();
+    offset_ = 0;
+    peer = peer_.lock();
+    peer_.reset();
+
+    // This fails the pending read, if any.
+    complete_read();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (peer)
+        peer->close();
+}
+
+// private:
+// Returns the number of bytes accepted, zero if this end is stopped.
+size_t loopback_transport::receive(const const_buffers& buffers)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+        return 0;
+
+    // Drop the consumed prefix, so that a reader which always leaves a
+    // partial frame does not grow the buffer without bound.
+    inbound_.erase(inbound_.begin(), std::next(inbound_.begin(), offset_));
+    offset_ = 0;
+
+    size_t written = 0;
+
+    for (const auto& buffer: buffers)
+    {
+        const auto data = static_cast<const uint8_t*>(buffer.data());
+        inbound_.insert(inbound_.end(), data, data + buffer.size());
+        written += buffer.size();
+    }
+
+    complete_read();
+    return written;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+// The far end has stopped, so reads beyond the buffered data fail with eof.
+void loopback_transport::close()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    closed_ = true;
+    peer_.reset();
+    complete_read();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+// The caller must hold the mutex exclusively.
+void loopback_transport::complete_read()
+{
+    if (!reading_)
+        return;
+
+    const auto available = inbound_.size() - offset_;
+
+    if (stopped_)
+    {
+        post(*read_strand_, std::bind(read_handler_, aborted, 0));
+    }
+    else if (available >= read_required_ && available != 0)
+    {
+        const auto size = std::min(available, read_buffer_.size());
+        const auto begin = std::next(inbound_.begin(), offset_);
+        std::copy(begin, std::next(begin, size),
+            static_cast<uint8_t*>(read_buffer_.data()));
+        offset_ += size;
+        post(*read_strand_, std::bind(read_handler_, boost_code(), size));
+    }
+    else if (closed_)
+    {
+        post(*read_strand_, std::bind(read_handler_, ended, 0));
+    }
+    else
+    {
+        return;
+    }
+
+    reading_ = false;
+    read_strand_ = nullptr;
+    read_handler_ = nullptr;
+}
+
+} // namespace network
+} // namespace libbitcoin
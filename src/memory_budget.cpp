@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/memory_budget.hpp>
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+memory_budget::memory_budget(size_t limit)
+  : limit_(limit),
+    used_(0)
+{
+}
+
+bool memory_budget::try_acquire(size_t bytes)
+{
+    auto used = used_.load();
+
+    do
+    {
+        if (limit_ != 0 && (bytes > limit_ || used > limit_ - bytes))
+            return false;
+
+    } while (!used_.compare_exchange_weak(used, used + bytes));
+
+    return true;
+}
+
+void memory_budget::acquire(size_t bytes)
+{
+    used_ += bytes;
+}
+
+void memory_budget::release(size_t bytes)
+{
+    BITCOIN_ASSERT(bytes <= used_);
+    used_ -= bytes;
+}
+
+size_t memory_budget::used() const
+{
+    return used_;
+}
+
+size_t memory_budget::limit() const
+{
+    return limit_;
+}
+
+} // namespace network
+} // namespace libbitcoin
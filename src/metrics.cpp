@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/metrics.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+
+static const std::array<std::string, metrics::session_types> names
+{
+    {
+        "inbound",
+        "outbound",
+        "manual",
+        "seed"
+    }
+};
+
+const std::string& metrics::to_string(session_type type)
+{
+    return names[static_cast<size_t>(type)];
+}
+
+metrics::metrics()
+  : sessions_(),
+    handshakes_(),
+    stages_()
+{
+}
+
+// private
+metrics::counters& metrics::get(session_type type)
+{
+    return sessions_[static_cast<size_t>(type)];
+}
+
+void metrics::attempted(session_type type)
+{
+    get(type).attempts.fetch_add(1, relaxed);
+}
+
+void metrics::failed(session_type type)
+{
+    get(type).failures.fetch_add(1, relaxed);
+}
+
+// Stages that were not recorded (or have no recorded predecessor) are skipped.
+void metrics::handshaken(session_type type, const handshake_trace& trace)
+{
+    typedef handshake_trace::stage stage;
+    asio::duration elapsed(0);
+
+    for (size_t index = 0; index < stages_.size(); ++index)
+        if (trace.interval(static_cast<stage>(index), elapsed))
+            stages_[index].record(elapsed);
+
+    if (!trace.elapsed(stage::complete, elapsed))
+        elapsed = asio::duration(0);
+
+    handshakes_.record(elapsed);
+
+    const auto count = std::chrono::duration_cast<std::chrono::microseconds>(
+        elapsed).count();
+
+    auto& counts = get(type);
+    counts.handshakes.fetch_add(1, relaxed);
+    counts.handshake_microseconds.fetch_add(
+        count < 0 ? 0 : static_cast<uint64_t>(count), relaxed);
+}
+
+void metrics::handshake_failed(session_type type)
+{
+    get(type).handshake_failures.fetch_add(1, relaxed);
+}
+
+void metrics::connected(session_type type)
+{
+    get(type).connected.fetch_add(1, relaxed);
+}
+
+void metrics::disconnected(session_type type)
+{
+    get(type).connected.fetch_sub(1, relaxed);
+}
+
+metrics::snapshot metrics::collect() const
+{
+    snapshot out;
+
+    for (size_t index = 0; index < sessions_.size(); ++index)
+    {
+        const auto& counts = sessions_[index];
+        out[index] =
+        {
+            counts.connected.load(relaxed),
+            counts.attempts.load(relaxed),
+            counts.failures.load(relaxed),
+            counts.handshakes.load(relaxed),
+            counts.handshake_failures.load(relaxed),
+            counts.handshake_microseconds.load(relaxed)
+        };
+    }
+
+    return out;
+}
+
+histogram::snapshot metrics::handshakes() const
+{
+    return handshakes_.collect();
+}
+
+metrics::stage_histograms metrics::stages() const
+{
+    stage_histograms out;
+
+    for (size_t index = 0; index < stages_.size(); ++index)
+        out[index] = stages_[index].collect();
+
+    return out;
+}
+
+} // namespace network
+} // namespace libbitcoin
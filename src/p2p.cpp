@@ -19,15 +19,18 @@
 #include <bitcoin/network/p2p.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/anchors.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/hosts.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
@@ -47,16 +50,29 @@ namespace network {
 
 #define NAME "p2p"
 
+using namespace std::chrono;
+
+static size_t to_milliseconds(const asio::duration& elapsed)
+{
+    return static_cast<size_t>(duration_cast<milliseconds>(elapsed).count());
+}
+
 using namespace bc::config;
 using namespace std::placeholders;
 
 // This can be exceeded due to manual connection calls and race conditions.
 inline size_t nominal_connecting(const settings& settings)
 {
-    return settings.peers.size() + settings.connect_batch_size *
-        settings.outbound_connections;
+    return settings.peers.size() + std::max(settings.connect_batch_size,
+        settings.connect_batch_maximum) * settings.outbound_connections;
 }
 
+// Names are those of seeds and manual peers, so this is rarely approached.
+static const size_t dns_cache_capacity = 1024;
+
+// Gauge names reported to the statistics server are prefixed by this.
+static const std::string statistics_prefix = "network.";
+
 // This can be exceeded due to manual connection calls and race conditions.
 inline size_t nominal_connected(const settings& settings)
 {
@@ -69,12 +85,39 @@ p2p::p2p(const settings& settings)
     stopped_(true),
     top_block_({ null_hash, 0 }),
     top_header_({ null_hash, 0 }),
+    shards_(settings_.channel_shards ?
+        std::make_shared<thread_shards>(threadpool_) : nullptr),
+    timers_(settings_.timer_wheel_milliseconds == 0 ? nullptr :
+        std::make_shared<timer_wheel>(threadpool_,
+            settings_.timer_wheel_resolution())),
     hosts_(settings_),
+    name_cache_(std::make_shared<dns_cache>(dns_cache_capacity,
+        settings_.dns_cache_expiration(), settings_.dns_failure_expiration())),
+    buffer_budget_(std::make_shared<memory_budget>(
+        size_t(settings_.buffer_budget_megabytes) * 1024 * 1024)),
+    read_shaping_(std::make_shared<token_bucket>(
+        1024.0 * settings_.read_kilobytes_per_second,
+        1024.0 * settings_.read_kilobytes_per_second)),
+    write_shaping_(std::make_shared<token_bucket>(
+        1024.0 * settings_.write_kilobytes_per_second,
+        1024.0 * settings_.write_kilobytes_per_second)),
+    address_blacklist_(std::make_shared<blacklist>(settings_.blacklists,
+        settings_.blacklist_subnets)),
+    traffic_(std::make_shared<traffic>()),
+    metrics_(std::make_shared<metrics>()),
+    statsd_(settings_.statistics_server.port() == 0 ||
+        settings_.statistics_interval_seconds == 0 ? nullptr :
+        std::make_shared<statsd>(threadpool_, settings_.statistics_server,
+            settings_.statistics_interval(), statistics_prefix)),
+    capture_(settings_.capture_file.empty() ? nullptr :
+        std::make_shared<frame_capture>(settings_.capture_file)),
     pending_connect_(nominal_connecting(settings_)),
     pending_handshake_(nominal_connected(settings_)),
     pending_close_(nominal_connected(settings_)),
     stop_subscriber_(std::make_shared<stop_subscriber>(threadpool_,
         NAME "_stop_sub")),
+    hosts_subscriber_(std::make_shared<stop_subscriber>(threadpool_,
+        NAME "_hosts_sub")),
     channel_subscriber_(std::make_shared<channel_subscriber>(threadpool_,
         NAME "_sub"))
 {
@@ -97,12 +140,37 @@ void p2p::start(result_handler handler)
         return;
     }
 
+    // With shards the configured threads are divided, one is kept by the
+    // threadpool (sessions, acceptors, connectors and timers) and each of
+    // the others is a single threaded shard to which channels are pinned.
+    const auto threads = thread_default(settings_.threads);
+    const auto shards = shards_ ? std::max(threads, size_t(2)) - 1 : 0;
+
     threadpool_.join();
-    threadpool_.spawn(thread_default(settings_.threads),
-        thread_priority::normal);
+    threadpool_.spawn(shards_ ? 1 : threads, thread_priority::normal);
+
+    if (shards_)
+        shards_->spawn(shards, thread_priority::normal);
+
+    if (timers_)
+        timers_->start();
+
+    if (statsd_)
+        statsd_->start(std::bind(&p2p::statistics, this));
+
+    if (capture_)
+    {
+        if (capture_->opened())
+            LOG_INFO(LOG_NETWORK)
+                << "Capturing received frames to " << settings_.capture_file;
+        else
+            LOG_ERROR(LOG_NETWORK)
+                << "Failed to open capture file " << settings_.capture_file;
+    }
 
     stopped_ = false;
     stop_subscriber_->start();
+    hosts_subscriber_->start();
     channel_subscriber_->start();
 
     // This instance is retained by stop handler and member reference.
@@ -149,15 +217,53 @@ void p2p::handle_hosts_loaded(const code& ec, result_handler handler)
         return;
     }
 
+    // Periodically save the hosts file so that a crash does not lose it.
+    if (settings_.host_pool_checkpoint_minutes != 0)
+    {
+        const auto timer = std::make_shared<deadline>(threadpool_,
+            settings_.host_pool_checkpoint());
+        checkpoint_.store(timer);
+        timer->start(std::bind(&p2p::handle_checkpoint, this, _1));
+    }
+
     // The instance is retained by the stop handler (until shutdown).
     const auto seed = attach_seed_session();
 
+    if (settings_.concurrent_seeding)
+    {
+        // Seeding continues in the background while the run sequence starts.
+        // Outbound connections await addresses if the pool is still empty.
+        seed->start(
+            std::bind(&p2p::handle_seeded,
+                this, _1));
+
+        handle_started(error::success, handler);
+        return;
+    }
+
     // This is invoked on a new thread.
     seed->start(
         std::bind(&p2p::handle_started,
             this, _1, handler));
 }
 
+void p2p::handle_seeded(const code& ec)
+{
+    if (stopped() || ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Background seeding did not complete: " << ec.message();
+        return;
+    }
+
+    LOG_INFO(LOG_NETWORK)
+        << "Background seeding complete with " << address_count()
+        << " addresses.";
+}
+
 void p2p::handle_started(const code& ec, result_handler handler)
 {
     if (stopped())
@@ -183,6 +289,66 @@ void p2p::handle_started(const code& ec, result_handler handler)
     handler(error::success);
 }
 
+// Hosts checkpoint.
+// ----------------------------------------------------------------------------
+
+void p2p::handle_checkpoint(const code& ec)
+{
+    if (stopped() || ec)
+        return;
+
+    const auto result = hosts_.save();
+
+    if (result && result != error::service_stopped)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Error saving host addresses: " << result.message();
+    }
+
+    const auto timer = checkpoint_.load();
+
+    if (timer)
+        timer->start(std::bind(&p2p::handle_checkpoint, this, _1));
+}
+
+// Anchors.
+// ----------------------------------------------------------------------------
+
+// Outbound channels that have been connected for the minimum period are the
+// first connections attempted by the outbound session upon restart.
+void p2p::save_anchors() const
+{
+    if (settings_.anchor_connections == 0)
+        return;
+
+    const auto minimum = settings_.anchor_minimum();
+    const auto channels = pending_close_.snapshot();
+    config::authority::list peers;
+    asio::duration age;
+
+    for (const auto& channel: *channels)
+    {
+        if (peers.size() >= settings_.anchor_connections)
+            break;
+
+        if (channel->outbound() && channel->trace().age(
+            handshake_trace::stage::complete, age) && age >= minimum)
+            peers.push_back(channel->authority());
+    }
+
+    const auto ec = anchors::save(settings_.anchors_file, peers);
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Error saving anchor peers: " << ec.message();
+        return;
+    }
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Saved " << peers.size() << " anchor peers.";
+}
+
 // Run sequence.
 // ----------------------------------------------------------------------------
 
@@ -272,13 +438,39 @@ bool p2p::stop()
     LOG_DEBUG(LOG_NETWORK)
     << "p2p::stop()";
 
-    // This is the only stop operation that can fail.
-    const auto result = (hosts_.stop() == error::success);
+    const auto started = steady_clock::now();
+    const auto running = !stopped();
+
+    // Persist the proven outbound peers before their channels are stopped.
+    if (running)
+        save_anchors();
+
+    const auto anchored = steady_clock::now();
+    asio::duration hosts_elapsed;
+
+    // The hosts file is written concurrently with the stop of channels, on its
+    // own thread, as the threadpool may be busy. This is the only stop
+    // operation that can fail.
+    auto hosts_stop = std::async(std::launch::async,
+        [this, &hosts_elapsed]() -> code
+        {
+            const auto start = steady_clock::now();
+            const auto ec = hosts_.stop();
+            hosts_elapsed = steady_clock::now() - start;
+            return ec;
+        });
 
     // Signal all current work to stop and free manual session.
     stopped_ = true;
     manual_.store({});
 
+    // Cancel and free the hosts checkpoint timer.
+    const auto checkpoint = checkpoint_.load();
+    checkpoint_.store({});
+
+    if (checkpoint)
+        checkpoint->stop();
+
     // Prevent subscription after stop.
     LOG_DEBUG(LOG_NETWORK)
     << "calling stop_subscriber_->stop()";
@@ -290,6 +482,10 @@ bool p2p::stop()
 
     stop_subscriber_->invoke(error::service_stopped);
 
+    // Release sessions awaiting addresses.
+    hosts_subscriber_->stop();
+    hosts_subscriber_->invoke(error::service_stopped);
+
     // Prevent subscription after stop.
     LOG_DEBUG(LOG_NETWORK)
     << "calling channel_subscriber_->stop()";
@@ -317,11 +513,39 @@ bool p2p::stop()
 
     pending_close_.stop(error::service_stopped);
 
+    const auto signaled = steady_clock::now();
+
+    // Drop any remaining channel timers, releasing their references.
+    if (timers_)
+        timers_->stop();
+
+    if (statsd_)
+        statsd_->stop();
+
+    if (capture_)
+        capture_->flush();
+
     // Signal threadpool to stop accepting work now that subscribers are clear.
     LOG_DEBUG(LOG_NETWORK)
     << "calling threadpool_->shutdown()";
 
     threadpool_.shutdown();
+
+    if (shards_)
+        shards_->shutdown();
+
+    const auto result = (hosts_stop.get() == error::success);
+
+    if (running)
+    {
+        LOG_INFO(LOG_NETWORK)
+            << "Network stopped in " << to_milliseconds(steady_clock::now() -
+                started) << "ms (anchors "
+            << to_milliseconds(anchored - started) << "ms, channels "
+            << to_milliseconds(signaled - anchored) << "ms, hosts "
+            << to_milliseconds(hosts_elapsed) << "ms).";
+    }
+
     return result;
 }
 
@@ -332,7 +556,16 @@ bool p2p::close()
     const auto result = p2p::stop();
 
     // Block on join of all threads in the threadpool.
+    const auto start = steady_clock::now();
     threadpool_.join();
+
+    if (shards_)
+        shards_->join();
+
+    LOG_INFO(LOG_NETWORK)
+        << "Network threads joined in "
+        << to_milliseconds(steady_clock::now() - start) << "ms.";
+
     return result;
 }
 
@@ -384,9 +617,170 @@ threadpool& p2p::thread_pool()
     return threadpool_;
 }
 
+void p2p::set_loopback(loopback_hub::ptr hub)
+{
+    loopback_.store(hub);
+}
+
+loopback_hub::ptr p2p::loopback() const
+{
+    return loopback_.load();
+}
+
+dns_cache::ptr p2p::name_cache() const
+{
+    return name_cache_;
+}
+
+thread_shards::ptr p2p::channel_shards() const
+{
+    return shards_;
+}
+
+timer_wheel::ptr p2p::timers() const
+{
+    return timers_;
+}
+
+memory_budget::ptr p2p::buffer_budget() const
+{
+    return buffer_budget_;
+}
+
+token_bucket::ptr p2p::read_shaping() const
+{
+    return read_shaping_;
+}
+
+token_bucket::ptr p2p::write_shaping() const
+{
+    return write_shaping_;
+}
+
+blacklist::ptr p2p::address_blacklist() const
+{
+    return address_blacklist_;
+}
+
+traffic::ptr p2p::network_traffic() const
+{
+    return traffic_;
+}
+
+traffic::snapshot p2p::traffic_statistics() const
+{
+    return traffic_->collect();
+}
+
+std::vector<p2p::channel_traffic> p2p::channel_traffic_statistics() const
+{
+    const auto channels = pending_close_.snapshot();
+    std::vector<channel_traffic> out;
+    out.reserve(channels->size());
+
+    for (const auto& channel: *channels)
+        out.emplace_back(channel->authority(), channel->traffic_statistics());
+
+    return out;
+}
+
+frame_capture::ptr p2p::capture() const
+{
+    return capture_;
+}
+
+metrics::ptr p2p::connection_metrics() const
+{
+    return metrics_;
+}
+
+// Counters are reported as cumulative gauges, the server derives rates.
+statsd::gauges p2p::statistics() const
+{
+    statsd::gauges out
+    {
+        { "hosts", address_count() },
+        { "connections", connection_count() }
+    };
+
+    const auto sessions = metrics_->collect();
+
+    for (size_t index = 0; index < sessions.size(); ++index)
+    {
+        const auto& counts = sessions[index];
+        const auto name = "sessions." + metrics::to_string(
+            static_cast<metrics::session_type>(index)) + ".";
+
+        out.push_back({ name + "connected", counts.connected });
+        out.push_back({ name + "attempts", counts.attempts });
+        out.push_back({ name + "failures", counts.failures });
+        out.push_back({ name + "handshakes", counts.handshakes });
+        out.push_back({ name + "handshake_failures",
+            counts.handshake_failures });
+        out.push_back({ name + "handshake_microseconds",
+            counts.handshake_microseconds });
+    }
+
+    // Handshake durations are reported as 50th and 99th percentile bounds.
+    const auto add_histogram = [&out](const std::string& name,
+        const histogram::snapshot& values)
+    {
+        out.push_back({ name + "count", values.count });
+        out.push_back({ name + "microseconds", values.microseconds });
+        out.push_back({ name + "p50", histogram::percentile(values, 50) });
+        out.push_back({ name + "p99", histogram::percentile(values, 99) });
+    };
+
+    add_histogram("handshake.", metrics_->handshakes());
+    const auto stages = metrics_->stages();
+
+    for (size_t index = 0; index < stages.size(); ++index)
+        add_histogram("handshake." + handshake_trace::to_string(
+            static_cast<handshake_trace::stage>(index)) + ".", stages[index]);
+
+    const auto counts = traffic_->collect();
+    out.push_back({ "traffic.messages_in", counts.total.messages_in });
+    out.push_back({ "traffic.bytes_in", counts.total.bytes_in });
+    out.push_back({ "traffic.messages_out", counts.total.messages_out });
+    out.push_back({ "traffic.bytes_out", counts.total.bytes_out });
+    out.push_back({ "traffic.read_microseconds", counts.read_microseconds });
+    out.push_back({ "traffic.write_microseconds", counts.write_microseconds });
+    out.push_back({ "traffic.queued", counts.queued });
+
+    for (const auto& command: counts.commands)
+    {
+        const auto name = "commands." + command.command + ".";
+        out.push_back({ name + "messages_in", command.counts.messages_in });
+        out.push_back({ name + "bytes_in", command.counts.bytes_in });
+        out.push_back({ name + "messages_out", command.counts.messages_out });
+        out.push_back({ name + "bytes_out", command.counts.bytes_out });
+    }
+
+    return out;
+}
+
 // Send.
 // ----------------------------------------------------------------------------
 
+// Each channel serializes and writes its batch upon its own trickle.
+void p2p::announce(const message::inventory_vector::list& items)
+{
+    const auto channels = pending_close_.snapshot();
+
+    for (const auto channel: *channels)
+        channel->announce(items);
+}
+
+void p2p::announce(const message::inventory_vector::list& items,
+    uint64_t fee_rate)
+{
+    const auto channels = pending_close_.snapshot();
+
+    for (const auto channel: *channels)
+        if (channel->accepts_fee(fee_rate))
+            channel->announce(items);
+}
+
 // private
 void p2p::handle_send(const code& ec, channel::ptr channel,
     channel_handler handle_channel, result_handler handle_complete)
@@ -408,6 +802,11 @@ void p2p::subscribe_stop(result_handler handler)
     stop_subscriber_->subscribe(handler, error::service_stopped);
 }
 
+void p2p::subscribe_hosts(result_handler handler)
+{
+    hosts_subscriber_->subscribe(handler, error::service_stopped);
+}
+
 // Manual connections.
 // ----------------------------------------------------------------------------
 
@@ -453,13 +852,22 @@ size_t p2p::address_count() const
 
 code p2p::store(const address& address)
 {
-    return hosts_.store(address);
+    const auto ec = hosts_.store(address);
+
+    if (!ec)
+        hosts_subscriber_->relay(error::success);
+
+    return ec;
 }
 
 void p2p::store(const address::list& addresses, result_handler handler)
 {
     // Store is invoked on a new thread.
     hosts_.store(addresses, handler);
+
+    // Sessions awaiting addresses are woken by growth, rather than polling.
+    if (!addresses.empty())
+        hosts_subscriber_->relay(error::success);
 }
 
 code p2p::fetch_address(address& out_address) const
@@ -477,6 +885,21 @@ code p2p::remove(const address& address)
     return hosts_.remove(address);
 }
 
+code p2p::attempted(const address& address)
+{
+    return hosts_.attempted(address);
+}
+
+code p2p::succeeded(const address& address)
+{
+    return hosts_.succeeded(address);
+}
+
+code p2p::failed(const address& address)
+{
+    return hosts_.failed(address);
+}
+
 // Pending connect collection.
 // ----------------------------------------------------------------------------
 
@@ -496,7 +919,7 @@ void p2p::unpend(connector::ptr connector)
 
 code p2p::pend(channel::ptr channel)
 {
-    return pending_handshake_.store(channel);
+    return pending_handshake_.store(channel, false);
 }
 
 void p2p::unpend(channel::ptr channel)
@@ -506,12 +929,7 @@ void p2p::unpend(channel::ptr channel)
 
 bool p2p::pending(uint64_t version_nonce) const
 {
-    const auto match = [version_nonce](const channel::ptr& element)
-    {
-        return element->nonce() == version_nonce;
-    };
-
-    return pending_handshake_.exists(match);
+    return pending_handshake_.exists(version_nonce);
 }
 
 // Pending close collection (open connections).
@@ -524,24 +942,13 @@ size_t p2p::connection_count() const
 
 bool p2p::connected(const address& address) const
 {
-    const auto match = [&address](const channel::ptr& element)
-    {
-        return element->authority() == address;
-    };
-
-    return pending_close_.exists(match);
+    return pending_close_.exists(config::authority(address));
 }
 
 code p2p::store(channel::ptr channel)
 {
-    const auto address = channel->authority();
-    const auto match = [&address](const channel::ptr& element)
-    {
-        return element->authority() == address;
-    };
-
     // May return error::address_in_use.
-    const auto ec = pending_close_.store(channel, match);
+    const auto ec = pending_close_.store(channel, true);
 
     if (!ec && channel->notify())
         channel_subscriber_->relay(error::success, channel);
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/pooled_timer.hpp>
+
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/handler_memory.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::placeholders;
+
+pooled_timer::pooled_timer(threadpool& pool, const asio::duration& duration)
+  : duration_(duration),
+    timer_(pool.service())
+{
+}
+
+void pooled_timer::start(handler handle)
+{
+    start(handle, duration_);
+}
+
+// Setting the expiry cancels a pending wait, which completes with failure.
+void pooled_timer::start(handler handle, const asio::duration& duration)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    timer_.expires_after(duration);
+
+    // async_wait will not invoke the handler within this function.
+    timer_.async_wait(make_allocating(memory_,
+        std::bind(&pooled_timer::handle_timer,
+            shared_from_this(), _1, handle)));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_timer::stop()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // A failure to cancel is of no consequence, the wait then completes.
+    boost_code ignore;
+    timer_.cancel(ignore);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_timer::handle_timer(const boost_code& ec, handler handle) const
+{
+    handle(error::boost_to_error_code(ec));
+}
+
+} // namespace network
+} // namespace libbitcoin
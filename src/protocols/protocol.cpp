@@ -33,7 +33,8 @@ protocol::protocol(p2p& network, channel::ptr channel, const std::string& name)
   : pool_(network.thread_pool()),
     dispatch_(network.thread_pool(), NAME),
     channel_(channel),
-    name_(name)
+    name_(name),
+    verbose_(network.network_settings().verbose)
 {
 }
 
@@ -47,6 +48,11 @@ const std::string& protocol::name() const
     return name_;
 }
 
+bool protocol::verbose() const
+{
+    return verbose_;
+}
+
 uint64_t protocol::nonce() const
 {
     return channel_->nonce();
@@ -72,6 +78,16 @@ void protocol::set_negotiated_version(uint32_t value)
     channel_->set_negotiated_version(value);
 }
 
+void protocol::record_round_trip(const asio::duration& value)
+{
+    channel_->record_round_trip(value);
+}
+
+void protocol::record_stage(handshake_trace::stage value)
+{
+    channel_->trace().record(value);
+}
+
 threadpool& protocol::pool()
 {
     return pool_;
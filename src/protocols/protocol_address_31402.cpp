@@ -18,6 +18,8 @@
  */
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
 
+#include <cstdint>
+#include <ctime>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
@@ -43,6 +45,32 @@ static message::address configured_self(const network::settings& settings)
     return address{ { settings.self.to_network_address() } };
 }
 
+// Gossiped timestamps are unverified, so they are aged by a penalty and
+// implausible values are replaced by one that is old but not yet stale.
+static const uint32_t timestamp_penalty = 2 * 60 * 60;
+static const uint32_t future_tolerance = 10 * 60;
+static const uint32_t minimum_timestamp = 100000000;
+static const uint32_t implausible_age = 5 * 24 * 60 * 60;
+
+static network_address::list timestamped(const network_address::list& hosts)
+{
+    const auto now = static_cast<uint32_t>(std::time(nullptr));
+    auto out = hosts;
+
+    for (auto& host: out)
+    {
+        const auto timestamp = host.timestamp();
+
+        if (timestamp <= minimum_timestamp ||
+            timestamp > now + future_tolerance)
+            host.set_timestamp(now - implausible_age);
+        else if (timestamp > timestamp_penalty)
+            host.set_timestamp(timestamp - timestamp_penalty);
+    }
+
+    return out;
+}
+
 protocol_address_31402::protocol_address_31402(p2p& network,
     channel::ptr channel)
   : protocol_events(network, channel, NAME),
@@ -89,8 +117,8 @@ bool protocol_address_31402::handle_receive_address(const code& ec,
         << "Storing addresses from [" << authority() << "] ("
         << message->addresses().size() << ")";
 
-    // TODO: manage timestamps (active channels are connected < 3 hours ago).
-    network_.store(message->addresses(), BIND1(handle_store_addresses, _1));
+    network_.store(timestamped(message->addresses()),
+        BIND1(handle_store_addresses, _1));
 
     // RESUBSCRIBE
     return true;
@@ -112,7 +140,7 @@ bool protocol_address_31402::handle_receive_get_address(const code& ec,
 
         LOG_DEBUG(LOG_NETWORK)
             << "Sending addresses to [" << authority() << "] ("
-            << self_.addresses().size() << ")";
+            << addresses.size() << ")";
     }
 
     // do not resubscribe; one response per connection permitted
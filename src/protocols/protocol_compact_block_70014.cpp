@@ -0,0 +1,521 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/protocols/protocol_compact_block_70014.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_events.hpp>
+#include <bitcoin/network/short_id.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "compact_block"
+#define CLASS protocol_compact_block_70014
+
+using namespace bc::message;
+using namespace std::placeholders;
+
+// Compact block versions, the second identifies transactions by witness hash.
+static const uint64_t legacy_version = 1;
+static const uint64_t witness_version = 2;
+
+// Reconstructions awaiting transactions, the oldest is dropped beyond this.
+static const size_t maximum_pending = 8;
+
+// A compact block claiming more transactions than this is invalid.
+static const size_t maximum_transactions = 100000;
+
+protocol_compact_block_70014::protocol_compact_block_70014(p2p& network,
+    channel::ptr channel, bool high_bandwidth)
+  : protocol_events(network, channel, NAME),
+    high_bandwidth_(high_bandwidth),
+    own_witness_((network.network_settings().services &
+        version::service::node_witness) != 0),
+    version_(0),
+    peer_high_bandwidth_(false),
+    CONSTRUCT_TRACK(protocol_compact_block_70014)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+// Supported versions are sent in order of preference.
+void protocol_compact_block_70014::start()
+{
+    protocol_events::start();
+
+    SUBSCRIBE2(send_compact, handle_receive_send_compact, _1, _2);
+    SUBSCRIBE2(compact_block, handle_receive_compact_block, _1, _2);
+    SUBSCRIBE2(get_block_transactions, handle_receive_get_block_transactions,
+        _1, _2);
+    SUBSCRIBE2(block_transactions, handle_receive_block_transactions, _1, _2);
+
+    if (own_witness_)
+        SEND2((send_compact{ high_bandwidth_, witness_version }), handle_send,
+            _1, send_compact::command);
+
+    SEND2((send_compact{ high_bandwidth_, legacy_version }), handle_send, _1,
+        send_compact::command);
+}
+
+// Negotiation.
+// ----------------------------------------------------------------------------
+
+bool protocol_compact_block_70014::witness() const
+{
+    return version_ == witness_version;
+}
+
+// The highest version supported by both is used, and the latest mode of
+// that version applies.
+bool protocol_compact_block_70014::handle_receive_send_compact(
+    const code& ec, send_compact_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure receiving send_compact from [" << authority() << "] "
+            << ec.message();
+        stop(error::channel_stopped);
+        return false;
+    }
+
+    const auto version = message->version();
+
+    if (version != legacy_version &&
+        !(version == witness_version && own_witness_))
+        return true;
+
+    if (version < version_)
+        return true;
+
+    version_ = version;
+    peer_high_bandwidth_ = message->high_bandwidth_mode();
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Compact blocks version " << version << " ("
+        << (peer_high_bandwidth_ ? "high" : "low") << " bandwidth) for ["
+        << authority() << "]";
+    return true;
+}
+
+// Outbound.
+// ----------------------------------------------------------------------------
+
+// static
+message::compact_block protocol_compact_block_70014::to_compact_block(
+    const message::block& block, uint64_t nonce, bool witness)
+{
+    const auto& transactions = block.transactions();
+    const auto key = short_id::to_key(block.header(), nonce);
+
+    compact_block::short_id_list ids;
+    prefilled_transaction::list prefilled;
+
+    if (!transactions.empty())
+    {
+        prefilled.emplace_back(0, transactions.front());
+        ids.reserve(transactions.size() - 1);
+
+        for (auto tx = std::next(transactions.begin());
+            tx != transactions.end(); ++tx)
+            ids.push_back(short_id::to_mini_hash(short_id::compute(key,
+                tx->hash(witness))));
+    }
+
+    return compact_block(block.header(), nonce, ids, prefilled);
+}
+
+// static
+// Wire indexes are differentially encoded, each relative to the prior plus
+// one, which the message types do not decode.
+std::vector<uint64_t> protocol_compact_block_70014::to_differential(
+    const std::vector<uint64_t>& indexes)
+{
+    std::vector<uint64_t> out;
+    out.reserve(indexes.size());
+    uint64_t next = 0;
+
+    for (const auto index: indexes)
+    {
+        out.push_back(index - next);
+        next = index + 1;
+    }
+
+    return out;
+}
+
+// static
+// The offset is bounded by the count before it is summed, so cannot wrap.
+bool protocol_compact_block_70014::to_absolute(std::vector<uint64_t>& out,
+    const std::vector<uint64_t>& differential, size_t count)
+{
+    out.clear();
+    out.reserve(differential.size());
+    uint64_t next = 0;
+
+    for (const auto offset: differential)
+    {
+        if (offset >= count || next + offset >= count)
+            return false;
+
+        out.push_back(next + offset);
+        next += offset + 1;
+    }
+
+    return true;
+}
+
+bool protocol_compact_block_70014::announce(block_const_ptr block)
+{
+    if (version_ == 0 || !peer_high_bandwidth_)
+        return false;
+
+    const auto compact = to_compact_block(*block, pseudo_random::next(),
+        witness());
+
+    SEND2(compact, handle_send, _1, compact_block::command);
+    return true;
+}
+
+bool protocol_compact_block_70014::handle_receive_get_block_transactions(
+    const code& ec, get_block_transactions_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure receiving get_block_transactions from ["
+            << authority() << "] " << ec.message();
+        stop(error::channel_stopped);
+        return false;
+    }
+
+    const auto block = fetch_block(message->block_hash());
+
+    // A block we do not have (or no longer have) is not an error.
+    if (!block)
+        return true;
+
+    const auto& transactions = block->transactions();
+    std::vector<uint64_t> indexes;
+
+    if (!to_absolute(indexes, message->indexes(), transactions.size()))
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Invalid transaction index requested by [" << authority()
+            << "]";
+        stop(error::bad_stream);
+        return false;
+    }
+
+    chain::transaction::list requested;
+    requested.reserve(indexes.size());
+
+    for (const auto index: indexes)
+        requested.push_back(transactions[index]);
+
+    SEND2((block_transactions{ message->block_hash(), requested }),
+        handle_send, _1, block_transactions::command);
+    return true;
+}
+
+// Inbound.
+// ----------------------------------------------------------------------------
+
+// static
+// Slots not prefilled are matched to pooled transactions by short id. A
+// short id shared by two slots, or matched by more than one pooled
+// transaction, is ambiguous and so its slots are requested.
+bool protocol_compact_block_70014::populate(chain::transaction::list& out,
+    std::vector<uint64_t>& missing, const message::compact_block& block,
+    bool witness, const source& pooled)
+{
+    const auto& ids = block.short_ids();
+    const auto& prefilled = block.transactions();
+    const auto count = ids.size() + prefilled.size();
+
+    if (count == 0 || count > maximum_transactions)
+        return false;
+
+    out.assign(count, chain::transaction{});
+    missing.clear();
+    std::vector<bool> filled(count, false);
+    uint64_t next = 0;
+
+    for (const auto& item: prefilled)
+    {
+        const auto offset = item.index();
+
+        if (offset >= count || next + offset >= count)
+            return false;
+
+        const auto index = next + offset;
+        out[index] = item.transaction();
+        filled[index] = true;
+        next = index + 1;
+    }
+
+    std::unordered_map<uint64_t, size_t> slots;
+    slots.reserve(ids.size());
+    std::vector<bool> matched(count, false);
+    std::vector<bool> ambiguous(count, false);
+    auto id = ids.begin();
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (filled[index])
+            continue;
+
+        // Prefilled indexes are distinct, so there is an id for each slot.
+        const auto slot = slots.emplace(short_id::to_number(*id++), index);
+
+        if (!slot.second)
+        {
+            ambiguous[slot.first->second] = true;
+            ambiguous[index] = true;
+        }
+    }
+
+    const auto key = short_id::to_key(block.header(), block.nonce());
+
+    pooled([&](const chain::transaction& tx)
+    {
+        const auto slot = slots.find(short_id::compute(key,
+            tx.hash(witness)));
+
+        if (slot == slots.end() || ambiguous[slot->second])
+            return;
+
+        if (matched[slot->second])
+        {
+            ambiguous[slot->second] = true;
+            return;
+        }
+
+        matched[slot->second] = true;
+        out[slot->second] = tx;
+    });
+
+    for (size_t index = 0; index < count; ++index)
+        if (!filled[index] && (!matched[index] || ambiguous[index]))
+            missing.push_back(index);
+
+    return true;
+}
+
+bool protocol_compact_block_70014::handle_receive_compact_block(
+    const code& ec, compact_block_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure receiving compact_block from [" << authority() << "] "
+            << ec.message();
+        stop(error::channel_stopped);
+        return false;
+    }
+
+    // The pool is visited within this call, not retained.
+    const auto pooled = [this](const visitor& visit)
+    {
+        visit_pooled(visit);
+    };
+
+    const auto& header = message->header();
+    chain::transaction::list transactions;
+    std::vector<uint64_t> missing;
+
+    if (!populate(transactions, missing, *message, witness(), pooled))
+    {
+        stop(error::bad_stream);
+        return false;
+    }
+
+    if (missing.empty())
+    {
+        complete(header, std::move(transactions));
+        return true;
+    }
+
+    const auto count = transactions.size();
+    const auto hash = header.hash();
+    const auto request = to_differential(missing);
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Requesting " << missing.size() << " of " << count
+        << " transactions of compact block [" << encode_hash(hash)
+        << "] from [" << authority() << "]";
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    // A repeated block replaces its reconstruction, without eviction.
+    if (pending_.find(hash) == pending_.end())
+    {
+        if (pending_.size() >= maximum_pending)
+        {
+            pending_.erase(order_.front());
+            order_.pop_front();
+        }
+
+        order_.push_back(hash);
+    }
+
+    pending_[hash] = { header, std::move(transactions), std::move(missing) };
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    SEND2((get_block_transactions{ hash, request }), handle_send, _1,
+        get_block_transactions::command);
+    return true;
+}
+
+bool protocol_compact_block_70014::handle_receive_block_transactions(
+    const code& ec, block_transactions_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure receiving block_transactions from [" << authority()
+            << "] " << ec.message();
+        stop(error::channel_stopped);
+        return false;
+    }
+
+    reconstruction state;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    const auto it = pending_.find(message->block_hash());
+    const auto found = (it != pending_.end());
+
+    if (found)
+    {
+        state = std::move(it->second);
+        pending_.erase(it);
+        order_.erase(std::find(order_.begin(), order_.end(),
+            message->block_hash()));
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // An unrequested (or superseded) response is ignored.
+    if (!found)
+        return true;
+
+    const auto& received = message->transactions();
+
+    if (received.size() != state.missing.size())
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Incomplete block transactions from [" << authority() << "]";
+        stop(error::bad_stream);
+        return false;
+    }
+
+    for (size_t index = 0; index < received.size(); ++index)
+        state.transactions[state.missing[index]] = received[index];
+
+    complete(state.header, std::move(state.transactions));
+    return true;
+}
+
+// private
+// A short id collision with an unrelated pooled transaction is detected by
+// the merkle root, and then the full block is requested.
+void protocol_compact_block_70014::complete(const chain::header& header,
+    chain::transaction::list&& transactions)
+{
+    const auto block = std::make_shared<const message::block>(header,
+        std::move(transactions));
+
+    if (block->generate_merkle_root() != header.merkle())
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Compact block [" << encode_hash(header.hash())
+            << "] failed reconstruction from [" << authority() << "]";
+        request_block(header.hash());
+        return;
+    }
+
+    handle_reconstructed(block);
+}
+
+// private
+void protocol_compact_block_70014::request_block(const hash_digest& hash)
+{
+    const auto type = witness() ? inventory_vector::type_id::witness_block :
+        inventory_vector::type_id::block;
+
+    const get_data request(hash_list{ hash }, type);
+    SEND2(request, handle_send, _1, get_data::command);
+}
+
+// Derived protocol hooks.
+// ----------------------------------------------------------------------------
+
+void protocol_compact_block_70014::visit_pooled(const visitor&) const
+{
+}
+
+block_const_ptr protocol_compact_block_70014::fetch_block(
+    const hash_digest&) const
+{
+    return {};
+}
+
+void protocol_compact_block_70014::handle_reconstructed(block_const_ptr block)
+{
+    LOG_DEBUG(LOG_NETWORK)
+        << "Reconstructed compact block [" << encode_hash(
+            block->header().hash()) << "] from [" << authority() << "]";
+}
+
+} // namespace network
+} // namespace libbitcoin
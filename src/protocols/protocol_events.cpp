@@ -76,7 +76,7 @@ void protocol_events::handle_stopped(const code& ec)
 {
     if (!stopped(ec))
     {
-        LOG_VERBOSE(LOG_NETWORK)
+        LOG_NETWORK_VERBOSE(verbose())
             << "Stop protocol_" << name() << " on [" << authority() << "] "
             << ec.message();
     }
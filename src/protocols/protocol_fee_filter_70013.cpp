@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/protocols/protocol_fee_filter_70013.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_events.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "fee_filter"
+#define CLASS protocol_fee_filter_70013
+
+using namespace bc::message;
+using namespace std::placeholders;
+
+protocol_fee_filter_70013::protocol_fee_filter_70013(p2p& network,
+    channel::ptr channel)
+  : protocol_events(network, channel, NAME),
+    channel_(channel),
+    minimum_fee_rate_(network.network_settings().minimum_fee_rate),
+    relay_(network.network_settings().relay_transactions),
+    CONSTRUCT_TRACK(protocol_fee_filter_70013)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+// A node that does not relay has already asked the peer for no transactions.
+void protocol_fee_filter_70013::start()
+{
+    protocol_events::start();
+
+    SUBSCRIBE2(fee_filter, handle_receive_fee_filter, _1, _2);
+
+    if (relay_ && minimum_fee_rate_ != 0)
+        SEND2(fee_filter{ minimum_fee_rate_ }, handle_send, _1,
+            fee_filter::command);
+}
+
+// Protocol.
+// ----------------------------------------------------------------------------
+
+// The filter may be changed by the peer at any time.
+bool protocol_fee_filter_70013::handle_receive_fee_filter(const code& ec,
+    fee_filter_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure receiving fee_filter from [" << authority() << "] "
+            << ec.message();
+        stop(error::channel_stopped);
+        return false;
+    }
+
+    const auto rate = message->minimum_fee();
+    channel_->set_fee_filter(rate);
+
+    LOG_NETWORK_VERBOSE(verbose())
+        << "Fee filter of " << rate << " satoshis per kilobyte from ["
+        << authority() << "]";
+    return true;
+}
+
+} // namespace network
+} // namespace libbitcoin
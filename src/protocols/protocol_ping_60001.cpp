@@ -18,8 +18,11 @@
  */
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <string>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
@@ -36,13 +39,40 @@ namespace network {
 using namespace bc::message;
 using namespace std::placeholders;
 
+// A peer is dropped once this many pings are outstanding at a heartbeat.
+static constexpr size_t maximum_outstanding = 3;
+
 protocol_ping_60001::protocol_ping_60001(p2p& network, channel::ptr channel)
   : protocol_ping_31402(network, channel),
-    pending_(false),
     CONSTRUCT_TRACK(protocol_ping_60001)
 {
 }
 
+// static
+bool protocol_ping_60001::match(sent_pings& outstanding, uint64_t nonce,
+    clock::time_point& sent)
+{
+    const auto it = std::find_if(outstanding.begin(), outstanding.end(),
+        [nonce](const sent_ping& ping)
+        {
+            return ping.first == nonce;
+        });
+
+    if (it == outstanding.end())
+        return false;
+
+    sent = it->second;
+    outstanding.erase(outstanding.begin(), std::next(it));
+    return true;
+}
+
+// Pongs are matched to outstanding pings by nonce, under one subscription.
+void protocol_ping_60001::start()
+{
+    SUBSCRIBE2(pong, handle_receive_pong, _1, _2);
+    protocol_ping_31402::start();
+}
+
 // This is fired by the callback (i.e. base timer and stop handler).
 void protocol_ping_60001::send_ping(const code& ec)
 {
@@ -58,17 +88,30 @@ void protocol_ping_60001::send_ping(const code& ec)
         return;
     }
 
-    if (pending_)
+    const auto nonce = pseudo_random::next();
+    size_t outstanding;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    outstanding = outstanding_.size();
+
+    if (outstanding < maximum_outstanding)
+        outstanding_.emplace_back(nonce, clock::now());
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (outstanding >= maximum_outstanding)
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Ping latency limit exceeded [" << authority() << "]";
+            << "Ping latency limit exceeded [" << authority() << "] ("
+            << outstanding << " outstanding)";
         stop(error::channel_timeout);
         return;
     }
 
-    pending_ = true;
-    const auto nonce = pseudo_random::next();
-    SUBSCRIBE3(pong, handle_receive_pong, _1, _2, nonce);
     SEND2(ping{ nonce }, handle_send_ping, _1, ping::command);
 }
 
@@ -107,7 +150,7 @@ bool protocol_ping_60001::handle_receive_ping(const code& ec,
 }
 
 bool protocol_ping_60001::handle_receive_pong(const code& ec,
-    pong_const_ptr message, uint64_t nonce)
+    pong_const_ptr message)
 {
     if (stopped(ec))
         return false;
@@ -121,17 +164,36 @@ bool protocol_ping_60001::handle_receive_pong(const code& ec,
         return false;
     }
 
-    pending_ = false;
+    const auto now = clock::now();
+    clock::time_point sent;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    const auto found = match(outstanding_, message->nonce(), sent);
 
-    if (message->nonce() != nonce)
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // An unsolicited or late pong is ignored.
+    if (!found)
     {
-        LOG_WARNING(LOG_NETWORK)
-            << "Invalid pong nonce from [" << authority() << "]";
-        stop(error::bad_stream);
-        return false;
+        LOG_DEBUG(LOG_NETWORK)
+            << "Unmatched pong nonce from [" << authority() << "]";
+        return true;
     }
 
-    return false;
+    const auto round_trip = std::chrono::duration_cast<asio::duration>(
+        now - sent);
+    record_round_trip(round_trip);
+
+    LOG_NETWORK_VERBOSE(verbose())
+        << "Ping round trip to [" << authority() << "] "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(
+            round_trip).count() << "ms";
+
+    return true;
 }
 
 } // namespace network
@@ -35,7 +35,8 @@ using namespace std::placeholders;
 protocol_timer::protocol_timer(p2p& network, channel::ptr channel,
     bool perpetual, const std::string& name)
   : protocol_events(network, channel, name),
-    perpetual_(perpetual)
+    perpetual_(perpetual),
+    timers_(network.timers())
 {
 }
 
@@ -46,8 +47,12 @@ protocol_timer::protocol_timer(p2p& network, channel::ptr channel,
 void protocol_timer::start(const asio::duration& timeout,
     event_handler handle_event)
 {
-    // The deadline timer is thread safe.
-    timer_ = std::make_shared<deadline>(pool(), timeout);
+    // The deadline timer is thread safe, the wheel replaces it if enabled.
+    timeout_ = timeout;
+
+    if (!timers_)
+        timer_ = std::make_shared<deadline>(pool(), timeout);
+
     protocol_events::start(BIND2(handle_notify, _1, handle_event));
     reset_timer();
 }
@@ -55,7 +60,7 @@ void protocol_timer::start(const asio::duration& timeout,
 void protocol_timer::handle_notify(const code& ec, event_handler handler)
 {
     if (ec == error::channel_stopped)
-        timer_->stop();
+        stop_timer();
 
     handler(ec);
 }
@@ -69,7 +74,32 @@ void protocol_timer::reset_timer()
     if (stopped())
         return;
 
-    timer_->start(BIND1(handle_timer, _1));
+    if (!timers_)
+    {
+        timer_->start(BIND1(handle_timer, _1));
+        return;
+    }
+
+    // A reset replaces the scheduled timer.
+    const auto prior = wheel_timer_.load();
+    wheel_timer_.store(timers_->schedule(timeout_, BIND1(handle_timer, _1)));
+
+    if (prior)
+        timers_->cancel(prior);
+}
+
+void protocol_timer::stop_timer()
+{
+    if (!timers_)
+    {
+        timer_->stop();
+        return;
+    }
+
+    const auto timer = wheel_timer_.load();
+
+    if (timer)
+        timers_->cancel(timer);
 }
 
 void protocol_timer::handle_timer(const code& ec)
@@ -77,7 +107,7 @@ void protocol_timer::handle_timer(const code& ec)
     if (stopped())
         return;
 
-    LOG_VERBOSE(LOG_NETWORK)
+    LOG_NETWORK_VERBOSE(verbose())
         << "Fired protocol_" << name() << " timer on [" << authority() << "] "
         << ec.message();
 
@@ -18,6 +18,8 @@
  */
 #include <bitcoin/network/protocols/protocol_version_31402.hpp>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
@@ -36,6 +38,9 @@ namespace network {
 using namespace bc::message;
 using namespace std::placeholders;
 
+// The handshake is complete upon receipt of both version and verack.
+static const size_t events_required = 2;
+
 // TODO: set explicitly on inbound (none or new config) and self on outbound.
 // Require the configured minimum and services by default.
 // Configured min version is our own but we may require higer for some stuff.
@@ -64,6 +69,8 @@ protocol_version_31402::protocol_version_31402(p2p& network,
     invalid_services_(invalid_services),
     minimum_version_(minimum_version),
     minimum_services_(minimum_services),
+    received_(0),
+    complete_(false),
     CONSTRUCT_TRACK(protocol_version_31402)
 {
 }
@@ -71,19 +78,73 @@ protocol_version_31402::protocol_version_31402(p2p& network,
 // Start sequence.
 // ----------------------------------------------------------------------------
 
+// Version and verack are invoked on the read loop (by default dispatch), so
+// the peer version is validated and our verack written without a thread hop.
+// An invalid configuration fails before the version is sent.
 void protocol_version_31402::start(event_handler handler)
 {
-    const auto period = network_.network_settings().channel_handshake();
+    if (!sufficient_configuration())
+    {
+        handler(error::channel_stopped);
+        return;
+    }
 
-    const auto join_handler = synchronize(handler, 2, NAME,
-        synchronizer_terminate::on_error);
+    const auto period = network_.network_settings().channel_handshake();
 
     // The handler is invoked in the context of the last message receipt.
-    protocol_timer::start(period, join_handler);
+    protocol_timer::start(period, BIND2(handle_event, _1, handler));
 
     SUBSCRIBE2(version, handle_receive_version, _1, _2);
     SUBSCRIBE2(verack, handle_receive_verack, _1, _2);
-    SEND2(version_factory(), handle_send, _1, version::command);
+    SEND1(version_factory(), handle_send_version, _1);
+}
+
+// The first failure or the last required message completes the handshake,
+// which then cancels its timer rather than leaving it to expire.
+void protocol_version_31402::handle_event(const code& ec,
+    event_handler handler)
+{
+    if (!ec && ++received_ < events_required)
+        return;
+
+    if (complete_.exchange(true))
+        return;
+
+    if (!ec)
+        stop_timer();
+
+    handler(ec);
+}
+
+bool protocol_version_31402::sufficient_configuration() const
+{
+    const auto& settings = network_.network_settings();
+
+    if (settings.protocol_minimum < version::level::minimum)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Invalid protocol version configuration, minimum below ("
+            << version::level::minimum << ").";
+        return false;
+    }
+
+    if (settings.protocol_maximum > version::level::maximum)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Invalid protocol version configuration, maximum above ("
+            << version::level::maximum << ").";
+        return false;
+    }
+
+    if (settings.protocol_minimum > settings.protocol_maximum)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Invalid protocol version configuration, "
+            << "minimum exceeds maximum.";
+        return false;
+    }
+
+    return true;
 }
 
 message::version protocol_version_31402::version_factory() const
@@ -113,6 +174,12 @@ message::version protocol_version_31402::version_factory() const
 // Protocol.
 // ----------------------------------------------------------------------------
 
+void protocol_version_31402::handle_send_version(const code& ec)
+{
+    if (!ec)
+        record_stage(handshake_trace::stage::version_sent);
+}
+
 bool protocol_version_31402::handle_receive_version(const code& ec,
     version_const_ptr message)
 {
@@ -128,44 +195,12 @@ bool protocol_version_31402::handle_receive_version(const code& ec,
         return false;
     }
 
+    record_stage(handshake_trace::stage::version_received);
+
     LOG_DEBUG(LOG_NETWORK)
         << "Peer [" << authority() << "] protocol version ("
         << message->value() << ") user agent: " << message->user_agent();
 
-    // TODO: move these three checks to initialization.
-    //-------------------------------------------------------------------------
-
-    const auto& settings = network_.network_settings();
-
-    if (settings.protocol_minimum < version::level::minimum)
-    {
-        LOG_ERROR(LOG_NETWORK)
-            << "Invalid protocol version configuration, minimum below ("
-            << version::level::minimum << ").";
-        set_event(error::channel_stopped);
-        return false;
-    }
-
-    if (settings.protocol_maximum > version::level::maximum)
-    {
-        LOG_ERROR(LOG_NETWORK)
-            << "Invalid protocol version configuration, maximum above ("
-            << version::level::maximum << ").";
-        set_event(error::channel_stopped);
-        return false;
-    }
-
-    if (settings.protocol_minimum > settings.protocol_maximum)
-    {
-        LOG_ERROR(LOG_NETWORK)
-            << "Invalid protocol version configuration, "
-            << "minimum exceeds maximum.";
-        set_event(error::channel_stopped);
-        return false;
-    }
-
-    //-------------------------------------------------------------------------
-
     if (!sufficient_peer(message))
     {
         set_event(error::channel_stopped);
@@ -231,6 +266,8 @@ bool protocol_version_31402::handle_receive_verack(const code& ec,
         return false;
     }
 
+    record_stage(handshake_trace::stage::verack_received);
+
     // 2 of 2
     set_event(error::success);
     return false;
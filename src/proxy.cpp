@@ -21,15 +21,20 @@
 #define BOOST_BIND_NO_PLACEHOLDERS
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/handler_memory.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/slab.hpp>
+#include <bitcoin/network/tcp_transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -43,30 +48,78 @@ using namespace bc::message;
 // Dump up to 1k of payload as hex in order to diagnose failure.
 static const size_t invalid_payload_dump_size = 1024;
 
-// payload_buffer_ sizing assumes monotonically increasing size by version.
-// Initialize to pre-witness max payload and let grow to witness as required.
-// The socket owns the single thread on which this channel reads and writes.
+// Send buffers are retained for messages up to 256k (e.g. headers, inv).
+static const size_t send_buffer_count = 4;
+static const size_t send_buffer_limit = 256 * 1024;
+
+// Bulk messages are gathered into a write up to this size (at least one).
+static const size_t bulk_write_limit = 256 * 1024;
+
+// The read buffer grows as required by a frame, to at most the maximum frame,
+// and shrinks back to this size once the buffered data fits within it.
+static const size_t minimum_read_buffer = 16 * 1024;
+
+// A block payload of this size or more may be decoded as it is read, in reads
+// of at most the step size, so that each read is followed by decoding.
+static const size_t progressive_minimum = 256 * 1024;
+static const size_t progressive_step = 64 * 1024;
+
+// Buffer growth is retried at this interval while the budget is exhausted.
+static const asio::duration throttle_interval = asio::milliseconds(100);
+
+// The strand serializes this channel's reads, writes and timer completions.
 proxy::proxy(threadpool& pool, socket::ptr socket, const settings& settings)
-  : authority_(socket->authority()),
-    heading_buffer_(heading::maximum_size()),
-    payload_buffer_(heading::maximum_payload_size(settings.protocol_maximum, false)),
-    maximum_payload_(heading::maximum_payload_size(settings.protocol_maximum,
-        (settings.services & version::service::node_witness) != 0)),
-    socket_(socket),
+  : proxy(pool, make_pooled<tcp_transport>(socket), settings)
+{
+}
+
+proxy::proxy(threadpool& pool, transport::ptr transport,
+    const settings& settings)
+  : pool_(pool),
+    authority_(transport->authority()),
+    strand_(pool.service()),
+    read_buffer_(minimum_read_buffer),
+    read_begin_(0),
+    read_end_(0),
+    read_reserve_(0),
+    transport_(transport),
+    capture_channel_(0),
+    pending_messages_(0),
+    pending_bytes_(0),
+    paused_(false),
+    read_resume_(),
+    read_deferral_(pool.service()),
+    writing_(false),
+    write_deferral_(pool.service()),
     stopped_(true),
     protocol_magic_(settings.identifier),
+    maximum_payload_(heading::maximum_payload_size(settings.protocol_maximum,
+        (settings.services & version::service::node_witness) != 0)),
     validate_checksum_(settings.validate_checksum),
+    progressive_decoding_(settings.progressive_decoding),
     verbose_(settings.verbose),
+    pending_messages_limit_(settings.channel_pending_messages),
+    pending_bytes_limit_(settings.channel_pending_bytes),
+    channel_read_rate_(1024.0 * settings.channel_read_kilobytes_per_second),
+    channel_write_rate_(1024.0 * settings.channel_write_kilobytes_per_second),
     version_(settings.protocol_maximum),
+    buffers_(send_buffer_count, send_buffer_limit),
     message_subscriber_(pool),
-    stop_subscriber_(std::make_shared<stop_subscriber>(pool, NAME "_sub")),
-    dispatch_(pool, NAME "_dispatch")
+    stop_subscriber_(std::make_shared<stop_subscriber>(pool, NAME "_sub"))
 {
+    message_subscriber_.set_dispatch(settings.message_dispatch);
 }
 
 proxy::~proxy()
 {
     BITCOIN_ASSERT_MSG(stopped(), "The channel was not stopped.");
+
+    if (budget_)
+        budget_->release(read_buffer_.size());
+
+    // Any frame recorded since the stop is submitted for capture.
+    if (capture_)
+        capture_->submit(capture_buffer_);
 }
 
 // Properties.
@@ -87,6 +140,53 @@ void proxy::set_negotiated_version(uint32_t value)
     version_.store(value);
 }
 
+void proxy::set_dispatch(const dispatch_policy& policy)
+{
+    message_subscriber_.set_dispatch(policy);
+}
+
+// The minimal buffer is accounted but never refused.
+void proxy::set_budget(memory_budget::ptr budget)
+{
+    if (budget_)
+        budget_->release(read_buffer_.size());
+
+    budget_ = budget;
+
+    if (budget_)
+        budget_->acquire(read_buffer_.size());
+}
+
+// The aggregate is shared by all channels and counted with this channel.
+void proxy::set_traffic(traffic::ptr aggregate)
+{
+    network_traffic_ = aggregate;
+}
+
+// The capture is shared by all channels, each under its own identifier.
+void proxy::set_capture(frame_capture::ptr capture)
+{
+    capture_ = capture;
+    capture_channel_ = capture_ ? capture_->next_channel() : 0;
+}
+
+// The shared limits apply to all shaped channels, each also has its own.
+// A bucket holds one second of its rate, which is the permitted burst.
+void proxy::set_shaping(token_bucket::ptr read, token_bucket::ptr write)
+{
+    read_shaping_ = read;
+    write_shaping_ = write;
+    channel_read_shaping_ = std::make_shared<token_bucket>(
+        channel_read_rate_, channel_read_rate_);
+    channel_write_shaping_ = std::make_shared<token_bucket>(
+        channel_write_rate_, channel_write_rate_);
+}
+
+traffic::snapshot proxy::traffic_statistics() const
+{
+    return traffic_.collect();
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
@@ -105,8 +205,21 @@ void proxy::start(result_handler handler)
     // Allow for subscription before first read, so no messages are missed.
     handler(error::success);
 
-    // Start the read cycle.
-    read_heading();
+    // Start the read cycle on the strand.
+    boost::asio::post(strand_,
+        std::bind(&proxy::read_more,
+            shared_from_this(), heading::satoshi_fixed_size()));
+}
+
+// The handler is dispatched, so it is invoked inline if on the strand.
+proxy::result_handler proxy::stranded(result_handler handler)
+{
+    const auto self = shared_from_this();
+
+    return [self, handler](const code& ec)
+    {
+        boost::asio::dispatch(self->strand_, std::bind(handler, ec));
+    };
 }
 
 // Stop subscription.
@@ -119,79 +232,118 @@ void proxy::subscribe_stop(result_handler handler)
 
 // Read cycle (read continues until stop).
 // ----------------------------------------------------------------------------
-
-void proxy::read_heading()
+// Each read obtains as many bytes as are available (at least those required
+// to complete the pending frame) and all complete frames are then parsed from
+// the buffer before the next read. Small messages therefore arrive in batches
+// with one read each, while a large payload is completed by a sized read.
+// Parsing pauses while the messages pending with subscribers exceed the
+// channel budget (count or bytes), and resumes as they are released.
+// Reads of a shaped channel also pause while a read rate limit is overdrawn.
+// A large block payload may instead be read in steps, each followed by the
+// decoding of its complete transactions, with the buffer sized to the frame.
+
+void proxy::read_more(size_t required)
 {
     if (stopped())
         return;
 
-    async_read(socket_->get(), buffer(heading_buffer_),
-        std::bind(&proxy::handle_read_heading,
-            shared_from_this(), _1, _2));
-}
-
-void proxy::handle_read_heading(const boost_code& ec, size_t)
-{
-    if (stopped())
-        return;
+    // The read cycle pauses while a read rate limit is overdrawn.
+    const auto now = std::chrono::steady_clock::now();
 
-    if (ec)
+    if (now < read_resume_)
     {
-        LOG_DEBUG(LOG_NETWORK)
-            << "Heading read failure [" << authority() << "] "
-            << code(error::boost_to_error_code(ec)).message();
-        stop(ec);
+        defer_read(required, read_resume_ - now);
         return;
     }
 
-    const auto head = heading::factory(heading_buffer_);
-
-    if (!head.is_valid())
+    // Shift a partial frame to the front of the buffer (a rare, small copy).
+    if (read_begin_ != 0)
     {
-        LOG_WARNING(LOG_NETWORK)
-            << "Invalid heading from [" << authority() << "]";
-        stop(error::bad_stream);
-        return;
+        const auto begin = read_buffer_.begin();
+        std::copy(begin + read_begin_, begin + read_end_, begin);
+        read_end_ -= read_begin_;
+        read_begin_ = 0;
     }
 
-    if (head.magic() != protocol_magic_)
+    const auto needed = read_end_ + std::max(required, read_reserve_);
+
+    // Release the memory of a buffer grown for a large frame.
+    if (needed <= minimum_read_buffer &&
+        read_buffer_.size() > minimum_read_buffer)
+        resize_read_buffer(minimum_read_buffer);
+
+    // Growth is deferred while the buffer budget of all channels is spent.
+    if (needed > read_buffer_.size() && !resize_read_buffer(needed))
     {
-        // These are common, with magic 542393671 coming from http requests.
-        LOG_DEBUG(LOG_NETWORK)
-            << "Invalid heading magic (" << head.magic() << ") from ["
+        LOG_NETWORK_VERBOSE(verbose_)
+            << "Buffer budget exhausted, deferring read from ["
             << authority() << "]";
-        stop(error::bad_stream);
-        return;
-    }
 
-    if (head.payload_size() > maximum_payload_)
-    {
-        LOG_DEBUG(LOG_NETWORK)
-            << "Oversized payload indicated by " << head.command()
-            << " heading from [" << authority() << "] ("
-            << head.payload_size() << " bytes)";
-        stop(error::bad_stream);
+        defer_read(required, throttle_interval);
         return;
     }
 
-    read_payload(head);
+    const auto free = read_buffer_.size() - read_end_;
+
+    transport_->read(buffer(&read_buffer_[read_end_], free), required,
+        strand_,
+            std::bind(&proxy::handle_read,
+                shared_from_this(), _1, _2));
 }
 
-void proxy::read_payload(const heading& head)
+// The deferral is retained so that a stop cancels it, as it would otherwise
+// hold the threadpool (join) for up to its delay. There is at most one read
+// deferral pending, so each recycles the memory of the last.
+void proxy::defer_read(size_t required, const asio::duration& delay)
 {
+    // A stopped channel does not read, so there is nothing to defer.
     if (stopped())
         return;
 
-    // This does not cause a reallocation.
-    payload_buffer_.resize(head.payload_size());
+    read_deferral_.expires_after(delay);
+    read_deferral_.async_wait(bind_executor(strand_,
+        make_allocating(read_deferral_memory_,
+            std::bind(&proxy::handle_throttle,
+                shared_from_this(), _1, required))));
+}
+
+void proxy::handle_throttle(const boost_code&, size_t required)
+{
+    read_more(required);
+}
 
-    async_read(socket_->get(), buffer(payload_buffer_),
-        std::bind(&proxy::handle_read_payload,
-            shared_from_this(), _1, _2, head));
+// static
+// Each transfer is charged once to each bucket (not each message), and the
+// transfer is then followed by the longer of the restoration times.
+asio::duration proxy::shape(token_bucket::ptr shared, token_bucket::ptr own,
+    size_t bytes)
+{
+    const auto tokens = static_cast<double>(bytes);
+    const auto zero = asio::duration::zero();
+    return std::max(shared ? shared->defer(tokens) : zero,
+        own ? own->defer(tokens) : zero);
 }
 
-void proxy::handle_read_payload(const boost_code& ec, size_t payload_size,
-    const heading& head)
+// Returns false if growth is refused by the budget.
+// The buffer is reallocated to exact size so that the budget is accurate.
+bool proxy::resize_read_buffer(size_t size)
+{
+    const auto prior = read_buffer_.size();
+
+    if (size > prior && budget_ && !budget_->try_acquire(size - prior))
+        return false;
+
+    if (size < prior && budget_)
+        budget_->release(prior - size);
+
+    data_chunk resized(size);
+    std::copy_n(read_buffer_.begin(), std::min(read_end_, size),
+        resized.begin());
+    read_buffer_.swap(resized);
+    return true;
+}
+
+void proxy::handle_read(const boost_code& ec, size_t bytes)
 {
     if (stopped())
         return;
@@ -199,41 +351,260 @@ void proxy::handle_read_payload(const boost_code& ec, size_t payload_size,
     if (ec)
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Payload read failure [" << authority() << "] "
+            << "Read failure [" << authority() << "] "
             << code(error::boost_to_error_code(ec)).message();
         stop(ec);
         return;
     }
 
+    const auto start = std::chrono::steady_clock::now();
+    const auto delay = shape(read_shaping_, channel_read_shaping_, bytes);
+
+    if (delay != asio::duration::zero())
+        read_resume_ = start + delay;
+
+    read_end_ += bytes;
+    read_frames();
+
+    tally_.read(std::chrono::steady_clock::now() - start);
+    add_traffic();
+}
+
+void proxy::read_frames()
+{
+    const auto heading_size = heading::satoshi_fixed_size();
+    size_t frames = 0;
+
+    while (!stopped())
+    {
+        // Releases are on the strand, so none completes concurrently.
+        if (congested())
+        {
+            paused_ = true;
+
+            if (frames != 0)
+                signal_activity();
+
+            return;
+        }
+
+        const auto available = read_end_ - read_begin_;
+
+        if (available < heading_size)
+        {
+            if (frames != 0)
+                signal_activity();
+
+            read_reserve_ = 0;
+            read_more(heading_size - available);
+            return;
+        }
+
+        heading head;
+        const auto begin = read_buffer_.data() + read_begin_;
+        auto source = make_safe_deserializer(begin, begin + heading_size);
+
+        if (!head.from_data(source) || !head.is_valid())
+        {
+            LOG_WARNING(LOG_NETWORK)
+                << "Invalid heading from [" << authority() << "]";
+            stop(error::bad_stream);
+            return;
+        }
+
+        if (head.magic() != protocol_magic_)
+        {
+            // These are common, with magic 542393671 coming from http requests.
+            LOG_DEBUG(LOG_NETWORK)
+                << "Invalid heading magic (" << head.magic() << ") from ["
+                << authority() << "]";
+            stop(error::bad_stream);
+            return;
+        }
+
+        if (head.payload_size() > maximum_payload_)
+        {
+            LOG_DEBUG(LOG_NETWORK)
+                << "Oversized payload indicated by " << head.command()
+                << " heading from [" << authority() << "] ("
+                << head.payload_size() << " bytes)";
+            stop(error::bad_stream);
+            return;
+        }
+
+        const auto frame_size = heading_size + head.payload_size();
+
+        if (available < frame_size)
+        {
+            if (frames != 0)
+                signal_activity();
+
+            const auto remaining = frame_size - available;
+
+            if (progressive(head))
+            {
+                if (!decoder_.active())
+                    decoder_.start(version_, head.payload_size());
+
+                const auto decodable = available - heading_size;
+                decoder_.decode(begin + heading_size, decodable);
+                read_reserve_ = remaining;
+                read_more(std::min(remaining, progressive_step));
+                return;
+            }
+
+            read_reserve_ = 0;
+            read_more(remaining);
+            return;
+        }
+
+        // The frame is captured before dispatch, as the buffer is then reused.
+        if (capture_)
+            capture_->record(capture_buffer_, capture_channel_, begin,
+                frame_size);
+
+        const auto payload = begin + heading_size;
+
+        if (!read_payload(head, payload, payload + head.payload_size()))
+            return;
+
+        tally_.received(traffic::to_index(head.command()), frame_size);
+
+        read_begin_ += frame_size;
+        ++frames;
+    }
+}
+
+// Zero limits disable the budget, a single message may exceed the budget.
+bool proxy::congested() const
+{
+    return (pending_messages_limit_ != 0 &&
+        pending_messages_ >= pending_messages_limit_) ||
+        (pending_bytes_limit_ != 0 && pending_bytes_ >= pending_bytes_limit_);
+}
+
+// Relayed handlers release on the threadpool, so return to the strand.
+void proxy::post_release(size_t size)
+{
+    boost::asio::dispatch(strand_,
+        std::bind(&proxy::handle_release,
+            shared_from_this(), size));
+}
+
+void proxy::handle_release(size_t size)
+{
+    --pending_messages_;
+    pending_bytes_ -= size;
+
+    // Resume the read cycle, as it is not otherwise active while paused.
+    if (paused_ && !congested())
+    {
+        paused_ = false;
+        read_frames();
+        add_traffic();
+    }
+}
+
+// A block is decoded progressively only if it will be delivered when read.
+bool proxy::progressive(const heading& head) const
+{
+    return progressive_decoding_ && head.type() == message_type::block &&
+        head.payload_size() >= progressive_minimum &&
+        message_subscriber_.subscribed(message_type::block);
+}
+
+// Deliver the progressively decoded block (or a block decoded in full if the
+// progressive decoding did not complete), false if the channel is stopped.
+bool proxy::load_block(const heading& head, const uint8_t* begin)
+{
+    const auto payload_size = head.payload_size();
+    const auto block = decoder_.complete(begin);
+
+    if (!block)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Invalid " << head.command() << " payload from [" << authority()
+            << "] " << code(error::bad_stream).message();
+        stop(error::bad_stream);
+        return false;
+    }
+
+    ++pending_messages_;
+    pending_bytes_ += payload_size;
+
+    const auto code = message_subscriber_.load(block,
+        std::bind(&proxy::post_release,
+            shared_from_this(), size_t(payload_size)));
+
+    if (code)
+    {
+        stop(code);
+        return false;
+    }
+
+    LOG_NETWORK_VERBOSE(verbose_)
+        << "Received " << head.command() << " from [" << authority()
+        << "] (" << payload_size << " bytes, progressive)";
+
+    return true;
+}
+
+bool proxy::read_payload(const heading& head, const uint8_t* begin,
+    const uint8_t* end)
+{
+    const auto payload_size = head.payload_size();
+
     // This is a pointless test but we allow it as an option for completeness.
     if (validate_checksum_ &&
-        head.checksum() != bitcoin_checksum(payload_buffer_))
+        head.checksum() != frame_checksum::compute(begin, end))
     {
         LOG_WARNING(LOG_NETWORK)
             << "Invalid " << head.command() << " payload from [" << authority()
             << "] bad checksum.";
         stop(error::bad_stream);
-        return;
+        return false;
     }
 
-    // Notify subscribers of the new message.
-    payload_source source(payload_buffer_);
-    payload_stream istream(source);
+    // A message without subscribers is dropped unparsed, its framing and
+    // size were validated with the heading. An unknown type is not dropped.
+    const auto type = head.type();
+
+    if (type != message_type::unknown && !message_subscriber_.subscribed(type))
+    {
+        LOG_NETWORK_VERBOSE(verbose_)
+            << "Dropped " << head.command() << " from [" << authority()
+            << "] (" << payload_size << " bytes)";
+
+        // A block unsubscribed during its progressive read is abandoned.
+        decoder_.reset();
+        return true;
+    }
+
+    // A block completed by progressive reads has been (mostly) decoded.
+    if (type == message_type::block && decoder_.active())
+        return load_block(head, begin);
+
+    // Notify subscribers of the new message, parsed in place from the buffer.
+    auto source = make_safe_deserializer(begin, end);
+    ++pending_messages_;
+    pending_bytes_ += payload_size;
 
     // Failures are not forwarded to subscribers and channel is stopped below.
-    const auto code = message_subscriber_.load(head.type(), version_, istream);
-    const auto consumed = istream.peek() == std::istream::traits_type::eof();
+    const auto code = message_subscriber_.load(type, version_, source,
+        std::bind(&proxy::post_release,
+            shared_from_this(), size_t(payload_size)));
+    const auto consumed = source.is_exhausted();
 
     if (verbose_ && code)
     {
-        const auto size = std::min(payload_size, invalid_payload_dump_size);
-        const auto begin = payload_buffer_.begin();
+        const auto size = std::min(size_t(payload_size),
+            invalid_payload_dump_size);
 
-        LOG_VERBOSE(LOG_NETWORK)
+        LOG_NETWORK_VERBOSE(verbose_)
             << "Invalid payload from [" << authority() << "] "
             << encode_base16(data_chunk{ begin, begin + size });
         stop(code);
-        return;
+        return false;
     }
 
     if (code)
@@ -242,7 +613,7 @@ void proxy::handle_read_payload(const boost_code& ec, size_t payload_size,
             << "Invalid " << head.command() << " payload from [" << authority()
             << "] " << code.message();
         stop(code);
-        return;
+        return false;
     }
 
     if (!consumed)
@@ -251,56 +622,210 @@ void proxy::handle_read_payload(const boost_code& ec, size_t payload_size,
             << "Invalid " << head.command() << " payload from [" << authority()
             << "] trailing bytes.";
         stop(error::bad_stream);
-        return;
+        return false;
     }
 
-    LOG_VERBOSE(LOG_NETWORK)
+    LOG_NETWORK_VERBOSE(verbose_)
         << "Received " << head.command() << " from [" << authority()
         << "] (" << payload_size << " bytes)";
 
-    signal_activity();
-    read_heading();
+    return true;
 }
 
 // Message send sequence.
 // ----------------------------------------------------------------------------
+// Messages sent while a write is in flight are queued by priority and then
+// written together as a single gather write when the write completes.
+// Sends are posted to the strand, which then owns the queues without a lock.
+
+// Unrecognized commands are announcements, neither control nor bulk.
+// static
+proxy::priority proxy::to_priority(message_type type)
+{
+    switch (type)
+    {
+        case message_type::ping:
+        case message_type::pong:
+        case message_type::version:
+        case message_type::verack:
+        case message_type::reject:
+        case message_type::send_headers:
+        case message_type::send_compact:
+        case message_type::fee_filter:
+        case message_type::get_address:
+            return priority::control;
+        case message_type::block:
+        case message_type::transaction:
+        case message_type::merkle_block:
+        case message_type::compact_block:
+        case message_type::block_transactions:
+            return priority::bulk;
+        default:
+            return priority::announce;
+    }
+}
 
-void proxy::do_send(command_ptr command, payload_ptr payload,
+void proxy::send(command_ptr command, message_type type, payload_ptr payload,
     result_handler handler)
 {
-    async_write(socket_->get(), buffer(*payload),
-        std::bind(&proxy::handle_send,
-            shared_from_this(), _1, _2, command, payload, handler));
+    if (stopped())
+    {
+        handler(error::channel_stopped);
+        return;
+    }
+
+    boost::asio::post(strand_,
+        std::bind(&proxy::do_send,
+            shared_from_this(), command, type, payload, handler));
 }
 
-void proxy::handle_send(const boost_code& ec, size_t, command_ptr command,
+void proxy::do_send(command_ptr command, message_type type,
     payload_ptr payload, result_handler handler)
 {
-    dispatch_.unlock();
-    const auto size = payload->size();
-    const auto error = code(error::boost_to_error_code(ec));
+    const auto index = static_cast<size_t>(to_priority(type));
+    queues_[index].push_back({ command, payload, handler,
+        std::chrono::steady_clock::now(), traffic::to_index(*command) });
+
+    // The tally is added upon the next read or write completion.
+    tally_.enqueued(1);
+
+    if (writing_)
+        return;
+
+    writing_ = true;
+    write_next();
+}
+
+// Only one write is outstanding, so batch_ and write_buffers_ are unguarded.
+void proxy::write_next()
+{
+    BITCOIN_ASSERT(batch_.empty());
+
+    // Control and announcement messages are taken in full and in order.
+    for (size_t index = 0; index < priority_count - 1; ++index)
+    {
+        auto& queue = queues_[index];
+        std::move(queue.begin(), queue.end(), std::back_inserter(batch_));
+        queue.clear();
+    }
+
+    // The backlog of bulk messages is written in limited steps, so that a
+    // control message waits for at most one step. Messages are not split,
+    // as the wire protocol cannot interleave within a message.
+    auto& bulk = queues_[priority_count - 1];
+    size_t bulk_bytes = 0;
 
+    while (!bulk.empty() && (bulk_bytes == 0 ||
+        bulk_bytes + bulk.front().payload->size() <= bulk_write_limit))
+    {
+        bulk_bytes += bulk.front().payload->size();
+        batch_.push_back(std::move(bulk.front()));
+        bulk.pop_front();
+    }
+
+    if (batch_.empty())
+    {
+        writing_ = false;
+        return;
+    }
+
+    // Sequential writes are required because a write may occur in multiple
+    // asynchronous steps invoked on different threads.
+    write_buffers_.clear();
+    write_buffers_.reserve(batch_.size());
+
+    for (const auto& send: batch_)
+        write_buffers_.push_back(buffer(*send.payload));
+
+    transport_->write(write_buffers_, strand_,
+        std::bind(&proxy::handle_write,
+            shared_from_this(), _1, _2));
+}
+
+void proxy::defer_write(const asio::duration& delay)
+{
+    // A stopped channel fails its queued sends at once, without a deferral.
     if (stopped())
     {
-        handler(error);
+        write_next();
         return;
     }
 
-    if (error)
+    LOG_NETWORK_VERBOSE(verbose_)
+        << "Write rate limited, deferring write to [" << authority() << "]";
+
+    write_deferral_.expires_after(delay);
+    write_deferral_.async_wait(bind_executor(strand_,
+        make_allocating(write_deferral_memory_,
+            std::bind(&proxy::handle_deferred_write,
+                shared_from_this(), _1))));
+}
+
+// A stopped channel writes the queue to its stopped transport, which then
+// completes each queued send with the failure.
+void proxy::handle_deferred_write(const boost_code&)
+{
+    write_next();
+}
+
+void proxy::handle_write(const boost_code& ec, size_t bytes)
+{
+    const auto error = code(error::boost_to_error_code(ec));
+
+    if (error && !stopped())
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Failure sending " << *command << " to [" << authority()
-            << "] (" << size << " bytes) " << error.message();
+            << "Failure sending " << batch_.size() << " messages to ["
+            << authority() << "] (" << bytes << " bytes) " << error.message();
         stop(error);
-        handler(error);
-        return;
     }
 
-    LOG_VERBOSE(LOG_NETWORK)
-        << "Sent " << *command << " to [" << authority() << "] (" << size
-        << " bytes)";
+    send_batch batch;
+    std::swap(batch, batch_);
+
+    const auto delay = error ? asio::duration::zero() :
+        shape(write_shaping_, channel_write_shaping_, bytes);
+
+    // Completion of the batch allows a new batch to be written, which waits
+    // while a write rate limit is overdrawn (sends are queued meanwhile).
+    if (delay == asio::duration::zero())
+        write_next();
+    else
+        defer_write(delay);
+
+    const auto now = std::chrono::steady_clock::now();
+    tally_.dequeued(batch.size());
+
+    for (const auto& send: batch)
+    {
+        if (!error)
+        {
+            tally_.sent(send.traffic_index, send.payload->size(),
+                now - send.queued);
+
+            LOG_NETWORK_VERBOSE(verbose_)
+                << "Sent " << *send.command << " to [" << authority()
+                << "] (" << send.payload->size() << " bytes)";
+        }
+
+        send.handler(error);
+    }
+
+    add_traffic();
+}
+
+// The tally is added once per read or write, not per message.
+void proxy::add_traffic()
+{
+    if (tally_.empty())
+        return;
+
+    traffic_.add(tally_);
+
+    if (network_traffic_)
+        network_traffic_->add(tally_);
 
-    handler(error);
+    tally_.clear();
 }
 
 // Stop sequence.
@@ -312,8 +837,6 @@ void proxy::handle_send(const boost_code& ec, size_t, command_ptr command,
 // Instead this is thread safe and idempotent, allowing it to be unguarded.
 void proxy::stop(const code& ec)
 {
-    LOG_VERBOSE(LOG_NETWORK)
-    << "Starting proxy::stop()";
     BITCOIN_ASSERT_MSG(ec, "The stop code must be an error code.");
 
     stopped_ = true;
@@ -329,10 +852,28 @@ void proxy::stop(const code& ec)
     // Give channel opportunity to terminate timers.
     handle_stopping();
 
-    // Signal socket to stop reading and accepting new work.
-    socket_->stop();
-    LOG_VERBOSE(LOG_NETWORK)
-    << "Ending proxy::stop()";
+    // Signal transport to stop reading and accepting new work.
+    transport_->stop();
+
+    // Cancel deferrals on the strand, so that queued sends fail promptly.
+    boost::asio::post(strand_,
+        std::bind(&proxy::handle_stop,
+            shared_from_this()));
+}
+
+// A cancelled deferral completes (on the strand) with the failure, so a
+// deferred write then fails the queued sends against the stopped transport.
+// Deferrals are not created once stopped, so none outlives this cancel.
+void proxy::handle_stop()
+{
+    // The capture buffer is submitted so that it is not held until release.
+    if (capture_)
+        capture_->submit(capture_buffer_);
+
+    // A failure to cancel is of no consequence, the deferral then completes.
+    boost_code ignore;
+    read_deferral_.cancel(ignore);
+    write_deferral_.cancel(ignore);
 }
 
 void proxy::stop(const boost_code& ec)
@@ -18,7 +18,6 @@
  */
 #include <bitcoin/network/sessions/session.hpp>
 
-#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -27,6 +26,8 @@
 #include <bitcoin/network/acceptor.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/connector.hpp>
+#include <bitcoin/network/loopback_acceptor.hpp>
+#include <bitcoin/network/loopback_connector.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/protocols/protocol_version_31402.hpp>
@@ -75,15 +76,58 @@ code session::fetch_address(address& out_address) const
     return network_.fetch_address(out_address);
 }
 
+// Connection history is advisory, an address absent from the pool is ignored.
+void session::attempted(const authority& authority)
+{
+    network_.attempted(authority.to_network_address());
+}
+
+void session::succeeded(const authority& authority)
+{
+    network_.succeeded(authority.to_network_address());
+}
+
+void session::failed(const authority& authority)
+{
+    network_.failed(authority.to_network_address());
+}
+
+// A stopped attempt is not counted as a failure.
+void session::count_connect(const code& ec)
+{
+    const auto counters = network_.connection_metrics();
+    counters->attempted(metrics_type());
+
+    if (ec && ec != error::service_stopped)
+        counters->failed(metrics_type());
+}
+
 bool session::blacklisted(const authority& authority) const
 {
-    const auto ip_compare = [&](const config::authority& blocked)
+    return network_.address_blacklist()->contains(authority);
+}
+
+const dispatch_policy& session::message_dispatch() const
+{
+    return settings_.message_dispatch;
+}
+
+const socket_profile& session::socket_options() const
+{
+    switch (metrics_type())
     {
-        return authority.ip() == blocked.ip();
-    };
+        case metrics::session_type::inbound:
+            return settings_.inbound_socket;
+        case metrics::session_type::manual:
+            return settings_.manual_socket;
+        default:
+            return settings_.outbound_socket;
+    }
+}
 
-    const auto& list = settings_.blacklists;
-    return std::any_of(list.begin(), list.end(), ip_compare);
+metrics::session_type session::metrics_type() const
+{
+    return metrics::session_type::outbound;
 }
 
 bool session::stopped() const
@@ -101,12 +145,28 @@ bool session::stopped(const code& ec) const
 
 acceptor::ptr session::create_acceptor()
 {
-    return std::make_shared<acceptor>(pool_, settings_);
+    const auto hub = network_.loopback();
+
+    if (hub)
+        return std::make_shared<loopback_acceptor>(pool_, settings_, hub);
+
+    const auto created = std::make_shared<acceptor>(pool_, settings_,
+        network_.channel_shards());
+    created->set_socket_profile(socket_options());
+    return created;
 }
 
 connector::ptr session::create_connector()
 {
-    return std::make_shared<connector>(pool_, settings_);
+    const auto hub = network_.loopback();
+
+    if (hub)
+        return std::make_shared<loopback_connector>(pool_, settings_, hub);
+
+    const auto created = std::make_shared<connector>(pool_, settings_,
+        network_.name_cache(), network_.channel_shards());
+    created->set_socket_profile(socket_options());
+    return created;
 }
 
 // Pending connect.
@@ -127,6 +187,8 @@ void session::unpend(connector::ptr connector)
 
 code session::pend(channel::ptr channel)
 {
+    // The nonce is assigned before pending so that it is indexed.
+    channel->set_nonce(pseudo_random::next(1, max_uint64));
     return network_.pend(channel);
 }
 
@@ -196,7 +258,23 @@ void session::start_channel(channel::ptr channel,
     result_handler handle_started)
 {
     channel->set_notify(notify_on_connect_);
-    channel->set_nonce(pseudo_random::next(1, max_uint64));
+
+    // A pended channel has already been assigned its nonce.
+    if (channel->nonce() == 0)
+        channel->set_nonce(pseudo_random::next(1, max_uint64));
+
+    channel->set_dispatch(message_dispatch());
+    channel->set_budget(network_.buffer_budget());
+    channel->set_traffic(network_.network_traffic());
+    channel->set_capture(network_.capture());
+    channel->set_timers(network_.timers());
+
+    // Manual connections are exempt from bandwidth shaping.
+    if (metrics_type() != metrics::session_type::manual)
+        channel->set_shaping(network_.read_shaping(),
+            network_.write_shaping());
+
+    channel->trace().record(handshake_trace::stage::started);
 
     // The channel starts, invokes the handler, then starts the read cycle.
     channel->start(
@@ -239,10 +317,15 @@ void session::handle_handshake(const code& ec, channel::ptr channel,
             << "Failure in handshake with [" << channel->authority()
             << "] " << ec.message();
 
+        network_.connection_metrics()->handshake_failed(metrics_type());
         handle_started(ec);
         return;
     }
 
+    channel->trace().record(handshake_trace::stage::complete);
+    network_.connection_metrics()->handshaken(metrics_type(),
+        channel->trace());
+
     handshake_complete(channel, handle_started);
 }
 
@@ -266,6 +349,7 @@ void session::handle_start(const code& ec, channel::ptr channel,
     }
     else
     {
+        network_.connection_metrics()->connected(metrics_type());
         channel->subscribe_stop(
             BIND3(handle_remove, _1, channel, handle_stopped));
     }
@@ -278,6 +362,7 @@ void session::handle_remove(const code& , channel::ptr channel,
     result_handler handle_stopped)
 {
     network_.remove(channel);
+    network_.connection_metrics()->disconnected(metrics_type());
     handle_stopped(error::success);
 }
 
@@ -18,7 +18,11 @@
  */
 #include <bitcoin/network/sessions/session_batch.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <numeric>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/connector.hpp>
 #include <bitcoin/network/p2p.hpp>
@@ -34,10 +38,29 @@ using namespace bc::config;
 using namespace bc::message;
 using namespace std::placeholders;
 
+// Outcomes are weighted, a slow connection is half a success.
+static const size_t outcome_window = 32;
+static const size_t minimum_outcomes = 8;
+static const double slow_success = 0.5;
+
+// The batch is sized for this likelihood of at least one connection.
+static const double batch_confidence = 0.95;
+static const double minimum_rate = 0.01;
+
 session_batch::session_batch(p2p& network, bool notify_on_connect)
   : session(network, notify_on_connect),
-    batch_size_(std::max(settings_.connect_batch_size, 1u))
+    minimum_(std::max(settings_.connect_batch_minimum, 1u)),
+    maximum_(std::max<size_t>(settings_.connect_batch_maximum, minimum_)),
+    batch_size_(std::min(std::max<size_t>(settings_.connect_batch_size,
+        minimum_), maximum_)),
+    next_outcome_(0)
+{
+    outcomes_.reserve(outcome_window);
+}
+
+size_t session_batch::batch_size() const
 {
+    return batch_size_;
 }
 
 // Connect sequence.
@@ -46,36 +69,41 @@ session_batch::session_batch(p2p& network, bool notify_on_connect)
 // protected:
 void session_batch::connect(channel_handler handler)
 {
-    const auto join_handler = synchronize(handler, batch_size_, NAME "_join",
-        synchronizer_terminate::on_success);
+    const size_t batch_size = batch_size_;
+    const auto state = std::make_shared<batch>();
+    state->handler = handler;
+    state->connectors.reserve(batch_size);
+    state->pending = batch_size;
+    state->claimed = false;
+    state->finished = false;
 
-    for (size_t host = 0; host < batch_size_; ++host)
-        new_connect(join_handler);
+    for (size_t host = 0; host < batch_size; ++host)
+        new_connect(state);
 }
 
-void session_batch::new_connect(channel_handler handler)
+void session_batch::new_connect(batch::ptr state)
 {
     if (stopped())
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Suspended batch connection.";
-        handler(error::channel_stopped, nullptr);
+        complete(state, error::channel_stopped, nullptr);
         return;
     }
 
     network_address address;
     const auto ec = fetch_address(address);
-    start_connect(ec, address, handler);
+    start_connect(ec, address, state);
 }
 
 void session_batch::start_connect(const code& ec, const authority& host,
-    channel_handler handler)
+    batch::ptr state)
 {
     if (stopped(ec))
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Batch session stopped while starting.";
-        handler(error::service_stopped, nullptr);
+        complete(state, error::service_stopped, nullptr);
         return;
     }
 
@@ -84,46 +112,199 @@ void session_batch::start_connect(const code& ec, const authority& host,
     {
         LOG_WARNING(LOG_NETWORK)
             << "Failure fetching new address: " << ec.message();
-        handler(ec, nullptr);
+        complete(state, ec, nullptr);
         return;
     }
 
-    // This creates a tight loop in the case of a small address pool.
+    // The outbound session backs off upon a blocked address, so a small
+    // pool of blocked addresses does not create a tight loop.
     if (blacklisted(host))
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Fetched blacklisted address [" << host << "] ";
-        handler(error::address_blocked, nullptr);
+        complete(state, error::address_blocked, nullptr);
         return;
     }
 
-    LOG_VERBOSE(LOG_NETWORK)
+    const auto connector = create_connector();
+    connector->set_claim(BIND1(claim, state));
+
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(state->mutex);
+
+        // Another attempt has already connected.
+        if (state->claimed || state->finished)
+        {
+            connector->stop(error::channel_stopped);
+            --state->pending;
+            return;
+        }
+
+        state->connectors.push_back(connector);
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    LOG_NETWORK_VERBOSE(settings_.verbose)
         << "Connecting to [" << host << "]";
 
-    const auto connector = create_connector();
     pend(connector);
+    attempted(host);
 
     // CONNECT
     connector->connect(host,
-        BIND4(handle_connect, _1, _2, connector, handler));
+        BIND6(handle_connect, _1, _2, host, clock::now(), connector, state));
 }
 
 void session_batch::handle_connect(const code& ec, channel::ptr channel,
-    connector::ptr connector, channel_handler handler)
+    const authority& host, clock::time_point started,
+    connector::ptr connector, batch::ptr state)
 {
     unpend(connector);
 
-    if (ec)
+    if (!ec)
     {
-        handler(ec, nullptr);
+        LOG_DEBUG(LOG_NETWORK)
+            << "Connected to [" << channel->authority() << "]";
+    }
+
+    // A cancelled (lost) attempt says nothing about the address or the pool.
+    if (!complete(state, ec, channel))
         return;
+
+    count_connect(ec);
+    record(ec, started);
+
+    // A stopped attempt is not a failure of the address.
+    if (ec && ec != error::service_stopped)
+        failed(host);
+}
+
+// private:
+// The first attempt to connect claims the batch, so that the others do not
+// create channels only to be discarded.
+bool session_batch::claim(batch::ptr state)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(state->mutex);
+
+    if (state->claimed || state->finished)
+        return false;
+
+    state->claimed = true;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private:
+// Returns false if the batch had already been completed by another attempt.
+bool session_batch::complete(batch::ptr state, const code& ec,
+    channel::ptr channel)
+{
+    std::vector<connector::ptr> losers;
+    channel_handler handler;
+    auto lost = false;
+
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(state->mutex);
+        --state->pending;
+
+        // A failure after the claim is a cancelled (lost) attempt.
+        if (state->finished || (state->claimed && ec))
+        {
+            lost = true;
+        }
+        else if (!ec || state->pending == 0)
+        {
+            state->finished = true;
+            std::swap(losers, state->connectors);
+            std::swap(handler, state->handler);
+        }
+        ///////////////////////////////////////////////////////////////////////
     }
 
-    LOG_DEBUG(LOG_NETWORK)
-        << "Connected to [" << channel->authority() << "]";
+    // Cancel the outstanding attempts, which then do not create channels.
+    for (const auto& loser: losers)
+        loser->stop(error::channel_stopped);
+
+    if (lost)
+    {
+        if (channel)
+            channel->stop(error::channel_stopped);
+
+        return false;
+    }
+
+    // This is the end of the connect sequence (upon success or last failure).
+    if (handler)
+        handler(ec, ec ? nullptr : channel);
+
+    return true;
+}
+
+// Batch size adaptation.
+// ----------------------------------------------------------------------------
+
+// private:
+void session_batch::record(const code& ec, clock::time_point started)
+{
+    // A cancelled attempt says nothing about the address pool.
+    if (ec == error::service_stopped || ec == error::channel_stopped)
+        return;
+
+    const auto latency = clock::now() - started;
+    const auto slow = latency > settings_.connect_timeout() / 2;
+    const auto weight = ec ? 0.0 : (slow ? slow_success : 1.0);
+    double rate;
+
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(mutex_);
+
+        if (outcomes_.size() < outcome_window)
+            outcomes_.push_back(weight);
+        else
+            outcomes_[next_outcome_] = weight;
+
+        next_outcome_ = (next_outcome_ + 1) % outcome_window;
+
+        if (outcomes_.size() < minimum_outcomes)
+            return;
+
+        rate = std::accumulate(outcomes_.begin(), outcomes_.end(), 0.0) /
+            outcomes_.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    const auto size = adapted_size(rate, minimum_, maximum_);
+    const auto prior = batch_size_.exchange(size);
+
+    if (size != prior)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Connect batch size " << prior << " to " << size
+            << " at success rate " << rate;
+    }
+}
+
+// static
+// The smallest batch with a confident likelihood of at least one success.
+size_t session_batch::adapted_size(double rate, size_t minimum,
+    size_t maximum)
+{
+    if (rate >= 1.0)
+        return minimum;
+
+    const auto failure = 1.0 - std::max(rate, minimum_rate);
+    const auto size = std::ceil(std::log(1.0 - batch_confidence) /
+        std::log(failure));
 
-    // This is the end of the connect sequence.
-    handler(error::success, channel);
+    return std::min(std::max(static_cast<size_t>(size), minimum), maximum);
 }
 
 } // namespace network
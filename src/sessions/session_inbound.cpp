@@ -18,11 +18,15 @@
  */
 #include <bitcoin/network/sessions/session_inbound.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/eviction.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_fee_filter_70013.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
@@ -34,20 +38,59 @@ namespace network {
 
 using namespace std::placeholders;
 
+// Subnets are /24 for ipv4 (mapped) and /48 for ipv6, as bytes retained.
+static constexpr size_t ipv4_subnet_bytes = 15;
+static constexpr size_t ipv6_subnet_bytes = 6;
+static constexpr size_t ipv4_mapped_bytes = 12;
+
+// Idle subnet rate state is pruned when the table exceeds this size.
+static constexpr size_t subnet_table_limit = 4096;
+
+static constexpr double seconds_per_minute = 60.0;
+
 session_inbound::session_inbound(p2p& network, bool notify_on_connect)
   : session(network, notify_on_connect),
     connection_limit_(settings_.inbound_connections +
         settings_.outbound_connections + settings_.peers.size()),
+    accept_rate_(settings_.inbound_accepts_per_minute / seconds_per_minute,
+        std::max(settings_.inbound_accept_burst, 1u)),
+    admitted_(0),
+    blocked_(0),
+    saturated_(0),
+    address_capped_(0),
+    subnet_capped_(0),
+    rate_limited_(0),
+    evicted_(0),
+    channels_(settings_.inbound_connections),
     CONSTRUCT_TRACK(session_inbound)
 {
 }
 
+session_inbound::admissions session_inbound::admission_counts() const
+{
+    return
+    {
+        admitted_.load(),
+        blocked_.load(),
+        saturated_.load(),
+        address_capped_.load(),
+        subnet_capped_.load(),
+        rate_limited_.load(),
+        evicted_.load()
+    };
+}
+
+metrics::session_type session_inbound::metrics_type() const
+{
+    return metrics::session_type::inbound;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
 void session_inbound::start(result_handler handler)
 {
-    if (settings_.inbound_port == 0 || settings_.inbound_connections == 0)
+    if (listen_endpoints().empty() || settings_.inbound_connections == 0)
     {
         LOG_INFO(LOG_NETWORK)
             << "Not configured for accepting incoming connections.";
@@ -55,9 +98,14 @@ void session_inbound::start(result_handler handler)
         return;
     }
 
-    LOG_INFO(LOG_NETWORK)
-        << "Starting inbound session on port (" << settings_.inbound_port
-        << ").";
+    if (settings_.binds.empty())
+        LOG_INFO(LOG_NETWORK)
+            << "Starting inbound session on port (" << settings_.inbound_port
+            << ").";
+    else
+        LOG_INFO(LOG_NETWORK)
+            << "Starting inbound session on (" << settings_.binds.size()
+            << ") endpoints.";
 
     session::start(CONCURRENT_DELEGATE2(handle_started, _1, handler));
 }
@@ -70,23 +118,24 @@ void session_inbound::handle_started(const code& ec, result_handler handler)
         return;
     }
 
-    acceptor_ = create_acceptor();
-
-    // Relay stop to the acceptor.
-    subscribe_stop(BIND1(handle_stop, _1));
-
-    // START LISTENING ON PORT
-    const auto error_code = acceptor_->listen(settings_.inbound_port);
+    // START LISTENING ON ENDPOINTS
+    const auto error_code = listen(listen_endpoints());
 
     if (error_code)
     {
         LOG_ERROR(LOG_NETWORK)
-            << "Error starting listener: " << ec.message();
+            << "Error starting listener: " << error_code.message();
+        handle_stop(error_code);
         handler(error_code);
         return;
     }
 
-    start_accept(error::success);
+    // Relay stop to the acceptors.
+    subscribe_stop(BIND1(handle_stop, _1));
+
+    // Each acceptor rearms its own accept, so accepts proceed in parallel.
+    for (const auto acceptor: acceptors_)
+        start_accept(error::success, acceptor);
 
     // This is the end of the start sequence.
     handler(error::success);
@@ -94,14 +143,101 @@ void session_inbound::handle_started(const code& ec, result_handler handler)
 
 void session_inbound::handle_stop(const code& ec)
 {
-    // Signal the stop of listener/accept attempt.
-    acceptor_->stop(ec);
+    // Signal the stop of listener/accept attempts.
+    for (const auto acceptor: acceptors_)
+        acceptor->stop(ec);
+}
+
+// Listeners.
+// ----------------------------------------------------------------------------
+
+// private
+// Without binds this is the ipv6 (and dual stack ipv4) any address.
+session_inbound::endpoints session_inbound::listen_endpoints() const
+{
+    endpoints out;
+
+    if (settings_.binds.empty())
+    {
+        if (settings_.inbound_port != 0)
+            out.emplace_back(asio::tcp::v6(), settings_.inbound_port);
+
+        return out;
+    }
+
+    out.reserve(settings_.binds.size());
+
+    for (const auto& bind: settings_.binds)
+        out.push_back(to_endpoint(bind));
+
+    return out;
+}
+
+// private
+// An ipv4-mapped address is bound as ipv4, for ipv6-only listeners.
+asio::endpoint session_inbound::to_endpoint(const authority& authority)
+{
+    using namespace boost::asio::ip;
+    const auto ip = authority.asio_ip();
+
+    if (ip.is_v4_mapped())
+        return { make_address_v4(v4_mapped, ip), authority.port() };
+
+    return { ip, authority.port() };
+}
+
+// private
+size_t session_inbound::listeners_per_endpoint() const
+{
+    const size_t count = std::max(settings_.inbound_acceptors, 1u);
+
+    if (count > 1 && !acceptor::shareable())
+    {
+        LOG_INFO(LOG_NETWORK)
+            << "Shared listeners are not supported, using one per endpoint.";
+        return 1;
+    }
+
+    return count;
+}
+
+// private
+// Configured binds are ipv6 only, so that ipv4 binds may share their ports.
+code session_inbound::listen(const endpoints& endpoints)
+{
+    const auto count = listeners_per_endpoint();
+    const auto shared = count > 1;
+    const auto ipv6_only = !settings_.binds.empty();
+
+    for (const auto& endpoint: endpoints)
+    {
+        for (size_t listener = 0; listener < count; ++listener)
+        {
+            const auto acceptor = create_acceptor();
+
+            // Reject blocked and excess connections before channel creation.
+            acceptor->set_admission(BIND1(admit, _1));
+            acceptors_.push_back(acceptor);
+
+            const auto ec = acceptor->listen(endpoint, shared, ipv6_only);
+
+            if (ec)
+            {
+                LOG_ERROR(LOG_NETWORK)
+                    << "Error listening on [" << endpoint << "] "
+                    << ec.message();
+                return ec;
+            }
+        }
+    }
+
+    return error::success;
 }
 
 // Accept sequence.
 // ----------------------------------------------------------------------------
 
-void session_inbound::start_accept(const code&)
+void session_inbound::start_accept(const code&, acceptor::ptr acceptor)
 {
     if (stopped())
     {
@@ -111,20 +247,27 @@ void session_inbound::start_accept(const code&)
     }
 
     // ACCEPT THE NEXT INCOMING CONNECTION
-    acceptor_->accept(BIND2(handle_accept, _1, _2));
+    acceptor->accept(BIND3(handle_accept, _1, _2, acceptor));
 }
 
-void session_inbound::handle_accept(const code& ec, channel::ptr channel)
+void session_inbound::handle_accept(const code& ec, channel::ptr channel,
+    acceptor::ptr acceptor)
 {
     if (stopped(ec))
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Suspended inbound connection.";
+
+        // A channel is only provided if it was admitted.
+        if (channel)
+            release(channel->authority().ip());
+
         return;
     }
 
     // Start accepting with conditional delay in case of network error.
-    dispatch_delayed(cycle_delay(ec), BIND1(start_accept, _1));
+    dispatch_delayed(cycle_delay(ec), BIND2(start_accept, _1, acceptor));
+    count_connect(ec);
 
     if (ec)
     {
@@ -133,27 +276,210 @@ void session_inbound::handle_accept(const code& ec, channel::ptr channel)
         return;
     }
 
-    if (blacklisted(channel->authority()))
+    // The admission reservation is released when the channel stops.
+    register_channel(channel,
+        BIND2(handle_channel_start, _1, channel),
+        BIND2(handle_channel_stop, _1, channel));
+}
+
+// Invoked by the acceptor for each accepted socket, before channel creation.
+code session_inbound::admit(const authority& authority)
+{
+    if (blacklisted(authority))
     {
-        LOG_DEBUG(LOG_NETWORK)
-            << "Rejected inbound connection from ["
-            << channel->authority() << "] due to blacklisted address.";
-        return;
+        ++blocked_;
+        return error::address_blocked;
     }
 
+    // The address, subnet and rate caps precede eviction, so that a capped
+    // connection cannot disconnect a peer.
+    const auto ec = reserve(authority.ip());
+
+    if (ec)
+        return ec;
+
     // Inbound connections can easily overflow in the case where manual and/or
     // outbound connections at the time are not yet connected as configured.
-    if (connection_count() >= connection_limit_)
+    if (connection_count() >= connection_limit_ &&
+        !(settings_.inbound_eviction && evict()))
     {
-        LOG_DEBUG(LOG_NETWORK)
-            << "Rejected inbound connection from ["
-            << channel->authority() << "] due to connection limit.";
-        return;
+        release(authority.ip());
+        ++saturated_;
+        return error::peer_throttling;
     }
 
-    register_channel(channel,
-        BIND2(handle_channel_start, _1, channel),
-        BIND1(handle_channel_stop, _1));
+    ++admitted_;
+    return error::success;
+}
+
+// Eviction.
+// ----------------------------------------------------------------------------
+
+// The evicted channel is removed at once, so that a concurrent admission
+// does not select it again. The count then falls as the channel stops.
+bool session_inbound::evict()
+{
+    const auto channels = channels_.snapshot();
+    eviction::candidates candidates;
+    candidates.reserve(channels->size());
+
+    for (size_t index = 0; index < channels->size(); ++index)
+    {
+        const auto& channel = (*channels)[index];
+        const auto trip = channel->round_trip();
+        asio::duration age;
+
+        if (!channel->trace().age(handshake_trace::stage::complete, age))
+            continue;
+
+        const std::chrono::duration<double> seconds = age;
+        const auto useful = eviction::useful_messages(
+            channel->traffic_statistics());
+
+        candidates.push_back(
+        {
+            index,
+            trip.samples == 0 ? asio::duration::zero() : trip.average,
+            seconds.count() > 0 ? useful / seconds.count() : 0.0,
+            age
+        });
+    }
+
+    size_t selected;
+
+    if (!eviction::select(candidates, settings_.inbound_eviction_protected,
+        selected))
+        return false;
+
+    const auto channel = (*channels)[selected];
+    channels_.remove(channel);
+    ++evicted_;
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Evicting inbound channel [" << channel->authority() << "]";
+
+    channel->stop(error::channel_stopped);
+    return true;
+}
+
+// Admission accounting.
+// ----------------------------------------------------------------------------
+
+size_t session_inbound::address_hash::operator()(
+    const address_key& value) const
+{
+    return boost::hash_range(value.begin(), value.end());
+}
+
+// private
+session_inbound::address_key session_inbound::to_subnet(const address_key& ip)
+{
+    static const address_key mapped
+    {
+        { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0, 0, 0, 0 }
+    };
+
+    const auto ipv4 = std::equal(ip.begin(), ip.begin() + ipv4_mapped_bytes,
+        mapped.begin());
+
+    auto subnet = ip;
+    const auto retained = ipv4 ? ipv4_subnet_bytes : ipv6_subnet_bytes;
+    std::fill(subnet.begin() + retained, subnet.end(), 0);
+    return subnet;
+}
+
+// private
+// Reserve a connection for the address against the address and subnet caps
+// and consume an accept token from the subnet and global rate limiters.
+code session_inbound::reserve(const address_key& ip)
+{
+    const auto subnet = to_subnet(ip);
+    const auto address_limit = settings_.inbound_address_connections;
+    const auto subnet_limit = settings_.inbound_subnet_connections;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto address = addresses_.find(ip);
+    const auto addressed = address == addresses_.end() ? 0 : address->second;
+
+    if (address_limit != 0 && addressed >= address_limit)
+    {
+        ++address_capped_;
+        return error::peer_throttling;
+    }
+
+    if (subnets_.size() >= subnet_table_limit)
+        prune();
+
+    auto it = subnets_.find(subnet);
+
+    if (it == subnets_.end())
+    {
+        const auto rate = settings_.inbound_subnet_accepts_per_minute /
+            seconds_per_minute;
+        const auto burst = std::max(settings_.inbound_accept_burst, 1u);
+        const subnet_state state{ 0, std::make_shared<token_bucket>(rate,
+            burst) };
+        it = subnets_.emplace(subnet, state).first;
+    }
+
+    auto& state = it->second;
+
+    if (subnet_limit != 0 && state.connections >= subnet_limit)
+    {
+        ++subnet_capped_;
+        return error::peer_throttling;
+    }
+
+    // The global token is taken last, it is not spent on a subnet rejection.
+    if (!state.bucket->try_consume() || !accept_rate_.try_consume())
+    {
+        ++rate_limited_;
+        return error::peer_throttling;
+    }
+
+    ++state.connections;
+    ++addresses_[ip];
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+void session_inbound::release(const address_key& ip)
+{
+    const auto subnet = to_subnet(ip);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto address = addresses_.find(ip);
+
+    if (address != addresses_.end() && --address->second == 0)
+        addresses_.erase(address);
+
+    // The subnet is retained for its rate state, until pruned.
+    const auto it = subnets_.find(subnet);
+
+    if (it != subnets_.end() && it->second.connections > 0)
+        --it->second.connections;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Drop subnets with no connections whose rate limiter has fully recovered.
+// This is not thread safe, the caller must hold the mutex.
+void session_inbound::prune()
+{
+    for (auto it = subnets_.begin(); it != subnets_.end();)
+    {
+        if (it->second.connections == 0 && it->second.bucket->full())
+            it = subnets_.erase(it);
+        else
+            ++it;
+    }
 }
 
 void session_inbound::handle_channel_start(const code& ec,
@@ -172,6 +498,10 @@ void session_inbound::handle_channel_start(const code& ec,
         << "Connected inbound channel [" << channel->authority() << "] ("
         << connection_count() << ")";
 
+    // Channels are candidates for eviction once started.
+    if (settings_.inbound_eviction)
+        channels_.store(channel, false);
+
     attach_protocols(channel);
 }
 
@@ -187,11 +517,18 @@ void session_inbound::attach_protocols(channel::ptr channel)
     if (version >= message::version::level::bip61)
         attach<protocol_reject_70002>(channel)->start();
 
+    if (version >= message::version::level::bip133)
+        attach<protocol_fee_filter_70013>(channel)->start();
+
     attach<protocol_address_31402>(channel)->start();
 }
 
-void session_inbound::handle_channel_stop(const code& ec)
+void session_inbound::handle_channel_stop(const code& ec,
+    channel::ptr channel)
 {
+    release(channel->authority().ip());
+    channels_.remove(channel);
+
     LOG_DEBUG(LOG_NETWORK)
         << "Inbound channel stopped: " << ec.message();
 }
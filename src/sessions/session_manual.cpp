@@ -25,6 +25,7 @@
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_fee_filter_70013.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
@@ -42,6 +43,11 @@ session_manual::session_manual(p2p& network, bool notify_on_connect)
 {
 }
 
+metrics::session_type session_manual::metrics_type() const
+{
+    return metrics::session_type::manual;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 // Manual connections are always enabled.
@@ -111,6 +117,7 @@ void session_manual::handle_connect(const code& ec, channel::ptr channel,
     connector::ptr connector, channel_handler handler)
 {
     unpend(connector);
+    count_connect(ec);
 
     if (ec)
     {
@@ -180,6 +187,9 @@ void session_manual::attach_protocols(channel::ptr channel)
     if (version >= message::version::level::bip61)
         attach<protocol_reject_70002>(channel)->start();
 
+    if (version >= message::version::level::bip133)
+        attach<protocol_fee_filter_70013>(channel)->start();
+
     attach<protocol_address_31402>(channel)->start();
 }
 
@@ -18,11 +18,16 @@
  */
 #include <bitcoin/network/sessions/session_outbound.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/anchors.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_fee_filter_70013.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
@@ -36,8 +41,13 @@ namespace network {
 
 using namespace std::placeholders;
 
+// The backoff doubles per consecutive failure, up to this many doublings.
+static const size_t maximum_doublings = 16;
+
 session_outbound::session_outbound(p2p& network, bool notify_on_connect)
   : session_batch(network, notify_on_connect),
+    blocked_failures_(0),
+    network_failures_(0),
     CONSTRUCT_TRACK(session_outbound)
 {
 }
@@ -69,7 +79,23 @@ void session_outbound::handle_started(const code& ec, result_handler handler)
         return;
     }
 
-    for (size_t peer = 0; peer < settings_.outbound_connections; ++peer)
+    config::authority::list peers;
+    const auto result = anchors::load(settings_.anchors_file, peers);
+
+    if (result)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Error loading anchor peers: " << result.message();
+    }
+
+    const auto anchored = std::min<size_t>(peers.size(),
+        std::min(settings_.anchor_connections,
+            settings_.outbound_connections));
+
+    for (size_t peer = 0; peer < anchored; ++peer)
+        connect_anchor(peers[peer]);
+
+    for (auto peer = anchored; peer < settings_.outbound_connections; ++peer)
         new_connection(error::success);
 
     // This is the end of the start sequence.
@@ -98,16 +124,124 @@ void session_outbound::handle_connect(const code& ec, channel::ptr channel)
         LOG_DEBUG(LOG_NETWORK)
             << "Failure connecting outbound: " << ec.message();
 
-        // Retry with conditional delay in case of network error.
-        dispatch_delayed(cycle_delay(ec), BIND1(new_connection, _1));
+        if (stopped(ec))
+            return;
+
+        // An empty pool is not recovered by retry, only by new addresses.
+        if (ec == error::not_found)
+        {
+            await_hosts();
+            return;
+        }
+
+        dispatch_delayed(backoff(ec), BIND1(new_connection, _1));
         return;
     }
 
+    blocked_failures_ = 0;
+    network_failures_ = 0;
+
     register_channel(channel,
         BIND2(handle_channel_start, _1, channel),
         BIND2(handle_channel_stop, _1, channel));
 }
 
+// Anchor connections.
+// ----------------------------------------------------------------------------
+
+// An anchor occupies a slot, which reverts to the address pool upon failure.
+void session_outbound::connect_anchor(const config::authority& host)
+{
+    if (stopped())
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Suspended anchor connection.";
+        return;
+    }
+
+    if (blacklisted(host))
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Anchor on blacklisted address [" << host << "]";
+        new_connection(error::success);
+        return;
+    }
+
+    LOG_INFO(LOG_NETWORK)
+        << "Connecting to anchor [" << host << "]";
+
+    const auto connector = create_connector();
+    pend(connector);
+    attempted(host);
+
+    // OUTBOUND CONNECT
+    connector->connect(host,
+        BIND4(handle_anchor, _1, _2, host, connector));
+}
+
+void session_outbound::handle_anchor(const code& ec, channel::ptr channel,
+    const config::authority& host, connector::ptr connector)
+{
+    unpend(connector);
+    count_connect(ec);
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure connecting to anchor [" << host << "] "
+            << ec.message();
+
+        if (stopped(ec))
+            return;
+
+        failed(host);
+        new_connection(error::success);
+        return;
+    }
+
+    handle_connect(ec, channel);
+}
+
+// Backoff.
+// ----------------------------------------------------------------------------
+
+// The delay is randomized so that slots do not retry in lockstep.
+asio::duration session_outbound::backoff(const code& ec)
+{
+    auto& failures = ec == error::address_blocked ? blocked_failures_ :
+        network_failures_;
+
+    const auto doublings = std::min(failures++, maximum_doublings);
+    const auto delay = std::min(settings_.outbound_backoff_maximum(),
+        settings_.outbound_backoff() *
+            (asio::duration::rep(1) << doublings));
+
+    return pseudo_random::duration(delay);
+}
+
+void session_outbound::await_hosts()
+{
+    LOG_DEBUG(LOG_NETWORK)
+        << "Outbound connection awaiting addresses.";
+
+    const auto woken = std::make_shared<std::atomic<bool>>(false);
+    const result_handler wake = BIND2(handle_hosts, _1, woken);
+    network_.subscribe_hosts(wake);
+
+    // An address stored before the subscription would otherwise be missed.
+    if (address_count() != 0)
+        wake(error::success);
+}
+
+// Either the subscription or the recheck wakes the slot, not both.
+void session_outbound::handle_hosts(const code& ec, wake_flag woken)
+{
+    if (woken->exchange(true) || stopped(ec))
+        return;
+
+    new_connection(error::success);
+}
+
 void session_outbound::handle_channel_start(const code& ec,
     channel::ptr channel)
 {
@@ -117,6 +251,10 @@ void session_outbound::handle_channel_start(const code& ec,
         LOG_DEBUG(LOG_NETWORK)
             << "Outbound channel failed to start ["
             << channel->authority() << "] " << ec.message();
+
+        if (ec != error::service_stopped)
+            failed(channel->authority());
+
         return;
     }
 
@@ -124,6 +262,9 @@ void session_outbound::handle_channel_start(const code& ec,
         << "Connected outbound channel [" << channel->authority() << "] ("
         << connection_count() << ")";
 
+    succeeded(channel->authority());
+    channel->set_outbound(true);
+
     attach_protocols(channel);
 }
 
@@ -139,6 +280,9 @@ void session_outbound::attach_protocols(channel::ptr channel)
     if (version >= message::version::level::bip61)
         attach<protocol_reject_70002>(channel)->start();
 
+    if (version >= message::version::level::bip133)
+        attach<protocol_fee_filter_70013>(channel)->start();
+
     attach<protocol_address_31402>(channel)->start();
 }
 
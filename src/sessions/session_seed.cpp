@@ -46,6 +46,11 @@ session_seed::session_seed(p2p& network)
 {
 }
 
+metrics::session_type session_seed::metrics_type() const
+{
+    return metrics::session_type::seed;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
@@ -159,6 +164,7 @@ void session_seed::handle_connect(const code& ec, channel::ptr channel,
     result_handler handler)
 {
     unpend(connector);
+    count_connect(ec);
 
     if (ec)
     {
@@ -30,23 +30,55 @@ using namespace bc::message;
 // Common default values (no settings context).
 settings::settings()
   : threads(0),
+    channel_shards(false),
     protocol_maximum(version::level::maximum),
     protocol_minimum(version::level::minimum),
     services(version::service::none),
     invalid_services(176),
     relay_transactions(false),
+    minimum_fee_rate(0),
     validate_checksum(false),
+    progressive_decoding(false),
     inbound_connections(0),
+    inbound_acceptors(1),
+    inbound_address_connections(4),
+    inbound_subnet_connections(16),
+    inbound_accepts_per_minute(0),
+    inbound_subnet_accepts_per_minute(60),
+    inbound_accept_burst(10),
+    inbound_eviction(false),
+    inbound_eviction_protected(4),
     outbound_connections(8),
     manual_attempt_limit(0),
     connect_batch_size(5),
+    connect_batch_minimum(1),
+    connect_batch_maximum(16),
     connect_timeout_seconds(5),
+    connect_stagger_milliseconds(250),
+    outbound_backoff_milliseconds(500),
+    outbound_backoff_maximum_seconds(60),
+    dns_cache_seconds(300),
+    dns_failure_seconds(30),
     channel_handshake_seconds(30),
     channel_germination_seconds(30),
     channel_heartbeat_minutes(5),
     channel_inactivity_minutes(10),
     channel_expiration_minutes(1440),
+    timer_wheel_milliseconds(0),
+    channel_pending_messages(100),
+    channel_pending_bytes(16 * 1024 * 1024),
+    read_kilobytes_per_second(0),
+    write_kilobytes_per_second(0),
+    channel_read_kilobytes_per_second(0),
+    channel_write_kilobytes_per_second(0),
+    announcement_trickle_milliseconds(500),
+    announcement_batch_size(1000),
+    buffer_budget_megabytes(512),
     host_pool_capacity(0),
+    host_pool_checkpoint_minutes(5),
+    concurrent_seeding(false),
+    anchor_connections(2),
+    anchor_minimum_minutes(10),
     self(unspecified_network_address),
 
     // [log]
@@ -54,13 +86,18 @@ settings::settings()
     error_file("error.log"),
     archive_directory("archive"),
     hosts_file("hosts.cache"),
+    anchors_file("anchors.cache"),
     rotation_size(0),
     minimum_free_space(0),
     maximum_archive_size(0),
     maximum_archive_files(0),
     statistics_server(unspecified_network_address),
+    statistics_interval_seconds(10),
     verbose(false)
 {
+    // Inbound and manual sockets are kept alive, so a dead peer is detected.
+    inbound_socket.keep_alive = true;
+    manual_socket.keep_alive = true;
 }
 
 // This parameterized constructor also delegates to a target, the default initializing constructor
@@ -82,6 +119,7 @@ settings::settings(config::settings context)
             LOG_INFO(LOG_NETWORK) << "Using network context: config::settings::mainnet";
 
             hosts_file = "hosts_node.cache";
+            anchors_file = "anchors_node.cache";
             debug_file = "debug_node.log";
             error_file = "error_node.log";
             archive_directory = "archive-node";
@@ -99,6 +137,7 @@ settings::settings(config::settings context)
             LOG_INFO(LOG_NETWORK) << "Using network context: config::settings::testnet";
 
             hosts_file = "testnet_hosts_node.cache";
+            anchors_file = "testnet_anchors_node.cache";
             debug_file = "debug_testnet_node.log";
             error_file = "error_testnet_node.log";
             archive_directory = "archive-testnet-node";
@@ -116,6 +155,7 @@ settings::settings(config::settings context)
             LOG_INFO(LOG_NETWORK) << "Using network context: config::settings::regtest";
 
             hosts_file = "regtest_hosts_node.cache";
+            anchors_file = "regtest_anchors_node.cache";
             debug_file = "debug_regtest_node.log";
             error_file = "error_regtest_node.log";
             archive_directory = "archive-regtest-node";
@@ -131,6 +171,7 @@ settings::settings(config::settings context)
             LOG_INFO(LOG_NETWORK) << "Using network context: config::settings::mainnet_server";
 
             hosts_file = "hosts_server.cache";
+            anchors_file = "anchors_server.cache";
             debug_file = "debug_server.log";
             error_file = "error_server.log";
             archive_directory = "archive-server";
@@ -148,6 +189,7 @@ settings::settings(config::settings context)
             LOG_INFO(LOG_NETWORK) << "Using network context: config::settings::testnet_server";
 
             hosts_file = "testnet_hosts_server.cache";
+            anchors_file = "testnet_anchors_server.cache";
             debug_file = "debug_testnet_node.log";
             error_file = "error_testnet_node.log";
             archive_directory = "archive-testnet-server";
@@ -165,6 +207,7 @@ settings::settings(config::settings context)
             LOG_INFO(LOG_NETWORK) << "Using network context: config::settings::regtest_server";
 
             hosts_file = "regtest_hosts_server.cache";
+            anchors_file = "regtest_anchors_server.cache";
             debug_file = "debug_regtest_node.log";
             error_file = "error_regtest_node.log";
             archive_directory = "archive-regtest-server";
@@ -185,6 +228,7 @@ settings::settings(config::settings context)
     LOG_INFO(LOG_NETWORK) << "Using error log file: " << error_file;
     LOG_INFO(LOG_NETWORK) << "Using archive directory: " << archive_directory;
     LOG_INFO(LOG_NETWORK) << "Using hosts cache file: " << hosts_file;
+    LOG_INFO(LOG_NETWORK) << "Using anchors cache file: " << anchors_file;
     LOG_INFO(LOG_NETWORK) << "Using identifier: " << identifier;
     LOG_INFO(LOG_NETWORK) << "Using inbound_port: " << inbound_port;
 }
@@ -199,6 +243,31 @@ duration settings::connect_timeout() const
     return seconds(connect_timeout_seconds);
 }
 
+duration settings::connect_stagger() const
+{
+    return milliseconds(connect_stagger_milliseconds);
+}
+
+duration settings::outbound_backoff() const
+{
+    return milliseconds(outbound_backoff_milliseconds);
+}
+
+duration settings::outbound_backoff_maximum() const
+{
+    return seconds(outbound_backoff_maximum_seconds);
+}
+
+duration settings::dns_cache_expiration() const
+{
+    return seconds(dns_cache_seconds);
+}
+
+duration settings::dns_failure_expiration() const
+{
+    return seconds(dns_failure_seconds);
+}
+
 duration settings::channel_handshake() const
 {
     return seconds(channel_handshake_seconds);
@@ -224,5 +293,30 @@ duration settings::channel_germination() const
     return seconds(channel_germination_seconds);
 }
 
+duration settings::host_pool_checkpoint() const
+{
+    return minutes(host_pool_checkpoint_minutes);
+}
+
+duration settings::anchor_minimum() const
+{
+    return minutes(anchor_minimum_minutes);
+}
+
+duration settings::timer_wheel_resolution() const
+{
+    return milliseconds(timer_wheel_milliseconds);
+}
+
+duration settings::announcement_trickle() const
+{
+    return milliseconds(announcement_trickle_milliseconds);
+}
+
+duration settings::statistics_interval() const
+{
+    return seconds(statistics_interval_seconds);
+}
+
 } // namespace network
 } // namespace libbitcoin
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/short_id.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+static const uint64_t short_id_mask = 0x0000ffffffffffff;
+
+static inline uint64_t rotate(uint64_t value, size_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2,
+    uint64_t& v3)
+{
+    v0 += v1; v1 = rotate(v1, 13); v1 ^= v0; v0 = rotate(v0, 32);
+    v2 += v3; v3 = rotate(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotate(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotate(v1, 17); v1 ^= v2; v2 = rotate(v2, 32);
+}
+
+static inline uint64_t read_word(const uint8_t* data)
+{
+    uint64_t value = 0;
+
+    for (size_t byte = 0; byte < sizeof(uint64_t); ++byte)
+        value |= uint64_t(data[byte]) << (8 * byte);
+
+    return value;
+}
+
+// The key is the first 16 bytes of the sha256 of the header and nonce.
+short_id::key short_id::to_key(const chain::header& header, uint64_t nonce)
+{
+    auto preimage = header.to_data();
+    extend_data(preimage, to_little_endian(nonce));
+    const auto digest = sha256_hash(preimage);
+    return { read_word(digest.data()), read_word(digest.data() + 8) };
+}
+
+// The hash is a multiple of the word size, so there is no partial word.
+uint64_t short_id::siphash(const key& key, const hash_digest& hash)
+{
+    auto v0 = key.first ^ 0x736f6d6570736575;
+    auto v1 = key.second ^ 0x646f72616e646f6d;
+    auto v2 = key.first ^ 0x6c7967656e657261;
+    auto v3 = key.second ^ 0x7465646279746573;
+
+    for (size_t offset = 0; offset < hash_size; offset += sizeof(uint64_t))
+    {
+        const auto word = read_word(hash.data() + offset);
+        v3 ^= word;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= word;
+    }
+
+    const auto last = uint64_t(hash_size) << 56;
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t short_id::compute(const key& key, const hash_digest& hash)
+{
+    return siphash(key, hash) & short_id_mask;
+}
+
+mini_hash short_id::to_mini_hash(uint64_t value)
+{
+    mini_hash out;
+
+    for (size_t byte = 0; byte < out.size(); ++byte)
+        out[byte] = static_cast<uint8_t>(value >> (8 * byte));
+
+    return out;
+}
+
+uint64_t short_id::to_number(const mini_hash& value)
+{
+    uint64_t out = 0;
+
+    for (size_t byte = 0; byte < value.size(); ++byte)
+        out |= uint64_t(value[byte]) << (8 * byte);
+
+    return out;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/slab.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+// Each class is grown by a slab of about this size (or one block).
+static constexpr size_t slab_size = 64 * 1024;
+
+// static
+// The instance is never destroyed, as pooled objects may be released during
+// static destruction, and the slabs are reclaimed with the process.
+slab& slab::shared()
+{
+    static const auto instance = new slab();
+    return *instance;
+}
+
+slab::slab()
+{
+}
+
+slab::~slab()
+{
+    for (auto& sizes: classes_)
+        for (const auto block: sizes.slabs)
+            delete[] block;
+}
+
+// static
+size_t slab::to_class(size_t size)
+{
+    return (std::max(size, size_t(1)) - 1) / granularity;
+}
+
+void* slab::allocate(size_t size)
+{
+    if (size > maximum)
+        return ::operator new(size);
+
+    auto& sizes = classes_[to_class(size)];
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(sizes.mutex);
+
+    if (sizes.free.empty())
+        grow(sizes, (to_class(size) + 1) * granularity);
+
+    const auto block = sizes.free.back();
+    sizes.free.pop_back();
+    return block;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void slab::deallocate(void* block, size_t size)
+{
+    if (size > maximum)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    auto& sizes = classes_[to_class(size)];
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(sizes.mutex);
+    sizes.free.push_back(block);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The new[] alignment of the slab and the granularity of the block size
+// align each block for any fundamental type.
+void slab::grow(size_class& sizes, size_t block_size)
+{
+    const auto count = std::max(slab_size / block_size, size_t(1));
+    const auto block = new uint8_t[count * block_size];
+    sizes.slabs.push_back(block);
+    sizes.free.reserve(sizes.free.size() + count);
+
+    for (size_t index = 0; index < count; ++index)
+        sizes.free.push_back(block + index * block_size);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/socket_profile.hpp>
+
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace boost::asio;
+
+// Retain the first failure, subsequent options are still applied.
+template <typename Socket, typename Option>
+static void set(Socket& socket, const Option& option, boost_code& first)
+{
+    boost_code ec;
+    socket.set_option(option, ec);
+
+    if (ec && !first)
+        first = ec;
+}
+
+template <typename Socket>
+static void set_buffers(Socket& socket, uint32_t send, uint32_t receive,
+    boost_code& first)
+{
+    if (send != 0)
+        set(socket, socket_base::send_buffer_size(static_cast<int>(send)),
+            first);
+
+    if (receive != 0)
+        set(socket, socket_base::receive_buffer_size(
+            static_cast<int>(receive)), first);
+}
+
+socket_profile::socket_profile()
+  : no_delay(true),
+    keep_alive(false),
+    send_buffer_bytes(0),
+    receive_buffer_bytes(0)
+{
+}
+
+code socket_profile::apply(asio::socket& socket) const
+{
+    boost_code first;
+    set(socket, ip::tcp::no_delay(no_delay), first);
+    set(socket, socket_base::keep_alive(keep_alive), first);
+    set_buffers(socket, send_buffer_bytes, receive_buffer_bytes, first);
+    return error::boost_to_error_code(first);
+}
+
+code socket_profile::apply(asio::acceptor& acceptor) const
+{
+    boost_code first;
+    set_buffers(acceptor, send_buffer_bytes, receive_buffer_bytes, first);
+    return error::boost_to_error_code(first);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,214 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/statsd.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::placeholders;
+using namespace boost::asio;
+
+std::vector<std::string> statsd::format(const std::string& prefix,
+    const gauges& values, size_t datagram_size)
+{
+    std::vector<std::string> out;
+    std::string datagram;
+
+    for (const auto& value: values)
+    {
+        const auto line = prefix + value.first + ":" +
+            std::to_string(value.second) + "|g";
+
+        if (!datagram.empty() &&
+            datagram.size() + 1 + line.size() > datagram_size)
+        {
+            out.push_back(std::move(datagram));
+            datagram.clear();
+        }
+
+        if (!datagram.empty())
+            datagram += "\n";
+
+        datagram += line;
+    }
+
+    if (!datagram.empty())
+        out.push_back(std::move(datagram));
+
+    return out;
+}
+
+statsd::statsd(threadpool& pool, const config::authority& server,
+    const asio::duration& interval, const std::string& prefix)
+  : pool_(pool),
+    interval_(interval),
+    prefix_(prefix),
+    endpoint_(server.asio_ip(), server.port()),
+    stopped_(true),
+    socket_(pool.service())
+{
+}
+
+// Start/stop.
+// ----------------------------------------------------------------------------
+
+bool statsd::start(collector collect)
+{
+    boost_code ec;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    if (!stopped_)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    socket_.open(endpoint_.protocol(), ec);
+
+    if (ec)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        LOG_WARNING(LOG_NETWORK)
+            << "Failed to open statistics socket: " << ec.message();
+        return false;
+    }
+
+    stopped_ = false;
+    collect_ = collect;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    start_timer();
+    return true;
+}
+
+void statsd::stop()
+{
+    boost_code ignore;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    stopped_ = true;
+    collect_ = nullptr;
+    socket_.close(ignore);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto timer = timer_.load();
+
+    if (timer)
+        timer->stop();
+}
+
+// Report sequence.
+// ----------------------------------------------------------------------------
+
+// private
+void statsd::start_timer()
+{
+    const auto timer = std::make_shared<deadline>(pool_, interval_);
+    timer_.store(timer);
+    timer->start(
+        std::bind(&statsd::handle_timer,
+            shared_from_this(), _1));
+}
+
+// private
+// Gauges are collected outside of the lock, as the collector may be slow.
+void statsd::handle_timer(const code& ec)
+{
+    collector collect;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock_shared();
+
+    if (stopped_ || ec == error::service_stopped)
+    {
+        mutex_.unlock_shared();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    collect = collect_;
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto datagrams = format(prefix_, collect());
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    if (stopped_)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    // The datagram is retained by the handler until the send completes.
+    for (const auto& text: datagrams)
+    {
+        const auto datagram = std::make_shared<std::string>(text);
+        socket_.async_send_to(buffer(*datagram), endpoint_,
+            std::bind(&statsd::handle_send,
+                shared_from_this(), _1, _2, datagram));
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    start_timer();
+}
+
+// private
+// Statistics are best effort, a failure to send is not retried.
+void statsd::handle_send(const boost_code& ec, size_t, datagram_ptr)
+{
+    if (ec && ec != boost::asio::error::operation_aborted)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failed to send statistics to [" << endpoint_ << "] "
+            << ec.message();
+    }
+}
+
+} // namespace network
+} // namespace libbitcoin
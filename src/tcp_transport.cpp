@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/tcp_transport.hpp>
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/handler_memory.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace boost::asio;
+
+tcp_transport::tcp_transport(socket::ptr socket)
+  : socket_(socket)
+{
+}
+
+config::authority tcp_transport::authority() const
+{
+    return socket_->authority();
+}
+
+void tcp_transport::read(const mutable_buffer& buffer, size_t required,
+    strand& strand, io_handler handler)
+{
+    async_read(socket_->get(), buffer, transfer_at_least(required),
+        bind_executor(strand, make_allocating(read_memory_, handler)));
+}
+
+void tcp_transport::write(const const_buffers& buffers, strand& strand,
+    io_handler handler)
+{
+    async_write(socket_->get(), buffers,
+        bind_executor(strand, make_allocating(write_memory_, handler)));
+}
+
+void tcp_transport::stop()
+{
+    socket_->stop();
+}
+
+} // namespace network
+} // namespace libbitcoin
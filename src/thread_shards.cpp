@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/thread_shards.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+thread_shards::thread_shards(threadpool& fallback)
+  : fallback_(fallback),
+    next_(0)
+{
+}
+
+// Shards are retained across restarts, as channels hold pool references.
+void thread_shards::spawn(size_t count, thread_priority priority)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (shards_.empty())
+    {
+        shards_.reserve(count);
+
+        for (size_t shard = 0; shard < count; ++shard)
+            shards_.push_back(std::make_shared<threadpool>());
+    }
+
+    for (const auto pool: shards_)
+    {
+        pool->join();
+        pool->spawn(1, priority);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+threadpool& thread_shards::next()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    if (shards_.empty())
+        return fallback_;
+
+    return *shards_[next_++ % shards_.size()];
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t thread_shards::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return shards_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void thread_shards::shutdown()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    for (const auto pool: shards_)
+        pool->shutdown();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void thread_shards::join()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    for (const auto pool: shards_)
+        pool->join();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
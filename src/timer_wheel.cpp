@@ -0,0 +1,311 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/timer_wheel.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::chrono;
+using namespace std::placeholders;
+
+// Each of four levels has 64 slots, each slot of a level spans the range of
+// the level below. At a one second tick the wheel spans over 194 days, and
+// a longer period is placed in the last slot reached, to be rescheduled.
+static constexpr size_t slot_bits = 6;
+static constexpr size_t slot_count = size_t(1) << slot_bits;
+static constexpr size_t slot_mask = slot_count - 1;
+static constexpr size_t level_count = 4;
+static constexpr uint64_t wheel_span = uint64_t(1) <<
+    (slot_bits * level_count);
+
+timer_wheel::timer_wheel(threadpool& pool, const asio::duration& resolution)
+  : pool_(pool),
+    resolution_(std::max(static_cast<int64_t>(
+        duration_cast<milliseconds>(resolution).count()), int64_t(1))),
+    epoch_(clock::now()),
+    stopped_(true),
+    size_(0),
+    current_(0),
+    levels_(level_count, std::vector<slot>(slot_count))
+{
+}
+
+// Properties.
+// ----------------------------------------------------------------------------
+
+size_t timer_wheel::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return size_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+uint64_t timer_wheel::to_ticks(const asio::duration& period) const
+{
+    const auto count = static_cast<int64_t>(
+        duration_cast<milliseconds>(period).count());
+    const auto ticks = (std::max(count, int64_t(0)) + resolution_ - 1) /
+        resolution_;
+
+    // A timer expires no sooner than the next tick.
+    return std::max(static_cast<uint64_t>(ticks), uint64_t(1));
+}
+
+// private
+uint64_t timer_wheel::elapsed() const
+{
+    const auto count = duration_cast<milliseconds>(clock::now() - epoch_)
+        .count();
+    return static_cast<uint64_t>(count) / resolution_;
+}
+
+// Start/stop.
+// ----------------------------------------------------------------------------
+
+void timer_wheel::start()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    if (!stopped_)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    stopped_ = false;
+    current_ = elapsed();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    start_tick();
+}
+
+void timer_wheel::stop()
+{
+    std::vector<std::vector<slot>> levels(level_count,
+        std::vector<slot>(slot_count));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    stopped_ = true;
+    size_ = 0;
+    std::swap(levels, levels_);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto ticker = ticker_.load();
+
+    if (ticker)
+        ticker->stop();
+
+    // The dropped handlers (and their bound references) are freed here.
+}
+
+// Timers.
+// ----------------------------------------------------------------------------
+
+timer_wheel::timer_ptr timer_wheel::schedule(const asio::duration& period,
+    result_handler handler)
+{
+    const auto timer = std::make_shared<entry>();
+    timer->period = to_ticks(period);
+    timer->handler = handler;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+    {
+        timer->handler = nullptr;
+        return timer;
+    }
+
+    timer->expiry = current_ + timer->period;
+    insert(timer);
+    ++size_;
+    return timer;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// This takes no lock, the expiry is read when the timer's slot is reached.
+void timer_wheel::touch(timer_ptr timer) const
+{
+    timer->expiry.store(elapsed() + timer->period);
+}
+
+void timer_wheel::cancel(timer_ptr timer)
+{
+    result_handler handler;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    // The entry remains in its slot until reached, without its handler.
+    if (timer->handler)
+    {
+        std::swap(handler, timer->handler);
+        --size_;
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The handler (and its bound references) is freed outside of the lock.
+}
+
+// Tick.
+// ----------------------------------------------------------------------------
+
+// private
+void timer_wheel::start_tick()
+{
+    const auto ticker = std::make_shared<deadline>(pool_,
+        milliseconds(resolution_));
+    ticker_.store(ticker);
+    ticker->start(
+        std::bind(&timer_wheel::handle_tick,
+            shared_from_this(), _1));
+}
+
+// private
+// The wheel catches up to the clock, as a tick may be delayed.
+void timer_wheel::handle_tick(const code& ec)
+{
+    std::vector<result_handler> expired;
+    const auto target = elapsed();
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    if (stopped_ || ec == error::service_stopped)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    while (current_ < target)
+    {
+        ++current_;
+
+        // Higher levels are cascaded as each lower level wraps.
+        for (size_t level = 1; level < level_count; ++level)
+        {
+            if ((current_ & ((uint64_t(1) << (slot_bits * level)) - 1)) != 0)
+                break;
+
+            cascade(level);
+        }
+
+        expire(expired);
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Handlers are posted so that expiries do not serialize on this thread.
+    for (const auto& handler: expired)
+        boost::asio::post(pool_.service(),
+            std::bind(handler, error::success));
+
+    start_tick();
+}
+
+// private
+// Place the timer in the lowest level that spans its remaining ticks.
+void timer_wheel::insert(timer_ptr timer)
+{
+    const auto expiry = std::max(timer->expiry.load(), current_);
+    const auto remaining = std::min(expiry - current_, wheel_span - 1);
+    const auto target = current_ + remaining;
+
+    size_t level = 0;
+    while (level + 1 < level_count &&
+        remaining >= (uint64_t(1) << (slot_bits * (level + 1))))
+        ++level;
+
+    const auto index = (target >> (slot_bits * level)) & slot_mask;
+    levels_[level][index].push_back(timer);
+}
+
+// private
+// Redistribute the current slot of a level to the levels below it.
+void timer_wheel::cascade(size_t level)
+{
+    const auto index = (current_ >> (slot_bits * level)) & slot_mask;
+    slot timers;
+    std::swap(timers, levels_[level][index]);
+
+    for (const auto& timer: timers)
+        if (timer->handler)
+            insert(timer);
+}
+
+// private
+// Fire the due timers of the current level zero slot, rescheduling those
+// whose expiry has been moved by touch.
+void timer_wheel::expire(std::vector<result_handler>& expired)
+{
+    const auto index = current_ & slot_mask;
+    slot timers;
+    std::swap(timers, levels_[0][index]);
+
+    for (const auto& timer: timers)
+    {
+        if (!timer->handler)
+            continue;
+
+        if (timer->expiry.load() > current_)
+        {
+            insert(timer);
+            continue;
+        }
+
+        expired.push_back(std::move(timer->handler));
+        timer->handler = nullptr;
+        --size_;
+    }
+}
+
+} // namespace network
+} // namespace libbitcoin
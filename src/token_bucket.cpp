@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/token_bucket.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::chrono;
+
+static token_bucket::clock::rep now_ticks()
+{
+    return token_bucket::clock::now().time_since_epoch().count();
+}
+
+token_bucket::token_bucket(double rate, double capacity)
+  : rate_(rate),
+    capacity_(capacity),
+    burst_(to_ticks(capacity)),
+    full_(now_ticks())
+{
+}
+
+// private
+// The time in which the tokens are restored at the rate.
+token_bucket::clock::rep token_bucket::to_ticks(double tokens) const
+{
+    if (rate_ == 0)
+        return 0;
+
+    const duration<double> seconds(tokens / rate_);
+    return duration_cast<clock::duration>(seconds).count();
+}
+
+// private
+// Advance the full time by the tokens, unless refused for lack of balance.
+// Returns the time by which the bucket is then overdrawn, or -1 if refused.
+token_bucket::clock::rep token_bucket::consume(double tokens, bool overdraw)
+{
+    const auto now = now_ticks();
+    const auto cost = to_ticks(tokens);
+    auto full = full_.load();
+    clock::rep next;
+
+    do
+    {
+        next = std::max(full, now) + cost;
+
+        if (!overdraw && next - now > burst_)
+            return -1;
+
+    } while (!full_.compare_exchange_weak(full, next));
+
+    return std::max(next - now - burst_, clock::rep(0));
+}
+
+bool token_bucket::try_consume(double tokens)
+{
+    return rate_ == 0 || consume(tokens, false) >= 0;
+}
+
+asio::duration token_bucket::defer(double tokens)
+{
+    if (rate_ == 0)
+        return asio::duration::zero();
+
+    const clock::duration deficit(consume(tokens, true));
+    return duration_cast<asio::duration>(deficit);
+}
+
+bool token_bucket::full() const
+{
+    return rate_ == 0 || full_.load() <= now_ticks();
+}
+
+double token_bucket::available() const
+{
+    if (rate_ == 0)
+        return capacity_;
+
+    const auto pending = std::max(full_.load() - now_ticks(), clock::rep(0));
+    const duration<double> seconds = clock::duration(pending);
+    return capacity_ - seconds.count() * rate_;
+}
+
+double token_bucket::rate() const
+{
+    return rate_;
+}
+
+double token_bucket::capacity() const
+{
+    return capacity_;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/traffic.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::message;
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+
+typedef std::array<std::string, traffic::command_count - 1> command_names;
+
+// The last index counts unrecognized commands.
+// Function scope avoids dependence on the static initialization of commands.
+static const command_names& names()
+{
+    static const command_names commands
+    {
+        {
+            address::command,
+            alert::command,
+            block::command,
+            block_transactions::command,
+            compact_block::command,
+            fee_filter::command,
+            filter_add::command,
+            filter_clear::command,
+            filter_load::command,
+            get_address::command,
+            get_blocks::command,
+            get_block_transactions::command,
+            get_data::command,
+            get_headers::command,
+            headers::command,
+            inventory::command,
+            memory_pool::command,
+            merkle_block::command,
+            not_found::command,
+            ping::command,
+            pong::command,
+            reject::command,
+            send_compact::command,
+            send_headers::command,
+            transaction::command,
+            verack::command,
+            version::command
+        }
+    };
+
+    return commands;
+}
+
+static const std::string unknown_command = "unknown";
+
+traffic::traffic()
+  : commands_(),
+    reads_(0),
+    read_microseconds_(0),
+    writes_(0),
+    write_microseconds_(0),
+    queued_(0)
+{
+}
+
+// static
+size_t traffic::to_index(const std::string& command)
+{
+    static const auto indexes = []()
+    {
+        std::unordered_map<std::string, size_t> map;
+
+        for (size_t index = 0; index < names().size(); ++index)
+            map.emplace(names()[index], index);
+
+        return map;
+    }();
+
+    const auto it = indexes.find(command);
+    return it == indexes.end() ? names().size() : it->second;
+}
+
+// private
+uint64_t traffic::to_microseconds(const asio::duration& elapsed)
+{
+    const auto count = std::chrono::duration_cast<std::chrono::microseconds>(
+        elapsed).count();
+    return count < 0 ? 0 : static_cast<uint64_t>(count);
+}
+
+void traffic::add(const tally& counts)
+{
+    if (counts.empty_)
+        return;
+
+    for (size_t index = 0; index < commands_.size(); ++index)
+    {
+        const auto& command = counts.commands_[index];
+
+        if (command.messages_in == 0 && command.messages_out == 0)
+            continue;
+
+        auto& target = commands_[index];
+        target.messages_in.fetch_add(command.messages_in, relaxed);
+        target.bytes_in.fetch_add(command.bytes_in, relaxed);
+        target.messages_out.fetch_add(command.messages_out, relaxed);
+        target.bytes_out.fetch_add(command.bytes_out, relaxed);
+    }
+
+    reads_.fetch_add(counts.reads_, relaxed);
+    read_microseconds_.fetch_add(counts.read_microseconds_, relaxed);
+    writes_.fetch_add(counts.writes_, relaxed);
+    write_microseconds_.fetch_add(counts.write_microseconds_, relaxed);
+    // The difference wraps when negative, as does the unsigned sum.
+    queued_.fetch_add(counts.enqueued_ - counts.dequeued_, relaxed);
+}
+
+void traffic::received(const std::string& command, size_t bytes)
+{
+    auto& counts = commands_[to_index(command)];
+    counts.messages_in.fetch_add(1, relaxed);
+    counts.bytes_in.fetch_add(bytes, relaxed);
+}
+
+void traffic::sent(const std::string& command, size_t bytes,
+    const asio::duration& elapsed)
+{
+    auto& counts = commands_[to_index(command)];
+    counts.messages_out.fetch_add(1, relaxed);
+    counts.bytes_out.fetch_add(bytes, relaxed);
+    writes_.fetch_add(1, relaxed);
+    write_microseconds_.fetch_add(to_microseconds(elapsed), relaxed);
+}
+
+void traffic::read(const asio::duration& elapsed)
+{
+    reads_.fetch_add(1, relaxed);
+    read_microseconds_.fetch_add(to_microseconds(elapsed), relaxed);
+}
+
+void traffic::enqueued(size_t count)
+{
+    queued_.fetch_add(count, relaxed);
+}
+
+void traffic::dequeued(size_t count)
+{
+    queued_.fetch_sub(count, relaxed);
+}
+
+traffic::snapshot traffic::collect() const
+{
+    snapshot out{};
+
+    for (size_t index = 0; index < commands_.size(); ++index)
+    {
+        const auto& counts = commands_[index];
+        const totals command
+        {
+            counts.messages_in.load(relaxed),
+            counts.bytes_in.load(relaxed),
+            counts.messages_out.load(relaxed),
+            counts.bytes_out.load(relaxed)
+        };
+
+        if (command.messages_in == 0 && command.messages_out == 0)
+            continue;
+
+        out.total.messages_in += command.messages_in;
+        out.total.bytes_in += command.bytes_in;
+        out.total.messages_out += command.messages_out;
+        out.total.bytes_out += command.bytes_out;
+        out.commands.push_back({ index < names().size() ? names()[index] :
+            unknown_command, command });
+    }
+
+    out.reads = reads_.load(relaxed);
+    out.read_microseconds = read_microseconds_.load(relaxed);
+    out.writes = writes_.load(relaxed);
+    out.write_microseconds = write_microseconds_.load(relaxed);
+    out.queued = queued_.load(relaxed);
+    return out;
+}
+
+// Tally.
+// ----------------------------------------------------------------------------
+
+traffic::tally::tally()
+  : commands_(),
+    reads_(0),
+    read_microseconds_(0),
+    writes_(0),
+    write_microseconds_(0),
+    enqueued_(0),
+    dequeued_(0),
+    empty_(true)
+{
+}
+
+void traffic::tally::received(size_t index, size_t bytes)
+{
+    auto& counts = commands_[index];
+    ++counts.messages_in;
+    counts.bytes_in += bytes;
+    empty_ = false;
+}
+
+void traffic::tally::sent(size_t index, size_t bytes,
+    const asio::duration& elapsed)
+{
+    auto& counts = commands_[index];
+    ++counts.messages_out;
+    counts.bytes_out += bytes;
+    ++writes_;
+    write_microseconds_ += to_microseconds(elapsed);
+    empty_ = false;
+}
+
+void traffic::tally::read(const asio::duration& elapsed)
+{
+    ++reads_;
+    read_microseconds_ += to_microseconds(elapsed);
+    empty_ = false;
+}
+
+void traffic::tally::enqueued(size_t count)
+{
+    enqueued_ += count;
+    empty_ = false;
+}
+
+void traffic::tally::dequeued(size_t count)
+{
+    dequeued_ += count;
+    empty_ = false;
+}
+
+bool traffic::tally::empty() const
+{
+    return empty_;
+}
+
+void traffic::tally::clear()
+{
+    if (empty_)
+        return;
+
+    commands_.fill({ 0, 0, 0, 0 });
+    reads_ = 0;
+    read_microseconds_ = 0;
+    writes_ = 0;
+    write_microseconds_ = 0;
+    enqueued_ = 0;
+    dequeued_ = 0;
+    empty_ = true;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(anchors_tests)
+
+static const auto anchors_file = "anchors_tests.cache";
+
+BOOST_AUTO_TEST_CASE(anchors__load__missing__empty)
+{
+    boost::filesystem::remove(anchors_file);
+    config::authority::list peers{ { "1.2.3.4", 8333 } };
+    BOOST_REQUIRE_EQUAL(anchors::load(anchors_file, peers), error::success);
+    BOOST_REQUIRE(peers.empty());
+}
+
+BOOST_AUTO_TEST_CASE(anchors__load__saved__round_trip_and_removed)
+{
+    const config::authority::list saved
+    {
+        { "1.2.3.4", 8333 },
+        { "5.6.7.8", 18333 }
+    };
+
+    BOOST_REQUIRE_EQUAL(anchors::save(anchors_file, saved), error::success);
+
+    config::authority::list loaded;
+    BOOST_REQUIRE_EQUAL(anchors::load(anchors_file, loaded), error::success);
+    BOOST_REQUIRE_EQUAL(loaded.size(), 2u);
+    BOOST_REQUIRE(loaded[0] == saved[0]);
+    BOOST_REQUIRE(loaded[1] == saved[1]);
+    BOOST_REQUIRE(!boost::filesystem::exists(anchors_file));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(announcement_queue_tests)
+
+typedef announcement_queue::action action;
+
+static const inventory_vector transaction_item
+{
+    inventory_vector::type_id::transaction, null_hash
+};
+
+static const inventory_vector block_item
+{
+    inventory_vector::type_id::block, null_hash
+};
+
+BOOST_AUTO_TEST_CASE(announcement_queue__push__empty__none)
+{
+    announcement_queue queue(10);
+    BOOST_REQUIRE(queue.push({}) == action::none);
+    BOOST_REQUIRE_EQUAL(queue.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(announcement_queue__push__transactions__schedule_once)
+{
+    announcement_queue queue(10);
+    BOOST_REQUIRE(queue.push({ transaction_item }) == action::schedule);
+    BOOST_REQUIRE(queue.push({ transaction_item }) == action::none);
+    BOOST_REQUIRE_EQUAL(queue.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(announcement_queue__push__threshold__flush)
+{
+    announcement_queue queue(2);
+    BOOST_REQUIRE(queue.push({ transaction_item }) == action::schedule);
+    BOOST_REQUIRE(queue.push({ transaction_item }) == action::flush);
+}
+
+BOOST_AUTO_TEST_CASE(announcement_queue__push__block__flush)
+{
+    announcement_queue queue(10);
+    BOOST_REQUIRE(queue.push({ transaction_item }) == action::schedule);
+    BOOST_REQUIRE(queue.push({ block_item }) == action::flush);
+}
+
+BOOST_AUTO_TEST_CASE(announcement_queue__pop__pending__all_then_empty)
+{
+    announcement_queue queue(10);
+    queue.push({ transaction_item, transaction_item });
+    BOOST_REQUIRE_EQUAL(queue.pop().size(), 2u);
+    BOOST_REQUIRE_EQUAL(queue.size(), 0u);
+    BOOST_REQUIRE(queue.push({ transaction_item }) == action::schedule);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static message::ip_address to_ip(const std::string& host)
+{
+    uint8_t prefix;
+    message::ip_address ip;
+    BOOST_REQUIRE(blacklist::parse(host, ip, prefix));
+    BOOST_REQUIRE_EQUAL(prefix, blacklist::address_bits);
+    return ip;
+}
+
+BOOST_AUTO_TEST_SUITE(blacklist_tests)
+
+BOOST_AUTO_TEST_CASE(blacklist__parse__invalid__false)
+{
+    uint8_t prefix;
+    message::ip_address ip;
+    BOOST_REQUIRE(!blacklist::parse("", ip, prefix));
+    BOOST_REQUIRE(!blacklist::parse("example.com", ip, prefix));
+    BOOST_REQUIRE(!blacklist::parse("1.2.3.4/", ip, prefix));
+    BOOST_REQUIRE(!blacklist::parse("1.2.3.4/33", ip, prefix));
+    BOOST_REQUIRE(!blacklist::parse("2001:db8::/129", ip, prefix));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__parse__ipv4_subnet__mapped_prefix)
+{
+    uint8_t prefix;
+    message::ip_address ip;
+    BOOST_REQUIRE(blacklist::parse("10.0.0.0/8", ip, prefix));
+    BOOST_REQUIRE_EQUAL(prefix, 8u + 96u);
+    BOOST_REQUIRE(ip == to_ip("10.0.0.0"));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__contains__address__exact_only)
+{
+    blacklist instance;
+    instance.add(to_ip("1.2.3.4"));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.contains(to_ip("1.2.3.4")));
+    BOOST_REQUIRE(!instance.contains(to_ip("1.2.3.5")));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__contains__subnets__covered_only)
+{
+    blacklist instance;
+    BOOST_REQUIRE(instance.add("192.168.0.0/16"));
+    BOOST_REQUIRE(instance.add("2001:db8::/32"));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(instance.contains(to_ip("192.168.42.1")));
+    BOOST_REQUIRE(!instance.contains(to_ip("192.169.0.1")));
+    BOOST_REQUIRE(instance.contains(to_ip("2001:db8:1::1")));
+    BOOST_REQUIRE(!instance.contains(to_ip("2001:db9::1")));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__remove__subnet__removes_identical_only)
+{
+    blacklist instance;
+    BOOST_REQUIRE(instance.add("10.0.0.0/8"));
+    BOOST_REQUIRE(instance.add("10.1.0.0/16"));
+    BOOST_REQUIRE(instance.remove("10.0.0.0/8"));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(!instance.contains(to_ip("10.2.0.1")));
+    BOOST_REQUIRE(instance.contains(to_ip("10.1.0.1")));
+    BOOST_REQUIRE(instance.remove("10.1.0.0/16"));
+    BOOST_REQUIRE(!instance.contains(to_ip("10.1.0.1")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
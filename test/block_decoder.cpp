@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(block_decoder_tests)
+
+static const auto version = message::version::level::maximum;
+
+// A block of segregated transactions, each of about 32KiB, over 256KiB.
+static message::block make_witness_block(size_t count)
+{
+    chain::transaction::list transactions;
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const chain::witness witness(data_stack{ data_chunk(72, 0x42),
+            data_chunk(33, 0x02) });
+        const chain::input input({ null_hash, index }, {}, witness,
+            max_input_sequence);
+        const chain::output output(index, { data_chunk(32 * 1024, 0x6a),
+            false });
+        transactions.push_back({ 1, index, { input }, { output } });
+    }
+
+    return { chain::header{}, std::move(transactions) };
+}
+
+BOOST_AUTO_TEST_CASE(block_decoder__decode__byte_steps__expected_block)
+{
+    const message::block genesis(chain::block::genesis_mainnet());
+    const auto payload = genesis.to_data(version);
+
+    block_decoder decoder;
+    decoder.start(version, payload.size());
+    BOOST_REQUIRE(decoder.active());
+
+    for (size_t available = 0; available < payload.size(); ++available)
+        decoder.decode(payload.data(), available);
+
+    const auto block = decoder.complete(payload.data());
+    BOOST_REQUIRE(block);
+    BOOST_REQUIRE(!decoder.active());
+    BOOST_REQUIRE(*block == genesis);
+}
+
+BOOST_AUTO_TEST_CASE(block_decoder__decode__witness_block__decoded_in_parts)
+{
+    const auto expected = make_witness_block(10);
+    const auto payload = expected.to_data(version);
+    BOOST_REQUIRE(expected.transactions().front().is_segregated());
+    BOOST_REQUIRE_GT(payload.size(), 256u * 1024u);
+
+    block_decoder decoder;
+    decoder.start(version, payload.size());
+
+    for (size_t available = 0; available < payload.size();
+        available += 4096)
+    {
+        decoder.decode(payload.data(), available);
+        BOOST_REQUIRE_LE(decoder.decoded(), available);
+    }
+
+    // Every transaction was decoded in parts, consuming exactly the payload.
+    decoder.decode(payload.data(), payload.size());
+    BOOST_REQUIRE_EQUAL(decoder.decoded(), payload.size());
+
+    const auto block = decoder.complete(payload.data());
+    BOOST_REQUIRE(block);
+    BOOST_REQUIRE_EQUAL(block->transactions().size(), 10u);
+
+    for (size_t index = 0; index < 10; ++index)
+        BOOST_REQUIRE(block->transactions()[index].hash(true) ==
+            expected.transactions()[index].hash(true));
+}
+
+BOOST_AUTO_TEST_CASE(block_decoder__complete__trailing_byte__null)
+{
+    const message::block genesis(chain::block::genesis_mainnet());
+    auto payload = genesis.to_data(version);
+    payload.push_back(0x00);
+
+    block_decoder decoder;
+    decoder.start(version, payload.size());
+    decoder.decode(payload.data(), payload.size() - 1u);
+    BOOST_REQUIRE(!decoder.complete(payload.data()));
+    BOOST_REQUIRE(!decoder.active());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
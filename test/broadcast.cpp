@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(broadcast_tests)
+
+static const config::authority server{ "127.0.0.100", 100 };
+
+// Channels are stored but not started, so each send completes at once (with
+// error::channel_stopped) and only the channels sent to are recorded.
+struct broadcast_fixture
+{
+    broadcast_fixture()
+      : pool(1),
+        configuration(config::settings::mainnet),
+        network(configuration),
+        completions(0)
+    {
+    }
+
+    ~broadcast_fixture()
+    {
+        network.close();
+        pool.shutdown();
+        pool.join();
+    }
+
+    channel::ptr store(uint16_t port, uint64_t fee_filter)
+    {
+        const auto ends = loopback_transport::connect(
+            { "127.0.0.1", port }, server);
+        const auto channel = std::make_shared<network::channel>(pool,
+            ends.second, configuration);
+        channel->set_fee_filter(fee_filter);
+        transports.push_back(ends.first);
+        BOOST_REQUIRE_EQUAL(network.store(channel), error::success);
+        return channel;
+    }
+
+    void broadcast(uint64_t fee_rate)
+    {
+        network.broadcast(message::transaction{}, fee_rate,
+            [this](const code&, channel::ptr channel)
+            {
+                sent.insert(channel);
+            },
+            [this](const code& ec)
+            {
+                BOOST_REQUIRE_EQUAL(ec, error::success);
+                ++completions;
+            });
+    }
+
+    threadpool pool;
+    network::settings configuration;
+    p2p network;
+    size_t completions;
+    std::set<channel::ptr> sent;
+    std::vector<transport::ptr> transports;
+};
+
+BOOST_AUTO_TEST_CASE(broadcast__accepts_fee__default_filter__accepts_zero)
+{
+    broadcast_fixture fixture;
+    const auto channel = fixture.store(1, 0);
+    BOOST_REQUIRE(channel->accepts_fee(0));
+}
+
+BOOST_AUTO_TEST_CASE(broadcast__accepts_fee__filter__accepts_at_or_above)
+{
+    broadcast_fixture fixture;
+    const auto channel = fixture.store(1, 1000);
+    BOOST_REQUIRE(!channel->accepts_fee(999));
+    BOOST_REQUIRE(channel->accepts_fee(1000));
+    BOOST_REQUIRE(channel->accepts_fee(1001));
+}
+
+BOOST_AUTO_TEST_CASE(broadcast__fee_rate__below_filter__skipped)
+{
+    broadcast_fixture fixture;
+    const auto low = fixture.store(1, 0);
+    const auto medium = fixture.store(2, 1000);
+    const auto high = fixture.store(3, 5000);
+    fixture.broadcast(1000);
+
+    BOOST_REQUIRE_EQUAL(fixture.sent.size(), 2u);
+    BOOST_REQUIRE_EQUAL(fixture.sent.count(low), 1u);
+    BOOST_REQUIRE_EQUAL(fixture.sent.count(medium), 1u);
+    BOOST_REQUIRE_EQUAL(fixture.sent.count(high), 0u);
+    BOOST_REQUIRE_EQUAL(fixture.completions, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(broadcast__fee_rate__below_all_filters__completes)
+{
+    broadcast_fixture fixture;
+    fixture.store(1, 1000);
+    fixture.store(2, 5000);
+    fixture.broadcast(999);
+
+    BOOST_REQUIRE(fixture.sent.empty());
+    BOOST_REQUIRE_EQUAL(fixture.completions, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(broadcast__no_fee_rate__all_channels)
+{
+    broadcast_fixture fixture;
+    fixture.store(1, 0);
+    fixture.store(2, 1000);
+    fixture.store(3, max_uint64);
+    fixture.network.broadcast(message::transaction{},
+        [&](const code&, channel::ptr channel)
+        {
+            fixture.sent.insert(channel);
+        },
+        [&](const code&)
+        {
+            ++fixture.completions;
+        });
+
+    BOOST_REQUIRE_EQUAL(fixture.sent.size(), 3u);
+    BOOST_REQUIRE_EQUAL(fixture.completions, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(broadcast__fee_rate__filter_raised__skipped)
+{
+    broadcast_fixture fixture;
+    const auto channel = fixture.store(1, 0);
+    fixture.broadcast(1000);
+    BOOST_REQUIRE_EQUAL(fixture.sent.count(channel), 1u);
+
+    // A later fee filter message from the peer applies to later broadcasts.
+    fixture.sent.clear();
+    channel->set_fee_filter(2000);
+    fixture.broadcast(1000);
+    BOOST_REQUIRE(fixture.sent.empty());
+    BOOST_REQUIRE_EQUAL(fixture.completions, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
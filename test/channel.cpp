@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(channel_tests)
+
+struct channel_fixture
+{
+    channel_fixture()
+      : pool(1),
+        configuration(config::settings::mainnet),
+        ends(loopback_transport::connect({ "127.0.0.1", 1 },
+            { "127.0.0.2", 2 })),
+        channel(std::make_shared<network::channel>(pool, ends.second,
+            configuration))
+    {
+    }
+
+    ~channel_fixture()
+    {
+        channel->stop(error::channel_stopped);
+        pool.shutdown();
+        pool.join();
+    }
+
+    threadpool pool;
+    network::settings configuration;
+    loopback_transport::pair ends;
+    channel::ptr channel;
+};
+
+BOOST_AUTO_TEST_CASE(channel__round_trip__no_samples__zero)
+{
+    channel_fixture fixture;
+    const auto latency = fixture.channel->round_trip();
+    BOOST_REQUIRE(latency.last == asio::duration::zero());
+    BOOST_REQUIRE(latency.minimum == asio::duration::zero());
+    BOOST_REQUIRE(latency.average == asio::duration::zero());
+    BOOST_REQUIRE_EQUAL(latency.samples, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(channel__record_round_trip__first__all_equal)
+{
+    channel_fixture fixture;
+    fixture.channel->record_round_trip(asio::milliseconds(80));
+    const auto latency = fixture.channel->round_trip();
+    BOOST_REQUIRE(latency.last == asio::milliseconds(80));
+    BOOST_REQUIRE(latency.minimum == asio::milliseconds(80));
+    BOOST_REQUIRE(latency.average == asio::milliseconds(80));
+    BOOST_REQUIRE_EQUAL(latency.samples, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(channel__record_round_trip__samples__last_minimum_average)
+{
+    channel_fixture fixture;
+    fixture.channel->record_round_trip(asio::milliseconds(80));
+    fixture.channel->record_round_trip(asio::milliseconds(160));
+    fixture.channel->record_round_trip(asio::milliseconds(40));
+    const auto latency = fixture.channel->round_trip();
+
+    // The average moves by an eighth of each difference: 80, 90, 83.75.
+    BOOST_REQUIRE(latency.last == asio::milliseconds(40));
+    BOOST_REQUIRE(latency.minimum == asio::milliseconds(40));
+    BOOST_REQUIRE(latency.average == std::chrono::microseconds(83750));
+    BOOST_REQUIRE_EQUAL(latency.samples, 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(connections_tests)
+
+static const config::authority server{ "127.0.0.2", 2 };
+static const config::authority first{ "127.0.0.1", 1 };
+static const config::authority second{ "127.0.0.3", 3 };
+
+struct connections_fixture
+{
+    connections_fixture()
+      : pool(1),
+        configuration(config::settings::mainnet),
+        registry(8)
+    {
+    }
+
+    ~connections_fixture()
+    {
+        for (const auto channel: channels)
+            channel->stop(error::channel_stopped);
+
+        pool.shutdown();
+        pool.join();
+    }
+
+    // The server end of a loopback pair has the authority of the client.
+    channel::ptr make(const config::authority& authority, uint64_t nonce)
+    {
+        const auto ends = loopback_transport::connect(authority, server);
+        const auto channel = std::make_shared<network::channel>(pool,
+            ends.second, configuration);
+        channel->set_nonce(nonce);
+        transports.push_back(ends.first);
+        channels.push_back(channel);
+        return channel;
+    }
+
+    threadpool pool;
+    network::settings configuration;
+    connections registry;
+    std::vector<transport::ptr> transports;
+    std::vector<channel::ptr> channels;
+};
+
+BOOST_AUTO_TEST_CASE(connections__exists__empty__false)
+{
+    connections_fixture fixture;
+    BOOST_REQUIRE_EQUAL(fixture.registry.size(), 0u);
+    BOOST_REQUIRE(!fixture.registry.exists(first));
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(42)));
+    BOOST_REQUIRE(fixture.registry.snapshot()->empty());
+}
+
+BOOST_AUTO_TEST_CASE(connections__store__channel__indexed)
+{
+    connections_fixture fixture;
+    const auto channel = fixture.make(first, 42);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel, true),
+        error::success);
+    BOOST_REQUIRE_EQUAL(fixture.registry.size(), 1u);
+    BOOST_REQUIRE(fixture.registry.exists(first));
+    BOOST_REQUIRE(fixture.registry.exists(uint64_t(42)));
+    BOOST_REQUIRE(!fixture.registry.exists(second));
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(43)));
+}
+
+BOOST_AUTO_TEST_CASE(connections__store__unique_same_authority__address_in_use)
+{
+    connections_fixture fixture;
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(fixture.make(first, 1), true),
+        error::success);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(fixture.make(first, 2), true),
+        error::address_in_use);
+    BOOST_REQUIRE_EQUAL(fixture.registry.size(), 1u);
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(2)));
+}
+
+BOOST_AUTO_TEST_CASE(connections__remove__not_unique_same_authority__counted)
+{
+    connections_fixture fixture;
+    const auto channel1 = fixture.make(first, 1);
+    const auto channel2 = fixture.make(first, 2);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel1, false),
+        error::success);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel2, false),
+        error::success);
+    BOOST_REQUIRE_EQUAL(fixture.registry.size(), 2u);
+
+    // The authority remains indexed until its last channel is removed.
+    fixture.registry.remove(channel1);
+    BOOST_REQUIRE(fixture.registry.exists(first));
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(1)));
+    BOOST_REQUIRE(fixture.registry.exists(uint64_t(2)));
+
+    fixture.registry.remove(channel2);
+    BOOST_REQUIRE(!fixture.registry.exists(first));
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(2)));
+    BOOST_REQUIRE_EQUAL(fixture.registry.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(connections__remove__changed_nonce__recorded_removed)
+{
+    connections_fixture fixture;
+    const auto channel = fixture.make(first, 1);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel, true),
+        error::success);
+
+    // Removal uses the nonce recorded at store, not the current one.
+    channel->set_nonce(2);
+    fixture.registry.remove(channel);
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(1)));
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(2)));
+}
+
+BOOST_AUTO_TEST_CASE(connections__store__duplicate_channel__not_counted)
+{
+    connections_fixture fixture;
+    const auto channel = fixture.make(first, 1);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel, false),
+        error::success);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel, false),
+        error::success);
+    BOOST_REQUIRE_EQUAL(fixture.registry.size(), 1u);
+
+    fixture.registry.remove(channel);
+    BOOST_REQUIRE(!fixture.registry.exists(first));
+    BOOST_REQUIRE(!fixture.registry.exists(uint64_t(1)));
+}
+
+BOOST_AUTO_TEST_CASE(connections__snapshot__unchanged__shared)
+{
+    connections_fixture fixture;
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(fixture.make(first, 1), true),
+        error::success);
+    const auto snapshot1 = fixture.registry.snapshot();
+    const auto snapshot2 = fixture.registry.snapshot();
+    BOOST_REQUIRE(snapshot1 == snapshot2);
+    BOOST_REQUIRE_EQUAL(snapshot1->size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(connections__snapshot__changed__rebuilt_prior_intact)
+{
+    connections_fixture fixture;
+    const auto channel = fixture.make(first, 1);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel, true),
+        error::success);
+    const auto before = fixture.registry.snapshot();
+
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(fixture.make(second, 2), true),
+        error::success);
+    const auto stored = fixture.registry.snapshot();
+    BOOST_REQUIRE(stored != before);
+    BOOST_REQUIRE_EQUAL(stored->size(), 2u);
+
+    fixture.registry.remove(channel);
+    const auto removed = fixture.registry.snapshot();
+    BOOST_REQUIRE(removed != stored);
+    BOOST_REQUIRE_EQUAL(removed->size(), 1u);
+
+    // Prior snapshots are immutable and remain valid for their holders.
+    BOOST_REQUIRE_EQUAL(before->size(), 1u);
+    BOOST_REQUIRE(before->front() == channel);
+    BOOST_REQUIRE_EQUAL(stored->size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(connections__store__stopped__service_stopped)
+{
+    connections_fixture fixture;
+    const auto channel = fixture.make(first, 1);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(channel, true),
+        error::success);
+
+    fixture.registry.stop(error::service_stopped);
+    BOOST_REQUIRE_EQUAL(fixture.registry.store(fixture.make(second, 2), true),
+        error::service_stopped);
+    BOOST_REQUIRE(!fixture.registry.exists(second));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <thread>
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(dns_cache_tests)
+
+static const auto long_time = asio::seconds(60);
+static const auto short_time = asio::milliseconds(20);
+static const auto elapse = std::chrono::milliseconds(50);
+
+static dns_cache::endpoints make_targets(uint16_t port)
+{
+    return { asio::endpoint(boost::asio::ip::make_address("1.2.3.4"), port) };
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__find__stored__found)
+{
+    dns_cache cache(10, long_time, long_time);
+    dns_cache::endpoints out;
+    BOOST_REQUIRE(!cache.find("host", 8333, out));
+
+    cache.store("host", 8333, make_targets(8333));
+    BOOST_REQUIRE(cache.find("host", 8333, out));
+    BOOST_REQUIRE(out == make_targets(8333));
+
+    // The port is part of the key.
+    BOOST_REQUIRE(!cache.find("host", 8334, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__find__expired__not_found)
+{
+    dns_cache cache(10, short_time, long_time);
+    dns_cache::endpoints out;
+    cache.store("host", 8333, make_targets(8333));
+    std::this_thread::sleep_for(elapse);
+    BOOST_REQUIRE(!cache.find("host", 8333, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__find__failure__found_empty_until_expired)
+{
+    dns_cache cache(10, long_time, short_time);
+    dns_cache::endpoints out = make_targets(8333);
+    cache.store_failure("host", 8333);
+    BOOST_REQUIRE(cache.find("host", 8333, out));
+    BOOST_REQUIRE(out.empty());
+
+    // The failure lifetime is independent of the success lifetime.
+    std::this_thread::sleep_for(elapse);
+    BOOST_REQUIRE(!cache.find("host", 8333, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__store__zero_expiration__not_stored)
+{
+    dns_cache cache(10, asio::duration::zero(), asio::duration::zero());
+    dns_cache::endpoints out;
+    cache.store("host", 8333, make_targets(8333));
+    cache.store_failure("other", 8333);
+    BOOST_REQUIRE(!cache.find("host", 8333, out));
+    BOOST_REQUIRE(!cache.find("other", 8333, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__store__zero_capacity__not_stored)
+{
+    dns_cache cache(0, long_time, long_time);
+    dns_cache::endpoints out;
+    cache.store("host", 8333, make_targets(8333));
+    BOOST_REQUIRE(!cache.find("host", 8333, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__store__full_with_expired__expired_purged)
+{
+    dns_cache cache(2, long_time, short_time);
+    dns_cache::endpoints out;
+    cache.store("live", 1, make_targets(1));
+    cache.store_failure("dead", 2);
+    std::this_thread::sleep_for(elapse);
+
+    // The expired failure makes room, the live entry is retained.
+    cache.store("new", 3, make_targets(3));
+    BOOST_REQUIRE(cache.find("live", 1, out));
+    BOOST_REQUIRE(cache.find("new", 3, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__store__full_unexpired__started_over)
+{
+    dns_cache cache(2, long_time, long_time);
+    dns_cache::endpoints out;
+    cache.store("first", 1, make_targets(1));
+    cache.store("second", 2, make_targets(2));
+    cache.store("third", 3, make_targets(3));
+    BOOST_REQUIRE(!cache.find("first", 1, out));
+    BOOST_REQUIRE(!cache.find("second", 2, out));
+    BOOST_REQUIRE(cache.find("third", 3, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__store__full_existing_key__replaced)
+{
+    dns_cache cache(2, long_time, long_time);
+    dns_cache::endpoints out;
+    cache.store("first", 1, make_targets(1));
+    cache.store("second", 2, make_targets(2));
+    cache.store_failure("first", 1);
+    BOOST_REQUIRE(cache.find("first", 1, out));
+    BOOST_REQUIRE(out.empty());
+    BOOST_REQUIRE(cache.find("second", 2, out));
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__clear__stored__not_found)
+{
+    dns_cache cache(10, long_time, long_time);
+    dns_cache::endpoints out;
+    cache.store("host", 8333, make_targets(8333));
+    cache.clear();
+    BOOST_REQUIRE(!cache.find("host", 8333, out));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(eviction_tests)
+
+static eviction::candidates ranked(size_t count)
+{
+    eviction::candidates out;
+
+    // Round trip and rate increase, and age decreases, with the index.
+    for (size_t index = 0; index < count; ++index)
+        out.push_back({ index, asio::milliseconds(10 * (index + 1)),
+            static_cast<double>(index), asio::seconds(100 - index) });
+
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(eviction__select__all_protected__false)
+{
+    size_t selected;
+    BOOST_REQUIRE(!eviction::select({}, 4, selected));
+    BOOST_REQUIRE(!eviction::select(ranked(6), 2, selected));
+}
+
+BOOST_AUTO_TEST_CASE(eviction__select__unprotected__lowest_rate)
+{
+    // Protected: 0, 1 (round trip), 9, 8 (rate) and 2, 3 (age).
+    size_t selected = 0;
+    BOOST_REQUIRE(eviction::select(ranked(10), 2, selected));
+    BOOST_REQUIRE_EQUAL(selected, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(eviction__select__unmeasured_round_trip__not_protected)
+{
+    auto candidates = ranked(4);
+    candidates[0].round_trip = asio::duration::zero();
+    candidates[0].useful_rate = 0;
+    candidates[0].age = asio::seconds(1);
+
+    size_t selected = 99;
+    BOOST_REQUIRE(eviction::select(candidates, 1, selected));
+    BOOST_REQUIRE_EQUAL(selected, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(frame_capture_tests)
+
+static const auto capture_file = "frame_capture.capture";
+
+BOOST_AUTO_TEST_CASE(frame_capture__load__missing__false)
+{
+    boost::filesystem::remove(capture_file);
+    frame_capture::frames frames;
+    BOOST_REQUIRE(!frame_capture::load(capture_file, frames));
+}
+
+BOOST_AUTO_TEST_CASE(frame_capture__load__recorded__round_trip)
+{
+    const data_chunk first{ 1, 2, 3 };
+    const data_chunk second{ 4, 5 };
+
+    {
+        frame_capture capture(capture_file);
+        BOOST_REQUIRE(capture.opened());
+
+        const auto one = capture.next_channel();
+        const auto two = capture.next_channel();
+        BOOST_REQUIRE(one != two);
+
+        data_chunk one_buffer;
+        data_chunk two_buffer;
+        capture.record(one_buffer, one, first.data(), first.size());
+        capture.record(two_buffer, two, second.data(), second.size());
+
+        // Submitted out of time order, loaded in time order.
+        capture.submit(two_buffer);
+        capture.submit(one_buffer);
+        BOOST_REQUIRE(one_buffer.empty());
+        BOOST_REQUIRE(two_buffer.empty());
+    }
+
+    frame_capture::frames frames;
+    BOOST_REQUIRE(frame_capture::load(capture_file, frames));
+    BOOST_REQUIRE_EQUAL(frames.size(), 2u);
+    BOOST_REQUIRE(frames[0].data == first);
+    BOOST_REQUIRE(frames[1].data == second);
+    BOOST_REQUIRE(frames[0].channel != frames[1].channel);
+    BOOST_REQUIRE(frames[0].microseconds <= frames[1].microseconds);
+    boost::filesystem::remove(capture_file);
+}
+
+BOOST_AUTO_TEST_CASE(frame_capture__flush__submitted__written)
+{
+    const data_chunk frame{ 1, 2, 3 };
+    frame_capture capture(capture_file);
+    const auto channel = capture.next_channel();
+
+    data_chunk submitted;
+    data_chunk retained;
+    capture.record(submitted, channel, frame.data(), frame.size());
+    capture.record(retained, channel, frame.data(), frame.size());
+    capture.submit(submitted);
+    capture.flush();
+
+    frame_capture::frames frames;
+    BOOST_REQUIRE(frame_capture::load(capture_file, frames));
+    BOOST_REQUIRE_EQUAL(frames.size(), 1u);
+    BOOST_REQUIRE(frames[0].data == frame);
+    BOOST_REQUIRE(!retained.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
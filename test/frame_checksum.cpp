@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(frame_checksum_tests)
+
+// Sizes about the sha256 padding boundaries and spanning many blocks.
+static const size_t sizes[] = { 0, 1, 55, 56, 63, 64, 65, 119, 120, 1000 };
+
+BOOST_AUTO_TEST_CASE(frame_checksum__compute__sizes__bitcoin_checksum)
+{
+    for (const auto size: sizes)
+    {
+        data_chunk payload(size);
+
+        for (size_t index = 0; index < size; ++index)
+            payload[index] = static_cast<uint8_t>(index * 131 + size);
+
+        BOOST_REQUIRE_EQUAL(frame_checksum::compute(payload),
+            bitcoin_checksum(payload));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(handler_memory_tests)
+
+BOOST_AUTO_TEST_CASE(handler_memory__allocate__released__reused)
+{
+    handler_memory memory;
+    const auto first = memory.allocate(handler_memory::capacity);
+    memory.deallocate(first);
+    const auto second = memory.allocate(1);
+    BOOST_REQUIRE(first == second);
+    memory.deallocate(second);
+}
+
+BOOST_AUTO_TEST_CASE(handler_memory__allocate__in_use_or_oversized__heap)
+{
+    handler_memory memory;
+    const auto held = memory.allocate(1);
+    const auto overlapping = memory.allocate(1);
+    BOOST_REQUIRE(held != overlapping);
+    memory.deallocate(overlapping);
+    memory.deallocate(held);
+
+    const auto oversized = memory.allocate(handler_memory::capacity + 1);
+    const auto stored = memory.allocate(1);
+    BOOST_REQUIRE(oversized != stored);
+    memory.deallocate(stored);
+    memory.deallocate(oversized);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
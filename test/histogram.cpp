@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+using namespace std::chrono;
+
+BOOST_AUTO_TEST_SUITE(histogram_tests)
+
+BOOST_AUTO_TEST_CASE(histogram__to_bucket__powers_of_two__expected)
+{
+    BOOST_REQUIRE_EQUAL(histogram::to_bucket(0), 0u);
+    BOOST_REQUIRE_EQUAL(histogram::to_bucket(1), 1u);
+    BOOST_REQUIRE_EQUAL(histogram::to_bucket(2), 2u);
+    BOOST_REQUIRE_EQUAL(histogram::to_bucket(3), 2u);
+    BOOST_REQUIRE_EQUAL(histogram::to_bucket(1024), 11u);
+    BOOST_REQUIRE_EQUAL(histogram::to_bucket(max_uint64),
+        histogram::bucket_count - 1);
+}
+
+BOOST_AUTO_TEST_CASE(histogram__percentile__empty__zero)
+{
+    const histogram instance;
+    BOOST_REQUIRE_EQUAL(histogram::percentile(instance.collect(), 50), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(histogram__percentile__recorded__bucket_upper_bound)
+{
+    histogram instance;
+
+    for (auto sample = 0; sample < 99; ++sample)
+        instance.record(microseconds(100));
+
+    instance.record(seconds(1));
+
+    const auto values = instance.collect();
+    BOOST_REQUIRE_EQUAL(values.count, 100u);
+    BOOST_REQUIRE_EQUAL(values.microseconds, 99u * 100u + 1000000u);
+    BOOST_REQUIRE_EQUAL(histogram::percentile(values, 50), 128u);
+    BOOST_REQUIRE_EQUAL(histogram::percentile(values, 99), 128u);
+    BOOST_REQUIRE_EQUAL(histogram::percentile(values, 100), 1048576u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+#define TEST_NAME \
+    boost::unit_test::framework::current_test_case().p_name
+
+#define SETTINGS_TESTNET_HOSTS(name, capacity) \
+    auto name = network::settings(bc::config::settings::testnet); \
+    name.host_pool_capacity = capacity; \
+    name.hosts_file = get_hosts_path(TEST_NAME)
+
+static std::string get_hosts_path(const std::string& test)
+{
+    const auto path = test + ".hosts.log";
+    boost::filesystem::remove_all(path);
+    return path;
+}
+
+static hosts::address make_address(size_t index)
+{
+    const auto host = "10.0." + std::to_string(index / 256) + "." +
+        std::to_string(index % 256);
+    return config::authority(host, 8333).to_network_address();
+}
+
+BOOST_AUTO_TEST_SUITE(hosts_tests)
+
+BOOST_AUTO_TEST_CASE(hosts__fetch__empty__not_found)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    hosts::address out;
+    BOOST_REQUIRE_EQUAL(instance.fetch(out).value(), error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store__duplicate__stored_once)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1)).value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1)).value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+
+    hosts::address out;
+    BOOST_REQUIRE_EQUAL(instance.fetch(out).value(), error::success);
+    BOOST_REQUIRE(out.ip() == make_address(1).ip());
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store__beyond_capacity__capacity_not_exceeded)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    for (size_t index = 0; index < 100; ++index)
+        BOOST_REQUIRE_EQUAL(instance.store(make_address(index)).value(),
+            error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 10u);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__remove__stored__removed)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    for (size_t index = 0; index < 3; ++index)
+        BOOST_REQUIRE_EQUAL(instance.store(make_address(index)).value(),
+            error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(0)).value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(0)).value(), error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(2)).value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(1)).value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__stop__stored__reloaded_by_start)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    for (size_t index = 0; index < 5; ++index)
+        BOOST_REQUIRE_EQUAL(instance.store(make_address(index)).value(),
+            error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 5u);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__start__text_file__loaded)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+
+    {
+        bc::ofstream file(configuration.hosts_file.string());
+        file << "10.0.0.1:8333" << std::endl;
+        file << "10.0.0.2:8333" << std::endl;
+        file << "10.0.0.2:8333" << std::endl;
+    }
+
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__save__stored__retained_and_reloaded)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    for (size_t index = 0; index < 5; ++index)
+        BOOST_REQUIRE_EQUAL(instance.store(make_address(index)).value(),
+            error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.save().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 5u);
+
+    hosts reloaded(configuration);
+    BOOST_REQUIRE_EQUAL(reloaded.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(reloaded.count(), 5u);
+    BOOST_REQUIRE_EQUAL(reloaded.stop().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__succeeded__unknown__not_found)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.succeeded(make_address(1)).value(),
+        error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__fetch__recently_attempted__deferred)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1)).value(),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(2)).value(),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.attempted(make_address(1)).value(),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.succeeded(make_address(1)).value(),
+        error::success);
+
+    // The recently-attempted address is deferred in favor of the other.
+    const auto deferred = make_address(1);
+    size_t selected = 0;
+
+    for (size_t trial = 0; trial < 100; ++trial)
+    {
+        hosts::address out;
+        BOOST_REQUIRE_EQUAL(instance.fetch(out).value(), error::success);
+
+        if (out.ip() == deferred.ip() && out.port() == deferred.port())
+            ++selected;
+    }
+
+    BOOST_REQUIRE_LT(selected, 50u);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__stop__history__reloaded_by_start)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 42);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1)).value(),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.succeeded(make_address(1)).value(),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1)).value(),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__fetch_list__stale_and_fresh__fresh_only)
+{
+    SETTINGS_TESTNET_HOSTS(configuration, 1000);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start().value(), error::success);
+
+    const auto now = static_cast<uint32_t>(std::time(nullptr));
+    const uint32_t stale = now - 60 * 24 * 60 * 60;
+
+    for (size_t index = 0; index < 40; ++index)
+    {
+        auto host = make_address(index);
+        host.set_timestamp(index % 2 == 0 ? now : stale);
+        BOOST_REQUIRE_EQUAL(instance.store(host).value(), error::success);
+    }
+
+    hosts::address::list out;
+    BOOST_REQUIRE_EQUAL(instance.fetch(out).value(), error::success);
+    BOOST_REQUIRE(!out.empty());
+
+    for (const auto& host: out)
+        BOOST_REQUIRE_EQUAL(host.timestamp(), now);
+
+    BOOST_REQUIRE_EQUAL(instance.stop().value(), error::success);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
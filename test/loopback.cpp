@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(loopback_tests)
+
+BOOST_AUTO_TEST_CASE(loopback_hub__connect__not_listening__null)
+{
+    loopback_hub hub;
+    BOOST_REQUIRE(!hub.connect(42));
+}
+
+BOOST_AUTO_TEST_CASE(loopback_hub__listen__twice__address_in_use)
+{
+    loopback_hub hub;
+    const auto ignore = [](transport::ptr) {};
+    BOOST_REQUIRE_EQUAL(hub.listen(42, ignore).value(), error::success);
+    BOOST_REQUIRE_EQUAL(hub.listen(42, ignore).value(), error::address_in_use);
+}
+
+BOOST_AUTO_TEST_CASE(loopback_hub__unlisten__listening__not_connected)
+{
+    loopback_hub hub;
+    BOOST_REQUIRE_EQUAL(hub.listen(42, [](transport::ptr) {}).value(),
+        error::success);
+    hub.unlisten(42);
+    BOOST_REQUIRE(!hub.connect(42));
+}
+
+BOOST_AUTO_TEST_CASE(loopback_hub__connect__listening__distinct_clients)
+{
+    loopback_hub hub;
+    std::vector<transport::ptr> accepted;
+    const auto listener = [&](transport::ptr server_end)
+    {
+        accepted.push_back(server_end);
+    };
+
+    BOOST_REQUIRE_EQUAL(hub.listen(42, listener).value(), error::success);
+
+    const auto first = hub.connect(42);
+    const auto second = hub.connect(42);
+    BOOST_REQUIRE(first);
+    BOOST_REQUIRE(second);
+    BOOST_REQUIRE_EQUAL(accepted.size(), 2u);
+    BOOST_REQUIRE_EQUAL(first->authority().port(), 42u);
+    BOOST_REQUIRE(accepted[0]->authority() != accepted[1]->authority());
+}
+
+BOOST_AUTO_TEST_CASE(loopback_transport__read__partial_frames__in_order)
+{
+    boost::asio::io_context service;
+    transport::strand strand(service);
+    const auto ends = loopback_transport::connect({ "127.0.0.1", 1 },
+        { "127.0.0.2", 2 });
+
+    const auto write = [&](const data_chunk& data)
+    {
+        ends.first->write({ boost::asio::buffer(data) }, strand,
+            [](const boost_code& ec, size_t)
+            {
+                BOOST_REQUIRE(!ec);
+            });
+        service.run();
+        service.restart();
+    };
+
+    const auto read = [&](size_t size)
+    {
+        size_t received = 0;
+        data_chunk out(size);
+        ends.second->read(boost::asio::buffer(out), size, strand,
+            [&](const boost_code& ec, size_t bytes)
+            {
+                BOOST_REQUIRE(!ec);
+                received = bytes;
+            });
+        service.run();
+        service.restart();
+        BOOST_REQUIRE_EQUAL(received, size);
+        return out;
+    };
+
+    // Each read leaves a partial frame, which later writes must follow.
+    write({ 1, 2, 3, 4, 5, 6 });
+    BOOST_REQUIRE(read(4) == data_chunk({ 1, 2, 3, 4 }));
+    write({ 7, 8, 9 });
+    BOOST_REQUIRE(read(4) == data_chunk({ 5, 6, 7, 8 }));
+    write({ 10 });
+    BOOST_REQUIRE(read(2) == data_chunk({ 9, 10 }));
+    ends.first->stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
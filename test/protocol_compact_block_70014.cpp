@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(protocol_compact_block_70014_tests)
+
+typedef protocol_compact_block_70014 compact;
+
+// Transactions are distinguished by lock time.
+static chain::transaction make_transaction(uint32_t locktime)
+{
+    return { 1, locktime, {}, {} };
+}
+
+static message::block make_block()
+{
+    return
+    {
+        chain::header{},
+        chain::transaction::list
+        {
+            make_transaction(0),
+            make_transaction(1),
+            make_transaction(2)
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(protocol_compact_block_70014__to_differential__round_trip__expected)
+{
+    const std::vector<uint64_t> indexes{ 0, 1, 5, 9 };
+    const auto differential = compact::to_differential(indexes);
+    BOOST_REQUIRE(differential == (std::vector<uint64_t>{ 0, 0, 3, 3 }));
+
+    std::vector<uint64_t> absolute;
+    BOOST_REQUIRE(compact::to_absolute(absolute, differential, 10));
+    BOOST_REQUIRE(absolute == indexes);
+}
+
+BOOST_AUTO_TEST_CASE(protocol_compact_block_70014__to_absolute__overflow__false)
+{
+    std::vector<uint64_t> absolute;
+    BOOST_REQUIRE(!compact::to_absolute(absolute, { max_uint64 }, 10));
+    BOOST_REQUIRE(!compact::to_absolute(absolute, { 5, max_uint64 - 5 }, 10));
+    BOOST_REQUIRE(!compact::to_absolute(absolute, { 0, 9 }, 10));
+    BOOST_REQUIRE(!compact::to_absolute(absolute, { 10 }, 10));
+    BOOST_REQUIRE(compact::to_absolute(absolute, { 0, 8 }, 10));
+    BOOST_REQUIRE(absolute == (std::vector<uint64_t>{ 0, 9 }));
+}
+
+BOOST_AUTO_TEST_CASE(protocol_compact_block_70014__populate__missing__requested)
+{
+    const auto block = make_block();
+    const auto& transactions = block.transactions();
+    const auto compact_block = compact::to_compact_block(block, 42, false);
+    const compact::source pooled = [&](const compact::visitor& visit)
+    {
+        visit(make_transaction(3));
+        visit(transactions[2]);
+    };
+
+    chain::transaction::list out;
+    std::vector<uint64_t> missing;
+    BOOST_REQUIRE(compact::populate(out, missing, compact_block, false,
+        pooled));
+    BOOST_REQUIRE_EQUAL(out.size(), 3u);
+    BOOST_REQUIRE(missing == std::vector<uint64_t>{ 1 });
+    BOOST_REQUIRE(out[0] == transactions[0]);
+    BOOST_REQUIRE(out[2] == transactions[2]);
+}
+
+BOOST_AUTO_TEST_CASE(protocol_compact_block_70014__populate__pooled__complete)
+{
+    const auto block = make_block();
+    const auto& transactions = block.transactions();
+    const auto compact_block = compact::to_compact_block(block, 42, false);
+    const compact::source pooled = [&](const compact::visitor& visit)
+    {
+        for (const auto& tx: transactions)
+            visit(tx);
+    };
+
+    chain::transaction::list out;
+    std::vector<uint64_t> missing;
+    BOOST_REQUIRE(compact::populate(out, missing, compact_block, false,
+        pooled));
+    BOOST_REQUIRE(missing.empty());
+    BOOST_REQUIRE(out == transactions);
+}
+
+BOOST_AUTO_TEST_CASE(protocol_compact_block_70014__populate__empty__false)
+{
+    const message::compact_block empty{};
+    const compact::source pooled = [](const compact::visitor&) {};
+
+    chain::transaction::list out;
+    std::vector<uint64_t> missing;
+    BOOST_REQUIRE(!compact::populate(out, missing, empty, false, pooled));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <cstdint>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(protocol_ping_60001_tests)
+
+typedef protocol_ping_60001 ping;
+
+// Pings of nonces 1, 2 and 3, sent a second apart.
+static ping::sent_pings make_pings(const ping::clock::time_point& start)
+{
+    return
+    {
+        { 1, start },
+        { 2, start + std::chrono::seconds(1) },
+        { 3, start + std::chrono::seconds(2) }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(protocol_ping_60001__match__last__drops_all_earlier)
+{
+    const auto start = ping::clock::now();
+    auto outstanding = make_pings(start);
+    ping::clock::time_point sent;
+    BOOST_REQUIRE(ping::match(outstanding, 3, sent));
+    BOOST_REQUIRE(sent == start + std::chrono::seconds(2));
+    BOOST_REQUIRE(outstanding.empty());
+}
+
+BOOST_AUTO_TEST_CASE(protocol_ping_60001__match__middle__keeps_later)
+{
+    const auto start = ping::clock::now();
+    auto outstanding = make_pings(start);
+    ping::clock::time_point sent;
+    BOOST_REQUIRE(ping::match(outstanding, 2, sent));
+    BOOST_REQUIRE(sent == start + std::chrono::seconds(1));
+    BOOST_REQUIRE_EQUAL(outstanding.size(), 1u);
+    BOOST_REQUIRE_EQUAL(outstanding.front().first, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(protocol_ping_60001__match__dropped_nonce__false)
+{
+    const auto start = ping::clock::now();
+    auto outstanding = make_pings(start);
+    ping::clock::time_point sent;
+    BOOST_REQUIRE(ping::match(outstanding, 2, sent));
+
+    // The late pong of an earlier ping is no longer matched.
+    BOOST_REQUIRE(!ping::match(outstanding, 1, sent));
+    BOOST_REQUIRE_EQUAL(outstanding.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(protocol_ping_60001__match__unknown_nonce__unchanged)
+{
+    const auto start = ping::clock::now();
+    auto outstanding = make_pings(start);
+    ping::clock::time_point sent;
+    BOOST_REQUIRE(!ping::match(outstanding, 42, sent));
+    BOOST_REQUIRE_EQUAL(outstanding.size(), 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(proxy_tests)
+
+typedef proxy::priority priority;
+
+static const auto level = version::level::maximum;
+static const auto timeout = std::chrono::seconds(10);
+
+// A block of segregated transactions, each of about 32KiB, over 256KiB.
+static block make_block(uint32_t locktime)
+{
+    chain::transaction::list transactions;
+
+    for (uint32_t index = 0; index < 10; ++index)
+    {
+        const chain::witness witness(data_stack{ data_chunk(72, 0x42) });
+        const chain::input input({ null_hash, index }, {}, witness,
+            max_input_sequence);
+        const chain::output output(index, { data_chunk(32 * 1024, 0x6a),
+            false });
+        transactions.push_back({ 1, locktime, { input }, { output } });
+    }
+
+    return { chain::header{}, std::move(transactions) };
+}
+
+template <class Message>
+static data_chunk to_frame(const Message& message, uint32_t magic)
+{
+    data_chunk frame(heading::satoshi_fixed_size() +
+        message.serialized_size(level));
+    proxy::serialize(frame, message, level, magic);
+    return frame;
+}
+
+// Write the frame in parts, each copied to the peer upon the write.
+static void write(transport::ptr end, transport::strand& strand,
+    const data_chunk& frame, size_t begin, size_t end_offset, size_t step)
+{
+    const auto ignore = [](const boost_code&, size_t) {};
+
+    for (auto offset = begin; offset < end_offset; offset += step)
+    {
+        const auto size = std::min(step, end_offset - offset);
+        end->write({ boost::asio::buffer(&frame[offset], size) }, strand,
+            ignore);
+    }
+}
+
+static bool same_block(const block& left, const block& right)
+{
+    if (left.transactions().size() != right.transactions().size())
+        return false;
+
+    for (size_t index = 0; index < left.transactions().size(); ++index)
+        if (left.transactions()[index].hash(true) !=
+            right.transactions()[index].hash(true))
+            return false;
+
+    return true;
+}
+
+struct loopback_fixture
+{
+    typedef std::function<void(network::settings&)> configure;
+
+    loopback_fixture(const configure& changes = nullptr)
+      : pool(3),
+        configuration(config::settings::mainnet),
+        ends(loopback_transport::connect({ "127.0.0.1", 1 },
+            { "127.0.0.2", 2 })),
+        strand(pool.service())
+    {
+        configuration.progressive_decoding = true;
+
+        if (changes)
+            changes(configuration);
+
+        channel = std::make_shared<network::channel>(pool, ends.second,
+            configuration);
+    }
+
+    ~loopback_fixture()
+    {
+        channel->stop(error::channel_stopped);
+        pool.shutdown();
+        pool.join();
+    }
+
+    code start()
+    {
+        std::promise<code> started;
+        channel->start([&](const code& ec) { started.set_value(ec); });
+        return started.get_future().get();
+    }
+
+    threadpool pool;
+    network::settings configuration;
+    loopback_transport::pair ends;
+    transport::strand strand;
+    channel::ptr channel;
+};
+
+BOOST_AUTO_TEST_CASE(proxy__to_priority__ping_pong__control)
+{
+    BOOST_REQUIRE(proxy::to_priority(message_type::ping) ==
+        priority::control);
+    BOOST_REQUIRE(proxy::to_priority(message_type::pong) ==
+        priority::control);
+}
+
+BOOST_AUTO_TEST_CASE(proxy__to_priority__headers_inventory__announce)
+{
+    BOOST_REQUIRE(proxy::to_priority(message_type::headers) ==
+        priority::announce);
+    BOOST_REQUIRE(proxy::to_priority(message_type::inventory) ==
+        priority::announce);
+}
+
+BOOST_AUTO_TEST_CASE(proxy__to_priority__block_transaction__bulk)
+{
+    BOOST_REQUIRE(proxy::to_priority(message_type::block) == priority::bulk);
+    BOOST_REQUIRE(proxy::to_priority(message_type::transaction) ==
+        priority::bulk);
+}
+
+BOOST_AUTO_TEST_CASE(proxy__to_priority__unknown__announce)
+{
+    BOOST_REQUIRE(proxy::to_priority(message_type::unknown) ==
+        priority::announce);
+}
+
+BOOST_AUTO_TEST_CASE(proxy__read__progressive_block__delivered)
+{
+    // The fixture stops the channel first, while its handlers are valid.
+    std::promise<block_const_ptr> received;
+    loopback_fixture fixture;
+
+    fixture.channel->subscribe<block>(
+        [&](const code& ec, block_const_ptr message)
+        {
+            if (!ec)
+                received.set_value(message);
+
+            return false;
+        });
+
+    BOOST_REQUIRE_EQUAL(fixture.start(), error::success);
+
+    const auto expected = make_block(0);
+    const auto frame = to_frame(expected, fixture.configuration.identifier);
+    BOOST_REQUIRE_GT(frame.size(), 256u * 1024u);
+    write(fixture.ends.first, fixture.strand, frame, 0, frame.size(),
+        10 * 1024);
+
+    auto future = received.get_future();
+    BOOST_REQUIRE(future.wait_for(timeout) == std::future_status::ready);
+    BOOST_REQUIRE(same_block(*future.get(), expected));
+}
+
+// The second block is read progressively while the only block subscriber
+// unsubscribes, and so is dropped without stopping the channel.
+BOOST_AUTO_TEST_CASE(proxy__read__unsubscribed_mid_block__dropped)
+{
+    std::atomic<size_t> blocks(0);
+    std::promise<void> first;
+    std::promise<void> pinged;
+    std::atomic<bool> stopped(false);
+    loopback_fixture fixture;
+
+    fixture.channel->subscribe<block>(
+        [&](const code& ec, block_const_ptr)
+        {
+            if (!ec && ++blocks == 1)
+                first.set_value();
+
+            return false;
+        });
+
+    fixture.channel->subscribe<ping>(
+        [&](const code& ec, ping_const_ptr)
+        {
+            if (!ec)
+                pinged.set_value();
+
+            return false;
+        });
+
+    fixture.channel->subscribe_stop([&](const code&) { stopped = true; });
+    BOOST_REQUIRE_EQUAL(fixture.start(), error::success);
+
+    const auto magic = fixture.configuration.identifier;
+    const auto one = to_frame(make_block(1), magic);
+    const auto two = to_frame(make_block(2), magic);
+    const auto pulse = to_frame(ping{ 42 }, magic);
+    const auto half = two.size() / 2;
+
+    write(fixture.ends.first, fixture.strand, one, 0, one.size(), one.size());
+    write(fixture.ends.first, fixture.strand, two, 0, half, 10 * 1024);
+    BOOST_REQUIRE(first.get_future().wait_for(timeout) ==
+        std::future_status::ready);
+
+    write(fixture.ends.first, fixture.strand, two, half, two.size(),
+        10 * 1024);
+    write(fixture.ends.first, fixture.strand, pulse, 0, pulse.size(),
+        pulse.size());
+    BOOST_REQUIRE(pinged.get_future().wait_for(timeout) ==
+        std::future_status::ready);
+
+    BOOST_REQUIRE_EQUAL(blocks.load(), 1u);
+    BOOST_REQUIRE(!stopped);
+}
+
+// Relayed pings are held by their handler, so that they remain pending and
+// the read cycle pauses at the limit, withholding the pong that follows.
+static void require_paused(const loopback_fixture::configure& changes,
+    size_t pings)
+{
+    std::promise<void> unblock;
+    const auto unblocked = unblock.get_future().share();
+    std::promise<void> pinged;
+    std::promise<void> ponged;
+    std::atomic<size_t> received(0);
+    loopback_fixture fixture(changes);
+
+    fixture.channel->subscribe<ping>(
+        [&, unblocked](const code& ec, ping_const_ptr)
+        {
+            if (ec)
+                return false;
+
+            if (++received == 1)
+                pinged.set_value();
+
+            unblocked.wait_for(timeout);
+            return true;
+        });
+
+    fixture.channel->subscribe<pong>(
+        [&](const code& ec, pong_const_ptr)
+        {
+            if (!ec)
+                ponged.set_value();
+
+            return false;
+        });
+
+    BOOST_REQUIRE_EQUAL(fixture.start(), error::success);
+
+    const auto magic = fixture.configuration.identifier;
+    const auto pulse = to_frame(ping{ 42 }, magic);
+    const auto reply = to_frame(pong{ 42 }, magic);
+
+    for (size_t count = 0; count < pings; ++count)
+        write(fixture.ends.first, fixture.strand, pulse, 0, pulse.size(),
+            pulse.size());
+
+    write(fixture.ends.first, fixture.strand, reply, 0, reply.size(),
+        reply.size());
+
+    auto pong_future = ponged.get_future();
+    BOOST_REQUIRE(pinged.get_future().wait_for(timeout) ==
+        std::future_status::ready);
+    BOOST_REQUIRE(pong_future.wait_for(std::chrono::milliseconds(200)) ==
+        std::future_status::timeout);
+
+    // Relays are ordered, so only the first ping has reached its handler.
+    BOOST_REQUIRE_EQUAL(received.load(), 1u);
+
+    // The release of the held pings resumes the read cycle.
+    unblock.set_value();
+    BOOST_REQUIRE(pong_future.wait_for(timeout) ==
+        std::future_status::ready);
+}
+
+BOOST_AUTO_TEST_CASE(proxy__read__pending_messages_limit__paused_and_resumed)
+{
+    require_paused([](network::settings& configuration)
+    {
+        configuration.channel_pending_messages = 2;
+        configuration.channel_pending_bytes = 0;
+        configuration.message_dispatch.set(message_type::ping,
+            dispatch_policy::delivery::relay);
+    }, 2);
+}
+
+BOOST_AUTO_TEST_CASE(proxy__read__pending_bytes_limit__paused_and_resumed)
+{
+    // A ping payload is its eight byte nonce.
+    require_paused([](network::settings& configuration)
+    {
+        configuration.channel_pending_messages = 0;
+        configuration.channel_pending_bytes = 8;
+        configuration.message_dispatch.set(message_type::ping,
+            dispatch_policy::delivery::relay);
+    }, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
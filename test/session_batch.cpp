@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(session_batch_tests)
+
+// A batch is sized for a 95% likelihood of at least one connection.
+
+BOOST_AUTO_TEST_CASE(session_batch__adapted_size__all_succeed__minimum)
+{
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(1.0, 1, 10), 1u);
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(1.0, 3, 10), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(session_batch__adapted_size__high_rate__two)
+{
+    // 1 - 0.1^2 = 0.99 >= 0.95, 1 - 0.1 = 0.9 < 0.95.
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(0.9, 1, 10), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(session_batch__adapted_size__even_rate__five)
+{
+    // 1 - 0.5^5 = 0.969 >= 0.95, 1 - 0.5^4 = 0.9375 < 0.95.
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(0.5, 1, 10), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(session_batch__adapted_size__low_rate__maximum)
+{
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(0.1, 1, 10), 10u);
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(0.0, 1, 10), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(session_batch__adapted_size__below_minimum__minimum)
+{
+    BOOST_REQUIRE_EQUAL(session_batch::adapted_size(0.9, 4, 10), 4u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(short_id_tests)
+
+// The SipHashUint256 vector of the reference implementation.
+BOOST_AUTO_TEST_CASE(short_id__siphash__reference_vector__expected)
+{
+    hash_digest hash;
+
+    for (size_t byte = 0; byte < hash.size(); ++byte)
+        hash[byte] = static_cast<uint8_t>(byte);
+
+    const short_id::key key{ 0x0706050403020100, 0x0f0e0d0c0b0a0908 };
+    BOOST_REQUIRE_EQUAL(short_id::siphash(key, hash), 0x7127512f72f27cceu);
+    BOOST_REQUIRE_EQUAL(short_id::compute(key, hash), 0x512f72f27cceu);
+}
+
+BOOST_AUTO_TEST_CASE(short_id__to_mini_hash__round_trip__little_endian)
+{
+    const uint64_t value = 0x060504030201;
+    const auto wire = short_id::to_mini_hash(value);
+    BOOST_REQUIRE_EQUAL(wire[0], 0x01u);
+    BOOST_REQUIRE_EQUAL(wire[5], 0x06u);
+    BOOST_REQUIRE_EQUAL(short_id::to_number(wire), value);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
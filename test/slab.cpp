@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(slab_tests)
+
+BOOST_AUTO_TEST_CASE(slab__allocate__released__reused_within_class)
+{
+    slab instance;
+    const auto first = instance.allocate(slab::granularity);
+    instance.deallocate(first, slab::granularity);
+    const auto second = instance.allocate(1);
+    BOOST_REQUIRE(first == second);
+    instance.deallocate(second, 1);
+}
+
+BOOST_AUTO_TEST_CASE(slab__allocate__held__distinct)
+{
+    slab instance;
+    const auto first = instance.allocate(slab::maximum);
+    const auto second = instance.allocate(slab::maximum);
+    const auto oversized = instance.allocate(slab::maximum + 1);
+    BOOST_REQUIRE(first != second);
+    BOOST_REQUIRE(oversized != first);
+    BOOST_REQUIRE(oversized != second);
+    instance.deallocate(oversized, slab::maximum + 1);
+    instance.deallocate(second, slab::maximum);
+    instance.deallocate(first, slab::maximum);
+}
+
+BOOST_AUTO_TEST_CASE(slab__make_pooled__released__reused)
+{
+    auto first = make_pooled<data_chunk>(size_t(42));
+    BOOST_REQUIRE_EQUAL(first->size(), 42u);
+    const auto address = first.get();
+    first.reset();
+
+    const auto second = make_pooled<data_chunk>(size_t(24));
+    BOOST_REQUIRE(second.get() == address);
+}
+
+BOOST_AUTO_TEST_CASE(slab__make_join__count__invoked_once_at_count)
+{
+    size_t invoked = 0;
+    const auto join = make_join([&](const code& ec)
+    {
+        BOOST_REQUIRE_EQUAL(ec, error::success);
+        ++invoked;
+    }, 2);
+
+    join(error::channel_stopped);
+    BOOST_REQUIRE_EQUAL(invoked, 0u);
+    join(error::success);
+    BOOST_REQUIRE_EQUAL(invoked, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(slab__make_join__zero__invoked_at_once)
+{
+    size_t invoked = 0;
+    make_join([&](const code&) { ++invoked; }, 0);
+    BOOST_REQUIRE_EQUAL(invoked, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+using namespace boost::asio;
+
+BOOST_AUTO_TEST_SUITE(socket_profile_tests)
+
+static const auto loopback = ip::make_address("127.0.0.1");
+
+BOOST_AUTO_TEST_CASE(socket_profile__apply__connected__options_read_back)
+{
+    io_context service;
+    asio::acceptor listener(service, asio::endpoint(loopback, 0));
+    asio::socket socket(service);
+    socket.connect(listener.local_endpoint());
+
+    socket_profile profile;
+    profile.no_delay = true;
+    profile.keep_alive = true;
+    profile.send_buffer_bytes = 64 * 1024;
+    profile.receive_buffer_bytes = 128 * 1024;
+    BOOST_REQUIRE(!profile.apply(socket));
+
+    ip::tcp::no_delay no_delay;
+    socket_base::keep_alive keep_alive;
+    socket_base::send_buffer_size send_buffer;
+    socket_base::receive_buffer_size receive_buffer;
+    socket.get_option(no_delay);
+    socket.get_option(keep_alive);
+    socket.get_option(send_buffer);
+    socket.get_option(receive_buffer);
+
+    // The kernel may round (e.g. double) the requested buffer sizes.
+    BOOST_REQUIRE(no_delay.value());
+    BOOST_REQUIRE(keep_alive.value());
+    BOOST_REQUIRE_GE(send_buffer.value(), 64 * 1024);
+    BOOST_REQUIRE_GE(receive_buffer.value(), 128 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(socket_profile__apply__listener__buffer_read_back)
+{
+    io_context service;
+    asio::acceptor listener(service);
+    listener.open(ip::tcp::v4());
+
+    socket_profile profile;
+    profile.receive_buffer_bytes = 128 * 1024;
+    BOOST_REQUIRE(!profile.apply(listener));
+
+    socket_base::receive_buffer_size receive_buffer;
+    listener.get_option(receive_buffer);
+    BOOST_REQUIRE_GE(receive_buffer.value(), 128 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(socket_profile__apply__closed__failure)
+{
+    io_context service;
+    asio::socket socket(service);
+    BOOST_REQUIRE(socket_profile().apply(socket));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(statsd_tests)
+
+BOOST_AUTO_TEST_CASE(statsd__format__empty__empty)
+{
+    BOOST_REQUIRE(statsd::format("network.", {}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(statsd__format__gauges__prefixed_lines)
+{
+    const auto datagrams = statsd::format("network.",
+        { { "hosts", 42 }, { "connections", 8 } });
+
+    BOOST_REQUIRE_EQUAL(datagrams.size(), 1u);
+    BOOST_REQUIRE_EQUAL(datagrams[0],
+        "network.hosts:42|g\nnetwork.connections:8|g");
+}
+
+BOOST_AUTO_TEST_CASE(statsd__format__small_datagram__split)
+{
+    const auto datagrams = statsd::format("", { { "a", 1 }, { "b", 2 } }, 6);
+
+    BOOST_REQUIRE_EQUAL(datagrams.size(), 2u);
+    BOOST_REQUIRE_EQUAL(datagrams[0], "a:1|g");
+    BOOST_REQUIRE_EQUAL(datagrams[1], "b:2|g");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
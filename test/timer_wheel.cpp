@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(timer_wheel_tests)
+
+typedef std::chrono::steady_clock clock_type;
+
+static const auto resolution = asio::milliseconds(1);
+static const auto timeout = std::chrono::seconds(10);
+static const auto quiet = std::chrono::milliseconds(200);
+
+struct wheel_fixture
+{
+    wheel_fixture()
+      : pool(2),
+        wheel(std::make_shared<timer_wheel>(pool, resolution))
+    {
+        wheel->start();
+    }
+
+    ~wheel_fixture()
+    {
+        wheel->stop();
+        pool.shutdown();
+        pool.join();
+    }
+
+    // Schedule a timer that records the time of its expiry.
+    timer_wheel::timer_ptr schedule(const asio::duration& period,
+        std::promise<clock_type::time_point>& fired)
+    {
+        return wheel->schedule(period, [&fired](const code&)
+        {
+            fired.set_value(clock_type::now());
+        });
+    }
+
+    threadpool pool;
+    timer_wheel::ptr wheel;
+};
+
+static bool fires(std::promise<clock_type::time_point>& fired,
+    std::chrono::milliseconds wait)
+{
+    return fired.get_future().wait_for(wait) == std::future_status::ready;
+}
+
+static asio::milliseconds since(const clock_type::time_point& start,
+    std::promise<clock_type::time_point>& fired)
+{
+    return std::chrono::duration_cast<asio::milliseconds>(
+        fired.get_future().get() - start);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__level_zero__expires)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    const auto start = clock_type::now();
+    fixture.schedule(asio::milliseconds(20), fired);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 1u);
+
+    // A timer expires no sooner than its period, less a few ticks of lag.
+    BOOST_REQUIRE(since(start, fired) >= asio::milliseconds(15));
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__level_one__cascades_and_expires)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    const auto start = clock_type::now();
+
+    // Beyond the 64 ticks of level zero.
+    fixture.schedule(asio::milliseconds(150), fired);
+    BOOST_REQUIRE(since(start, fired) >= asio::milliseconds(145));
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__level_two__cascades_and_expires)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    const auto start = clock_type::now();
+
+    // Beyond the 4096 ticks of levels zero and one.
+    fixture.schedule(asio::milliseconds(4200), fired);
+    BOOST_REQUIRE(since(start, fired) >= asio::milliseconds(4195));
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__touch__before_expiry__expires_later)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    const auto period = asio::milliseconds(100);
+    const auto timer = fixture.schedule(period, fired);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    const auto touched = clock_type::now();
+    fixture.wheel->touch(timer);
+
+    // The expiry is moved to a full period from the touch.
+    BOOST_REQUIRE(since(touched, fired) >= period - asio::milliseconds(5));
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__cancel__scheduled__handler_not_invoked)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    const auto timer = fixture.schedule(asio::milliseconds(20), fired);
+    fixture.wheel->cancel(timer);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+    BOOST_REQUIRE(!fires(fired, quiet));
+
+    // A repeated cancel is harmless.
+    fixture.wheel->cancel(timer);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__beyond_span__held_until_cancel)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+
+    // The wheel spans 2^24 ticks, about 4.7 hours at this resolution.
+    const auto timer = fixture.schedule(std::chrono::hours(24), fired);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 1u);
+    BOOST_REQUIRE(!fires(fired, quiet));
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 1u);
+
+    fixture.wheel->cancel(timer);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__stopped__handler_not_invoked)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    fixture.wheel->stop();
+
+    const auto timer = fixture.schedule(asio::milliseconds(1), fired);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+    BOOST_REQUIRE(!fires(fired, quiet));
+
+    fixture.wheel->cancel(timer);
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__stop__scheduled__handlers_dropped)
+{
+    std::promise<clock_type::time_point> fired;
+    wheel_fixture fixture;
+    fixture.schedule(asio::milliseconds(50), fired);
+    fixture.wheel->stop();
+    BOOST_REQUIRE_EQUAL(fixture.wheel->size(), 0u);
+    BOOST_REQUIRE(!fires(fired, quiet));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(token_bucket_tests)
+
+BOOST_AUTO_TEST_CASE(token_bucket__defer__unlimited__zero)
+{
+    token_bucket bucket(0, 0);
+    BOOST_REQUIRE(bucket.defer(1000000) == asio::duration::zero());
+    BOOST_REQUIRE(bucket.try_consume(1000000));
+}
+
+BOOST_AUTO_TEST_CASE(token_bucket__defer__within_capacity__zero)
+{
+    token_bucket bucket(1000, 1000);
+    BOOST_REQUIRE(bucket.defer(600) == asio::duration::zero());
+    BOOST_REQUIRE(!bucket.full());
+}
+
+BOOST_AUTO_TEST_CASE(token_bucket__defer__overdrawn__restoration_time)
+{
+    token_bucket bucket(1000, 1000);
+    const auto delay = bucket.defer(3000);
+
+    // The deficit of 2000 tokens is restored in about two seconds.
+    BOOST_REQUIRE(delay > asio::milliseconds(1900));
+    BOOST_REQUIRE(delay <= asio::milliseconds(2000));
+    BOOST_REQUIRE(!bucket.try_consume(1));
+}
+
+BOOST_AUTO_TEST_CASE(token_bucket__try_consume__burst__refused_when_empty)
+{
+    token_bucket bucket(1, 5);
+
+    for (size_t count = 0; count < 5; ++count)
+        BOOST_REQUIRE(bucket.try_consume());
+
+    BOOST_REQUIRE(!bucket.try_consume());
+    BOOST_REQUIRE(bucket.available() < 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
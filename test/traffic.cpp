@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(traffic_tests)
+
+BOOST_AUTO_TEST_CASE(traffic__collect__default__empty)
+{
+    const traffic instance;
+    const auto snapshot = instance.collect();
+    BOOST_REQUIRE(snapshot.commands.empty());
+    BOOST_REQUIRE_EQUAL(snapshot.total.messages_in, 0u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.messages_out, 0u);
+    BOOST_REQUIRE_EQUAL(snapshot.queued, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(traffic__collect__received_and_sent__counted_by_command)
+{
+    traffic instance;
+    instance.received(message::ping::command, 32);
+    instance.received(message::ping::command, 32);
+    instance.sent(message::pong::command, 32, asio::duration(0));
+    instance.received("bogus", 24);
+
+    const auto snapshot = instance.collect();
+    BOOST_REQUIRE_EQUAL(snapshot.commands.size(), 3u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.messages_in, 3u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.bytes_in, 88u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.messages_out, 1u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.bytes_out, 32u);
+    BOOST_REQUIRE_EQUAL(snapshot.writes, 1u);
+
+    for (const auto& command: snapshot.commands)
+    {
+        if (command.command == message::ping::command)
+            BOOST_REQUIRE_EQUAL(command.counts.messages_in, 2u);
+        else if (command.command == message::pong::command)
+            BOOST_REQUIRE_EQUAL(command.counts.messages_out, 1u);
+        else
+            BOOST_REQUIRE_EQUAL(command.command, "unknown");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(traffic__collect__enqueued_dequeued__queue_depth)
+{
+    traffic instance;
+    instance.enqueued(3);
+    instance.dequeued(2);
+    BOOST_REQUIRE_EQUAL(instance.collect().queued, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(traffic__to_index__unknown__last)
+{
+    BOOST_REQUIRE_EQUAL(traffic::to_index("bogus"),
+        traffic::command_count - 1);
+    BOOST_REQUIRE(traffic::to_index(message::ping::command) !=
+        traffic::to_index(message::pong::command));
+}
+
+BOOST_AUTO_TEST_CASE(traffic__add__tally__counted_to_each)
+{
+    traffic::tally counts;
+    BOOST_REQUIRE(counts.empty());
+
+    counts.received(traffic::to_index(message::ping::command), 32);
+    counts.sent(traffic::to_index(message::pong::command), 32,
+        asio::duration(0));
+    counts.enqueued(2);
+    counts.dequeued(1);
+    BOOST_REQUIRE(!counts.empty());
+
+    traffic channel;
+    traffic aggregate;
+    aggregate.enqueued(1);
+    channel.add(counts);
+    aggregate.add(counts);
+    counts.clear();
+    BOOST_REQUIRE(counts.empty());
+
+    const auto snapshot = channel.collect();
+    BOOST_REQUIRE_EQUAL(snapshot.commands.size(), 2u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.messages_in, 1u);
+    BOOST_REQUIRE_EQUAL(snapshot.total.bytes_out, 32u);
+    BOOST_REQUIRE_EQUAL(snapshot.writes, 1u);
+    BOOST_REQUIRE_EQUAL(snapshot.queued, 1u);
+    BOOST_REQUIRE_EQUAL(aggregate.collect().queued, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()